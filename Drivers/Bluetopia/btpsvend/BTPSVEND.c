@@ -23,6 +23,7 @@
 #include "SS1BTVS.h"          /* TI Vendor Specific Commands.                 */
 #include "BTPSKRNL.h"         /* Bluetooth Kernel Prototypes/Constants.       */
 #include "BTPSVEND.h"
+#include "HCITRANS.h"         /* HCI Transport Prototypes/Constants.          */
 
     /* Add this define to use CC256X									*/
 #ifdef __SUPPORT_CC256X_PATCH__
@@ -47,8 +48,72 @@ static HCI_COMM_Protocol_t SpecifiedProtocol;
    /* are called for every HCI_Reset() that is issued.                  */
 static Boolean_t VendorCommandsIssued;
 
+   /* The following constants are used by the warm up, which brings the */
+   /* controller out of reset, switches its baud rate and downloads the */
+   /* Base Patch over the raw HCI Transport before the stack is opened. */
+#define WARM_UP_RESET_TIME                (10)
+#define WARM_UP_BOOT_TIME                 (150)
+#define WARM_UP_BAUD_RATE_TIME            (100)
+#define WARM_UP_RESPONSE_TIMEOUT          (1000)
+#define WARM_UP_EVENT_BUFFER_SIZE         (4)
+
+#define HCI_PACKET_TYPE_COMMAND           (0x01)
+#define HCI_PACKET_TYPE_EVENT             (0x04)
+#define HCI_EVENT_COMMAND_COMPLETE        (0x0E)
+#define HCI_EVENT_COMMAND_STATUS          (0x0F)
+#define HCI_RESET_COMMAND_OPCODE          ((Word_t)(0x0C03))
+#define VS_UPDATE_UART_BAUDRATE_OPCODE    ((Word_t)(0xFF36))
+
+   /* The following enumerates the steps of the warm up.  Each waiting  */
+   /* step is left from HCI_VS_WarmUpProcess() once its time elapsed or */
+   /* the response to its command arrived.                              */
+typedef enum
+{
+   wsIdle,
+   wsReset,
+   wsBoot,
+   wsHCIReset,
+   wsBaudRate,
+   wsBaudRateSettle,
+   wsPatch,
+   wsReady,
+   wsFailed
+} WarmUpState_t;
+
+typedef enum
+{
+   esPacketType,
+   esEventCode,
+   esParameterLength,
+   esParameters
+} EventState_t;
+
+   /* The following structure holds the warm up context and the state  */
+   /* of the HCI event parser fed by the transport data callback.       */
+typedef struct _tagWarmUp_t
+{
+   WarmUpState_t               State;
+   unsigned long               TickCount;
+   unsigned int                PatchLength;
+   BTPSCONST unsigned char    *PatchPointer;
+   Word_t                      Opcode;
+   Boolean_t                   ResponseReceived;
+   Byte_t                      ResponseStatus;
+   EventState_t                EventState;
+   Byte_t                      EventCode;
+   Byte_t                      ParameterLength;
+   Byte_t                      ParameterIndex;
+   Byte_t                      Parameters[WARM_UP_EVENT_BUFFER_SIZE];
+} WarmUp_t;
+
+static WarmUp_t WarmUp;
+
    /* Internal Function Prototypes.                                     */
 static Boolean_t DownloadPatch(unsigned int BluetoothStackID, unsigned int PatchLength, BTPSCONST unsigned char *PatchPointer);
+static void BTPSAPI WarmUpDataCallback(unsigned int HCITransportID, unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter);
+static void WarmUpCommandResponse(void);
+static Boolean_t WarmUpSendCommand(Word_t Opcode, unsigned int Length, BTPSCONST unsigned char *Packet);
+static Boolean_t WarmUpNextPatchCommand(void);
 
    /* The following function is provided to allow a mechanism to        */
    /* download the specified Patch Data to the CC25xx device.  This     */
@@ -102,6 +167,259 @@ static Boolean_t DownloadPatch(unsigned int BluetoothStackID, unsigned int Patch
    return(ret_val);
 }
 
+   /* The following function is the HCI Transport data callback used   */
+   /* while the warm up owns the transport.  It parses the HCI events   */
+   /* and flags the Command Complete or Command Status event of the     */
+   /* pending command.  All other packets are skipped.                  */
+static void BTPSAPI WarmUpDataCallback(unsigned int HCITransportID, unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter)
+{
+   unsigned int Index;
+
+   for(Index = 0; (DataBuffer) && (Index < DataLength); Index++)
+   {
+      switch(WarmUp.EventState)
+      {
+         case esPacketType:
+            if(DataBuffer[Index] == HCI_PACKET_TYPE_EVENT)
+               WarmUp.EventState = esEventCode;
+            break;
+         case esEventCode:
+            WarmUp.EventCode  = DataBuffer[Index];
+            WarmUp.EventState = esParameterLength;
+            break;
+         case esParameterLength:
+            WarmUp.ParameterLength = DataBuffer[Index];
+            WarmUp.ParameterIndex  = 0;
+            WarmUp.EventState      = esParameters;
+
+            if(!WarmUp.ParameterLength)
+               WarmUp.EventState = esPacketType;
+            break;
+         case esParameters:
+            if(WarmUp.ParameterIndex < WARM_UP_EVENT_BUFFER_SIZE)
+               WarmUp.Parameters[WarmUp.ParameterIndex] = DataBuffer[Index];
+
+            if(++WarmUp.ParameterIndex == WarmUp.ParameterLength)
+            {
+               WarmUpCommandResponse();
+               WarmUp.EventState = esPacketType;
+            }
+            break;
+      }
+   }
+}
+
+   /* The following function checks a complete HCI event against the   */
+   /* pending warm up command.                                          */
+   /* * NOTE * Command Complete carries {Packets, Opcode, Status} and   */
+   /*          Command Status carries {Status, Packets, Opcode}.        */
+static void WarmUpCommandResponse(void)
+{
+   if((WarmUp.EventCode == HCI_EVENT_COMMAND_COMPLETE) && (WarmUp.ParameterLength >= 4) && (READ_UNALIGNED_WORD_LITTLE_ENDIAN(&WarmUp.Parameters[1]) == WarmUp.Opcode))
+   {
+      WarmUp.ResponseStatus   = WarmUp.Parameters[3];
+      WarmUp.ResponseReceived = TRUE;
+   }
+   else
+   {
+      if((WarmUp.EventCode == HCI_EVENT_COMMAND_STATUS) && (WarmUp.ParameterLength >= 4) && (READ_UNALIGNED_WORD_LITTLE_ENDIAN(&WarmUp.Parameters[2]) == WarmUp.Opcode))
+      {
+         WarmUp.ResponseStatus   = WarmUp.Parameters[0];
+         WarmUp.ResponseReceived = TRUE;
+      }
+   }
+}
+
+   /* The following function writes a complete HCI command packet to    */
+   /* the transport and restarts the response timeout.  This function   */
+   /* returns TRUE if the packet was written.                           */
+static Boolean_t WarmUpSendCommand(Word_t Opcode, unsigned int Length, BTPSCONST unsigned char *Packet)
+{
+   WarmUp.Opcode           = Opcode;
+   WarmUp.ResponseReceived = FALSE;
+   WarmUp.TickCount        = BTPS_GetTickCount();
+
+   return((Boolean_t)(!HCITR_COMWrite(HCITR_TRANSPORT_ID, Length, (unsigned char *)Packet)));
+}
+
+   /* The following function sends the next Base Patch command, it uses */
+   /* the same checks as DownloadPatch().  This function returns TRUE if*/
+   /* a command was sent or FALSE if the patch is complete or invalid.  */
+static Boolean_t WarmUpNextPatchCommand(void)
+{
+   Boolean_t ret_val;
+
+   if((WarmUp.PatchLength) && (WarmUp.PatchPointer[0] == HCI_PACKET_TYPE_COMMAND))
+      ret_val = WarmUpSendCommand(READ_UNALIGNED_WORD_LITTLE_ENDIAN(&WarmUp.PatchPointer[1]), (WarmUp.PatchPointer[3] + 4), WarmUp.PatchPointer);
+   else
+      ret_val = FALSE;
+
+   return(ret_val);
+}
+
+   /* The following function starts the warm up of the controller.  The*/
+   /* HCI Transport is opened at the default baud rate with the device  */
+   /* in reset and HCI_VS_WarmUpProcess() then has to be called until it*/
+   /* returns TRUE.  The parameter is the driver information that will  */
+   /* be passed to BSC_Initialize().  This function returns TRUE if the */
+   /* warm up was started.                                              */
+   /* * NOTE * Only the UART and HCILL protocols are supported, the     */
+   /*          3-Wire protocol is brought up by the stack as before.    */
+Boolean_t BTPSAPI HCI_VS_WarmUpStart(HCI_DriverInformation_t *HCI_DriverInformation)
+{
+   Boolean_t                   ret_val;
+   HCI_COMMDriverInformation_t COMMDriverInformation;
+
+   BTPS_MemInitialize(&WarmUp, 0, sizeof(WarmUp));
+
+   if((HCI_DriverInformation) && (HCI_DriverInformation->DriverInformation.COMMDriverInformation.Protocol != cp3Wire) && (HCI_DriverInformation->DriverInformation.COMMDriverInformation.Protocol != cp3Wire_RTS_CTS))
+   {
+      SpecifiedBaudRate = HCI_DriverInformation->DriverInformation.COMMDriverInformation.BaudRate;
+      SpecifiedProtocol = HCI_DriverInformation->DriverInformation.COMMDriverInformation.Protocol;
+
+      COMMDriverInformation          = HCI_DriverInformation->DriverInformation.COMMDriverInformation;
+      COMMDriverInformation.BaudRate = VENDOR_DEFAULT_BAUDRATE;
+
+      if(HCITR_COMWarmOpen(&COMMDriverInformation, WarmUpDataCallback, 0) > 0)
+      {
+         WarmUp.State     = wsReset;
+         WarmUp.TickCount = BTPS_GetTickCount();
+         ret_val          = TRUE;
+      }
+      else
+         ret_val = FALSE;
+   }
+   else
+      ret_val = FALSE;
+
+   if(!ret_val)
+      WarmUp.State = wsFailed;
+
+   return(ret_val);
+}
+
+   /* The following function advances the warm up, it never blocks.    */
+   /* The controller leaves reset, gets an HCI Reset, the baud rate     */
+   /* switch and then the Base Patch, one command per response.  This   */
+   /* function returns TRUE once the warm up is over, either with the   */
+   /* controller ready or with the transport closed again after an     */
+   /* error.  The stack then takes over the ready controller.           */
+Boolean_t BTPSAPI HCI_VS_WarmUpProcess(void)
+{
+   Boolean_t                        Status = TRUE;
+   unsigned long                    Elapsed;
+   unsigned char                    Packet[8];
+   HCI_Driver_Reconfigure_Data_t    DriverReconfigureData;
+   HCI_COMMReconfigureInformation_t COMMReconfigureInformation;
+
+   if((WarmUp.State == wsIdle) || (WarmUp.State == wsReady) || (WarmUp.State == wsFailed))
+      return(TRUE);
+
+   HCITR_COMProcess(HCITR_TRANSPORT_ID);
+   Elapsed = BTPS_GetTickCount() - WarmUp.TickCount;
+
+   switch(WarmUp.State)
+   {
+      case wsReset:
+         if(Elapsed >= WARM_UP_RESET_TIME)
+         {
+            HCITR_Clear_Reset();
+            WarmUp.State     = wsBoot;
+            WarmUp.TickCount = BTPS_GetTickCount();
+         }
+         break;
+      case wsBoot:
+         if(Elapsed >= WARM_UP_BOOT_TIME)
+         {
+            Packet[0] = HCI_PACKET_TYPE_COMMAND;
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[1], HCI_RESET_COMMAND_OPCODE);
+            Packet[3] = 0;
+
+            Status       = WarmUpSendCommand(HCI_RESET_COMMAND_OPCODE, 4, Packet);
+            WarmUp.State = wsHCIReset;
+         }
+         break;
+      case wsHCIReset:
+         if(WarmUp.ResponseReceived)
+         {
+            WarmUp.PatchLength  = sizeof(BasePatch);
+            WarmUp.PatchPointer = BasePatch;
+
+            if(SpecifiedBaudRate != VENDOR_DEFAULT_BAUDRATE)
+            {
+               /* The Command Complete still comes at the default baud  */
+               /* rate, the driver follows once it is received.         */
+               Packet[0] = HCI_PACKET_TYPE_COMMAND;
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[1], VS_UPDATE_UART_BAUDRATE_OPCODE);
+               Packet[3] = sizeof(NonAlignedDWord_t);
+               ASSIGN_HOST_DWORD_TO_LITTLE_ENDIAN_UNALIGNED_DWORD(&Packet[4], SpecifiedBaudRate);
+
+               Status       = WarmUpSendCommand(VS_UPDATE_UART_BAUDRATE_OPCODE, 8, Packet);
+               WarmUp.State = wsBaudRate;
+            }
+            else
+            {
+               Status       = WarmUpNextPatchCommand();
+               WarmUp.State = wsPatch;
+            }
+         }
+         break;
+      case wsBaudRate:
+         if(WarmUp.ResponseReceived)
+         {
+            if(!WarmUp.ResponseStatus)
+            {
+               DriverReconfigureData.ReconfigureCommand    = HCI_COMM_DRIVER_RECONFIGURE_DATA_COMMAND_CHANGE_COMM_PARAMETERS;
+               DriverReconfigureData.ReconfigureData       = &COMMReconfigureInformation;
+               COMMReconfigureInformation.ReconfigureFlags = HCI_COMM_RECONFIGURE_INFORMATION_RECONFIGURE_FLAGS_CHANGE_BAUDRATE;
+               COMMReconfigureInformation.BaudRate         = SpecifiedBaudRate;
+
+               HCITR_COMReconfigure(HCITR_TRANSPORT_ID, &DriverReconfigureData);
+
+               WarmUp.State     = wsBaudRateSettle;
+               WarmUp.TickCount = BTPS_GetTickCount();
+            }
+            else
+               Status = FALSE;
+         }
+         break;
+      case wsBaudRateSettle:
+         if(Elapsed >= WARM_UP_BAUD_RATE_TIME)
+         {
+            Status       = WarmUpNextPatchCommand();
+            WarmUp.State = wsPatch;
+         }
+         break;
+      case wsPatch:
+         if(WarmUp.ResponseReceived)
+         {
+            /* Advance to the next Patch Entry.                         */
+            WarmUp.PatchLength  -= (WarmUp.PatchPointer[3] + 4);
+            WarmUp.PatchPointer += (WarmUp.PatchPointer[3] + 4);
+
+            if(WarmUp.PatchLength)
+               Status = WarmUpNextPatchCommand();
+            else
+               WarmUp.State = wsReady;
+         }
+         break;
+      default:
+         break;
+   }
+
+   /* A silent or failing controller is left to the stack, which resets */
+   /* it and downloads the patch again.                                 */
+   if((!Status) || (((WarmUp.State == wsHCIReset) || (WarmUp.State == wsBaudRate) || (WarmUp.State == wsPatch)) && (!WarmUp.ResponseReceived) && ((BTPS_GetTickCount() - WarmUp.TickCount) >= WARM_UP_RESPONSE_TIMEOUT)))
+   {
+      DBG_MSG(DBG_ZONE_VENDOR, ("HCI_VS_WarmUpProcess Failure in state %d\r\n", WarmUp.State));
+
+      HCITR_COMClose(HCITR_TRANSPORT_ID);
+      WarmUp.State = wsFailed;
+   }
+
+   return((Boolean_t)((WarmUp.State == wsReady) || (WarmUp.State == wsFailed)));
+}
+
    /* The following function prototype represents the vendor specific   */
    /* function which is used to implement any needed Bluetooth device   */
    /* vendor specific functionality that needs to be performed before   */
@@ -130,8 +448,10 @@ Boolean_t BTPSAPI HCI_VS_InitializeBeforeHCIOpen(HCI_DriverInformation_t *HCI_Dr
    SpecifiedProtocol = HCI_DriverInformation->DriverInformation.COMMDriverInformation.Protocol;
 
    /* Make sure that the driver is initially configured to the default  */
-   /* baud rate of the controller.                                      */
-   HCI_DriverInformation->DriverInformation.COMMDriverInformation.BaudRate = VENDOR_DEFAULT_BAUDRATE;
+   /* baud rate of the controller, unless the warm up already switched  */
+   /* it.                                                               */
+   if(WarmUp.State != wsReady)
+      HCI_DriverInformation->DriverInformation.COMMDriverInformation.BaudRate = VENDOR_DEFAULT_BAUDRATE;
 
    return(TRUE);
 }
@@ -199,7 +519,11 @@ Boolean_t BTPSAPI HCI_VS_InitializeAfterHCIReset(unsigned int HCIDriverID, unsig
    {
       DBG_MSG(DBG_ZONE_VENDOR, ("HCI_VS_InitializeAfterHCIReset\r\n"));
 
-      if(SpecifiedBaudRate != VENDOR_DEFAULT_BAUDRATE)
+      /* The warm up already switched the baud rate and downloaded the  */
+      /* patch, both survive the HCI Reset.                             */
+      if(WarmUp.State == wsReady)
+         ret_val = TRUE;
+      else if(SpecifiedBaudRate != VENDOR_DEFAULT_BAUDRATE)
       {
          /* First, change the baseband's baudrate to what was specified */
          /* in the initialization structure.                            */
@@ -232,7 +556,8 @@ Boolean_t BTPSAPI HCI_VS_InitializeAfterHCIReset(unsigned int HCIDriverID, unsig
      if(ret_val)
       {
          /* Next download the patch.                                    */
-         ret_val = DownloadPatch(BluetoothStackID, sizeof(BasePatch), BasePatch);
+         if(WarmUp.State != wsReady)
+            ret_val = DownloadPatch(BluetoothStackID, sizeof(BasePatch), BasePatch);
 
          if((ret_val) && ((SpecifiedProtocol == cpHCILL) || (SpecifiedProtocol == cpHCILL_RTS_CTS)))
          {
@@ -303,8 +628,10 @@ Boolean_t BTPSAPI HCI_VS_InitializeBeforeHCIClose(unsigned int HCIDriverID, unsi
       }
    }
 
-   /* Flag that we need to re-download the Patch.                       */
+   /* Flag that we need to re-download the Patch, the transport puts the*/
+   /* device in reset when it is closed.                                */
    VendorCommandsIssued = FALSE;
+   WarmUp.State         = wsIdle;
 
    return(ret_val);
 }
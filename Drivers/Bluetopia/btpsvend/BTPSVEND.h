@@ -20,4 +20,11 @@
 
 #include "BVENDAPI.h"           /* BTPS Vendor Specific Prototypes/Constants. */
 
+   /* The following functions bring the controller up before the stack */
+   /* is opened, see BTPSVEND.c.  BSC_Initialize() takes the controller */
+   /* over once HCI_VS_WarmUpProcess() returned TRUE.                   */
+Boolean_t BTPSAPI HCI_VS_WarmUpStart(HCI_DriverInformation_t *HCI_DriverInformation);
+
+Boolean_t BTPSAPI HCI_VS_WarmUpProcess(void);
+
 #endif
@@ -34,6 +34,7 @@ static void HCITR_Tx_Interrupt(void);
 static void HCITR_Rx_Interrupt(void);
 static void HCITR_Set_Baud_Rate(USART_TypeDef *UartBase, uint32_t BaudRate);
 static void HCITR_Configure_GPIO(GPIO_TypeDef *Port, uint32_t Pin, uint32_t Mode, uint32_t Pull, uint32_t Alternate);
+static void HCITR_Open_Port(HCI_COMMDriverInformation_t *COMMDriverInformation, HCITR_COMDataCallback_t COMDataCallback, unsigned long CallbackParameter);
 
 /**
   ***************************************************************************************************************************************
@@ -185,6 +186,52 @@ void HCITR_UART_IRQ_HANDLER(void)
    	{HCITR_Tx_Interrupt();}
 }
 
+/**
+  ***************************************************************************************************************************************
+  * @brief  Opens the UART and its GPIO with the Bluetooth device held in reset, the caller releases the reset.
+  * @param  COM driver information (HCI_COMMDriverInformation_t*), data callback (HCITR_COMDataCallback_t), callback parameter (unsigned long)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void HCITR_Open_Port(HCI_COMMDriverInformation_t *COMMDriverInformation, HCITR_COMDataCallback_t COMDataCallback, unsigned long CallbackParameter)
+{
+	/* Initialize the context structure */
+	BTPS_MemInitialize(&HCITR_UART_HANDLE, 0, sizeof(hcitr_uart_context_ts));
+	/* Flag that the HCI Transport is open */
+	HCITR_UART_HANDLE.InitFlag = 1;
+	HCITR_UART_HANDLE.COMDataCallbackFunction = COMDataCallback;
+	HCITR_UART_HANDLE.COMDataCallbackParameter = CallbackParameter;
+	HCITR_UART_HANDLE.TxBytesFree = HCITR_OUTPUT_BUFFER_SIZE;
+	HCITR_UART_HANDLE.RxBytesFree = HCITR_INPUT_BUFFER_SIZE;
+	/* Enable the peripheral clocks for the UART and its GPIO */
+	HCITR_Enable_UART_Periph_Clock();
+	HCITR_RCC_CLK_CMD_ENABLE_GPIO_1(HCITR_RCC_CLK_GPIO_1);
+	HCITR_RCC_CLK_CMD_ENABLE_GPIO_2(HCITR_RCC_CLK_GPIO_2);
+
+	/* Configure the GPIO */
+	HCITR_Configure_GPIO(HCITR_GPIO_PORT_2, HCITR_P2_RESET_PIN, LL_GPIO_MODE_OUTPUT,LL_GPIO_PULL_NO,HCITR_UART_GPIO_AF);
+	HCITR_Set_Reset();
+	HCITR_Configure_GPIO(HCITR_GPIO_PORT_1, HCITR_P1_TXD_PIN, LL_GPIO_MODE_ALTERNATE,LL_GPIO_PULL_NO,HCITR_UART_GPIO_AF);
+	HCITR_Configure_GPIO(HCITR_GPIO_PORT_1, HCITR_P1_RXD_PIN, LL_GPIO_MODE_ALTERNATE,LL_GPIO_PULL_NO,HCITR_UART_GPIO_AF);
+	HCITR_Configure_GPIO(HCITR_GPIO_PORT_1, HCITR_P1_RTS_PIN, LL_GPIO_MODE_ALTERNATE,LL_GPIO_PULL_NO,HCITR_UART_GPIO_AF);
+	HCITR_Configure_GPIO(HCITR_GPIO_PORT_2, HCITR_P2_CTS_PIN, LL_GPIO_MODE_ALTERNATE,LL_GPIO_PULL_NO,HCITR_UART_GPIO_AF);
+
+	/* Initialize the UART */
+	LL_USART_Init(HCITR_UART_BASE,(LL_USART_InitTypeDef*)&HCITR_UART_CONFIG);
+	/* Reconfigure the baud rate to make sure it is as accurate as possible */
+	HCITR_Set_Baud_Rate(HCITR_UART_BASE, COMMDriverInformation->BaudRate);
+
+	NVIC_SetPriority(HCITR_UART_IRQ, HCITR_INTERRUPT_PRIORITY);
+	NVIC_EnableIRQ(HCITR_UART_IRQ);
+
+	/* Enable the UART */
+	LL_USART_Enable(HCITR_UART_BASE);
+	/* Polling USART initialisation */
+	while((!(LL_USART_IsActiveFlag_TEACK(HCITR_UART_BASE))) || (!(LL_USART_IsActiveFlag_REACK(HCITR_UART_BASE)))){};
+
+	LL_USART_EnableIT_RXNE(HCITR_UART_BASE);
+}
+
 /**
   ***************************************************************************************************************************************
   * The following function is responsible for opening the HCI
@@ -199,6 +246,8 @@ void HCITR_UART_IRQ_HANDLER(void)
   * specifies the HCITransportID that is used with the remaining
   * transport functions in this module.  This function returns a
   * negative return value to signify an error.
+  * A port left open by HCITR_COMWarmOpen() is handed over as is, the
+  * device is not reset again.
   ***************************************************************************************************************************************
   */
 int BTPSAPI HCITR_COMOpen(HCI_COMMDriverInformation_t *COMMDriverInformation, HCITR_COMDataCallback_t COMDataCallback, unsigned long CallbackParameter)
@@ -210,46 +259,46 @@ int BTPSAPI HCITR_COMOpen(HCI_COMMDriverInformation_t *COMMDriverInformation, HC
 	{
 		/* Initialize the return value for success */
 		ret_val = HCITR_TRANSPORT_ID;
-		/* Initialize the context structure */
-		BTPS_MemInitialize(&HCITR_UART_HANDLE, 0, sizeof(hcitr_uart_context_ts));
-		/* Flag that the HCI Transport is open */
-		HCITR_UART_HANDLE.InitFlag = 1;
+		HCITR_Open_Port(COMMDriverInformation, COMDataCallback, CallbackParameter);
+
+		/* Clear the reset */
+		BTPS_Delay(10);
+		HCITR_Clear_Reset();
+		BTPS_Delay(150);
+	}
+	else if((HCITR_UART_HANDLE.InitFlag) && (HCITR_UART_HANDLE.WarmFlag) && (COMMDriverInformation) && (COMDataCallback))
+	{
+		/* The received data is only delivered from HCITR_COMProcess(), the callback can change here */
+		ret_val = HCITR_TRANSPORT_ID;
+		HCITR_UART_HANDLE.WarmFlag = 0;
 		HCITR_UART_HANDLE.COMDataCallbackFunction = COMDataCallback;
 		HCITR_UART_HANDLE.COMDataCallbackParameter = CallbackParameter;
-		HCITR_UART_HANDLE.TxBytesFree = HCITR_OUTPUT_BUFFER_SIZE;
-		HCITR_UART_HANDLE.RxBytesFree = HCITR_INPUT_BUFFER_SIZE;
-		/* Enable the peripheral clocks for the UART and its GPIO */
-		HCITR_Enable_UART_Periph_Clock();
-		HCITR_RCC_CLK_CMD_ENABLE_GPIO_1(HCITR_RCC_CLK_GPIO_1);
-		HCITR_RCC_CLK_CMD_ENABLE_GPIO_2(HCITR_RCC_CLK_GPIO_2);
-
-		/* Configure the GPIO */
-		HCITR_Configure_GPIO(HCITR_GPIO_PORT_2, HCITR_P2_RESET_PIN, LL_GPIO_MODE_OUTPUT,LL_GPIO_PULL_NO,HCITR_UART_GPIO_AF);
-		HCITR_Set_Reset();
-		HCITR_Configure_GPIO(HCITR_GPIO_PORT_1, HCITR_P1_TXD_PIN, LL_GPIO_MODE_ALTERNATE,LL_GPIO_PULL_NO,HCITR_UART_GPIO_AF);
-		HCITR_Configure_GPIO(HCITR_GPIO_PORT_1, HCITR_P1_RXD_PIN, LL_GPIO_MODE_ALTERNATE,LL_GPIO_PULL_NO,HCITR_UART_GPIO_AF);
-		HCITR_Configure_GPIO(HCITR_GPIO_PORT_1, HCITR_P1_RTS_PIN, LL_GPIO_MODE_ALTERNATE,LL_GPIO_PULL_NO,HCITR_UART_GPIO_AF);
-		HCITR_Configure_GPIO(HCITR_GPIO_PORT_2, HCITR_P2_CTS_PIN, LL_GPIO_MODE_ALTERNATE,LL_GPIO_PULL_NO,HCITR_UART_GPIO_AF);
-
-		/* Initialize the UART */
-		LL_USART_Init(HCITR_UART_BASE,(LL_USART_InitTypeDef*)&HCITR_UART_CONFIG);
-		/* Reconfigure the baud rate to make sure it is as accurate as possible */
+		HCITR_Disable_Interrupts();
 		HCITR_Set_Baud_Rate(HCITR_UART_BASE, COMMDriverInformation->BaudRate);
+		HCITR_Enable_Interrupts();
+	}
+	else{ret_val = HCITR_ERROR_UNABLE_TO_OPEN_TRANSPORT;}
 
-		NVIC_SetPriority(HCITR_UART_IRQ, HCITR_INTERRUPT_PRIORITY);
-		NVIC_EnableIRQ(HCITR_UART_IRQ);
-
-		/* Enable the UART */
-		LL_USART_Enable(HCITR_UART_BASE);
-		/* Polling USART initialisation */
-		while((!(LL_USART_IsActiveFlag_TEACK(HCITR_UART_BASE))) || (!(LL_USART_IsActiveFlag_REACK(HCITR_UART_BASE)))){};
+	return(ret_val);
+}
 
-		LL_USART_EnableIT_RXNE(HCITR_UART_BASE);
+/**
+  ***************************************************************************************************************************************
+  * @brief  Opens the HCI Transport without waiting for the Bluetooth device, it stays in reset until the caller releases it with
+  *			HCITR_Clear_Reset().  The next HCITR_COMOpen() takes the open port over.
+  * @param  COM driver information (HCI_COMMDriverInformation_t*), data callback (HCITR_COMDataCallback_t), callback parameter (unsigned long)
+  * @retval Transport ID or error (int)
+  ***************************************************************************************************************************************
+  */
+int BTPSAPI HCITR_COMWarmOpen(HCI_COMMDriverInformation_t *COMMDriverInformation, HCITR_COMDataCallback_t COMDataCallback, unsigned long CallbackParameter)
+{
+	int ret_val;
 
-		/* Clear the reset */
-		BTPS_Delay(10);
-		HCITR_Clear_Reset();
-		BTPS_Delay(150);
+	if((!HCITR_UART_HANDLE.InitFlag) && (COMMDriverInformation) && (COMDataCallback))
+	{
+		ret_val = HCITR_TRANSPORT_ID;
+		HCITR_Open_Port(COMMDriverInformation, COMDataCallback, CallbackParameter);
+		HCITR_UART_HANDLE.WarmFlag = 1;
 	}
 	else{ret_val = HCITR_ERROR_UNABLE_TO_OPEN_TRANSPORT;}
 
@@ -288,6 +337,7 @@ void BTPSAPI HCITR_COMClose(unsigned int HCITransportID)
 	{
 		/* Flag that the HCI Transport is no longer open */
 		HCITR_UART_HANDLE.InitFlag = 0;
+		HCITR_UART_HANDLE.WarmFlag = 0;
 		NVIC_DisableIRQ(HCITR_UART_IRQ);
 		/* Appears to be valid, go ahead and close the port */
 		LL_USART_DisableIT_RXNE(HCITR_UART_BASE);
@@ -60,6 +60,7 @@ typedef struct{
 	volatile unsigned short  	TxBytesFree;
 	unsigned char            	TxBuffer[HCITR_OUTPUT_BUFFER_SIZE];
 	int 						InitFlag;
+	int 						WarmFlag; /* Opened by HCITR_COMWarmOpen(), not yet taken over by the stack */
 	#ifdef HCITR_ENABLE_DEBUG_LOGGING
 		Boolean_t               DebugEnabled;
 	#endif
@@ -100,6 +101,8 @@ int BTPSAPI HCITR_COMOpen(HCI_COMMDriverInformation_t *COMMDriverInformation, HC
   *          data callback specifying zero and NULL for the data
   *          length and data buffer (respectively).
   */
+int BTPSAPI HCITR_COMWarmOpen(HCI_COMMDriverInformation_t *COMMDriverInformation, HCITR_COMDataCallback_t COMDataCallback, unsigned long CallbackParameter);
+
 void BTPSAPI HCITR_COMClose(unsigned int HCITransportID);
 
 /** The following function is responsible for instructing the
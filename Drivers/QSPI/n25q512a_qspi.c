@@ -30,10 +30,24 @@
        (++) The function BSP_QSPI_GetInfo() returns the configuration of the QSPI memory. 
             (see the QSPI memory data sheet)
        (++) Perform erase block operation using the function BSP_QSPI_Erase_Block() and by
-            specifying the block address. You can perform an erase operation of the whole 
+            specifying the block address, or BSP_QSPI_Erase_Sector() for a 64 KB sector.
+            You can perform an erase operation of the whole 
             chip by calling the function BSP_QSPI_Erase_Chip(). 
        (++) The function BSP_QSPI_GetStatus() returns the current status of the QSPI memory. 
             (see the QSPI memory data sheet)
+       (++) BSP_QSPI_Submit() queues asynchronous reads, programs and erases. The lock
+            flag (BSP_QSPI_Get_Lock_Flag()) only tells a blocking function is running, the
+            busy flag (BSP_QSPI_Get_Busy_Flag()) that requests are queued. The blocking
+            functions wait for the queue, an interrupt calling them has to run below
+            QSPI_IRQ_PRIORITY.
+       (++) The read mode (1-1-4, 1-4-4 or 1-4-4 DTR) is chosen by a benchmark at init,
+            BSP_QSPI_Get_Read_Mode() and BSP_QSPI_Get_Bench() return the result. The
+            benchmark reads a pattern in the last subsector of the memory, the init only
+            checks it and stays in 1-1-4 without it. BSP_QSPI_Write_Bench_Pattern()
+            programs the pattern, the owner of that subsector calls it once it is free.
+       (++) BSP_QSPI_Read() suspends the program or the erase of a running asynchronous
+            request and resumes it after the read, BSP_QSPI_Get_Suspend_Stats() returns
+            the wait of the reads.
   @endverbatim
   ******************************************************************************
   * @attention
@@ -51,6 +65,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "n25q512a_qspi.h"
+#include <string.h>
 
 /** @addtogroup BSP
   * @{
@@ -72,6 +87,17 @@
 QSPI_HandleTypeDef QSPIHandle;
 __IO uint8_t qspiLockFlag=0;
 __IO uint8_t qspiInitFlag=0;
+__IO uint8_t qspiMemoryMappedFlag=0;
+DMA_HandleTypeDef QSPIDmaHandle;
+QSPI_RequestTypeDef* qspiQueue[QSPI_QUEUE_DEPTH];
+__IO uint8_t qspiQueueHead=0;
+__IO uint8_t qspiQueueCount=0;
+uint8_t qspiReadMode=QSPI_READ_MODE_1_1_4;
+QSPI_BenchTypeDef qspiBench[QSPI_READ_MODE_NBR];
+uint8_t qspiBenchPatternFlag=0;
+__IO uint8_t qspiOpState=QSPI_OP_IDLE;
+uint32_t qspiResumeTick=0;
+QSPI_SuspendStatsTypeDef qspiSuspendStats;
 
 /**
   * @}
@@ -86,9 +112,25 @@ static void    QSPI_MspInit              (void);
 static void    QSPI_MspDeInit          	 (void);
 static uint8_t QSPI_ResetMemory          (QSPI_HandleTypeDef *hqspi);
 static uint8_t QSPI_EnterFourBytesAddress(QSPI_HandleTypeDef *hqspi);
-static uint8_t QSPI_DummyCyclesCfg       (QSPI_HandleTypeDef *hqspi);
+static uint8_t QSPI_DummyCyclesCfg       (QSPI_HandleTypeDef *hqspi, uint8_t DummyCycles);
+static uint8_t QSPI_ReadModeSelect       (QSPI_HandleTypeDef *hqspi);
+static void    QSPI_ReadCommand          (QSPI_CommandTypeDef *sCommand);
+static void    QSPI_ReadTiming           (QSPI_HandleTypeDef *hqspi, uint8_t ReadFlag);
+static uint8_t QSPI_ReadData             (QSPI_HandleTypeDef *hqspi, uint8_t* pData, uint32_t ReadAddr, uint32_t Size);
 static uint8_t QSPI_WriteEnable          (QSPI_HandleTypeDef *hqspi);
 static uint8_t QSPI_AutoPollingMemReady(QSPI_HandleTypeDef *hqspi, uint32_t Timeout);
+static uint8_t QSPI_ExitMemoryMappedMode (QSPI_HandleTypeDef *hqspi);
+static uint8_t QSPI_AutoPollingMemReady_IT(QSPI_HandleTypeDef *hqspi);
+static void    QSPI_WaitIdle             (void);
+static void    QSPI_Request_Start        (void);
+static void    QSPI_Request_Done         (uint8_t Status);
+static uint8_t QSPI_Request_Read         (QSPI_RequestTypeDef* pRequest);
+static uint8_t QSPI_Request_Page         (QSPI_RequestTypeDef* pRequest);
+static uint8_t QSPI_Request_Erase        (QSPI_RequestTypeDef* pRequest);
+static void    QSPI_Request_Ready        (void);
+static uint8_t QSPI_ReadFlagStatus       (QSPI_HandleTypeDef *hqspi, uint8_t* pReg);
+static uint8_t QSPI_Suspend              (void);
+static uint8_t QSPI_Resume               (void);
 
 /**
   * @}
@@ -106,9 +148,12 @@ static uint8_t QSPI_AutoPollingMemReady(QSPI_HandleTypeDef *hqspi, uint32_t Time
   */
 uint8_t BSP_QSPI_Init(void)
 { 
+	/* The asynchronous requests run to their end first */
+	QSPI_WaitIdle();
 	qspiLockFlag++;
 
 	QSPIHandle.Instance = QUADSPI;
+	qspiReadMode = QSPI_READ_MODE_1_1_4;
 
 	/* Call the DeInit function to reset the driver */
 	if (HAL_QSPI_DeInit(&QSPIHandle) != HAL_OK){return QSPI_ERROR;}
@@ -147,13 +192,21 @@ uint8_t BSP_QSPI_Init(void)
   	}
  
   	/* Configuration of the dummy cucles on QSPI memory side */
-  	if (QSPI_DummyCyclesCfg(&QSPIHandle) != QSPI_OK)
+  	if (QSPI_DummyCyclesCfg(&QSPIHandle, N25Q512A_DUMMY_CYCLES_READ_QUAD) != QSPI_OK)
+  	{
+  		if(qspiLockFlag){qspiLockFlag--;}
+  		return QSPI_NOT_SUPPORTED;
+  	}
+
+  	/* Choice of the read mode, the dummy cycles are set */
+  	if (QSPI_ReadModeSelect(&QSPIHandle) != QSPI_OK)
   	{
   		if(qspiLockFlag){qspiLockFlag--;}
   		return QSPI_NOT_SUPPORTED;
   	}
   
   	qspiInitFlag=1;
+  	qspiMemoryMappedFlag=0;
   	if(qspiLockFlag){qspiLockFlag--;}
   	return QSPI_OK;
 }
@@ -168,7 +221,8 @@ uint8_t BSP_QSPI_Get_Init_Flag(void)
 }
 
 /**
-  * @brief  Get QSPI lock flag
+  * @brief  Get QSPI lock flag, set while a blocking function uses the memory. The asynchronous
+  *         requests do not take it, BSP_QSPI_Get_Busy_Flag() tells they are queued.
   * @retval Lock flag
   */
 uint8_t BSP_QSPI_Get_Lock_Flag(void)
@@ -176,12 +230,67 @@ uint8_t BSP_QSPI_Get_Lock_Flag(void)
 	return qspiLockFlag;
 }
 
+/**
+  * @brief  Get QSPI memory-mapped mode flag
+  * @retval Memory-mapped flag
+  */
+uint8_t BSP_QSPI_Get_Memory_Mapped_Flag(void)
+{
+	return qspiMemoryMappedFlag;
+}
+
+/**
+  * @brief  Get the read mode chosen at init
+  * @retval QSPI_READ_MODE_xxx
+  */
+uint8_t BSP_QSPI_Get_Read_Mode(void)
+{
+	return qspiReadMode;
+}
+
+/**
+  * @brief  Get the init benchmark of a read mode
+  * @param  Mode: QSPI_READ_MODE_xxx
+  * @retval Benchmark, NULL for an unknown mode
+  */
+const QSPI_BenchTypeDef* BSP_QSPI_Get_Bench(uint8_t Mode)
+{
+	if (Mode >= QSPI_READ_MODE_NBR){return NULL;}
+
+	return &qspiBench[Mode];
+}
+
+/**
+  * @brief  Programs the read mode benchmark pattern into the last subsector of the memory,
+  *         nothing is written when the init found it. The read mode is chosen with it from
+  *         the next init on.
+  * @retval QSPI memory status
+  */
+uint8_t BSP_QSPI_Write_Bench_Pattern(void)
+{
+	uint8_t pattern[QSPI_BENCH_SIZE];
+	uint32_t idx;
+
+	if (qspiBenchPatternFlag){return QSPI_OK;}
+
+	for (idx = 0U; idx < QSPI_BENCH_SIZE; idx++){pattern[idx] = QSPI_BENCH_PATTERN(idx);}
+
+	if ((BSP_QSPI_Erase_Block(QSPI_BENCH_ADDR) != QSPI_OK) || (BSP_QSPI_Write(pattern, QSPI_BENCH_ADDR, QSPI_BENCH_SIZE) != QSPI_OK))
+	{return QSPI_ERROR;}
+
+	qspiBenchPatternFlag = 1U;
+
+	return QSPI_OK;
+}
+
 /**
   * @brief  De-Initializes the QSPI interface.
   * @retval QSPI memory status
   */
 uint8_t BSP_QSPI_DeInit(void)
 { 
+	/* The asynchronous requests run to their end first */
+	QSPI_WaitIdle();
 	qspiLockFlag++;
 
 	QSPIHandle.Instance = QUADSPI;
@@ -195,6 +304,7 @@ uint8_t BSP_QSPI_DeInit(void)
         
 	/* System level De-initialization */
 	QSPI_MspDeInit();
+	qspiMemoryMappedFlag=0;
   
 	if(qspiLockFlag){qspiLockFlag--;}
 	return QSPI_OK;
@@ -209,43 +319,33 @@ uint8_t BSP_QSPI_DeInit(void)
   */
 uint8_t BSP_QSPI_Read(uint8_t* pData, uint32_t ReadAddr, uint32_t Size)
 {
-	QSPI_CommandTypeDef sCommand;
+	uint32_t cycles = DWT->CYCCNT;
+	uint8_t status, waitFlag = (qspiQueueCount != 0U), suspendFlag = 0U;
 
 	qspiLockFlag++;
-	/* Initialize the read command */
-	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
-	sCommand.Instruction       = QUAD_OUT_FAST_READ_CMD;
-	sCommand.AddressMode       = QSPI_ADDRESS_1_LINE;
-	sCommand.AddressSize       = QSPI_ADDRESS_32_BITS;
-	sCommand.Address           = ReadAddr;
-	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-	sCommand.DataMode          = QSPI_DATA_4_LINES;
-	sCommand.DummyCycles       = N25Q512A_DUMMY_CYCLES_READ_QUAD;
-	sCommand.NbData            = Size;
-	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
-	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
-	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
-  
-	/* Configure the command */
-	if (HAL_QSPI_Command(&QSPIHandle, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+	/* A program or an erase in progress is suspended for the read, the transfers run to their end */
+	while (qspiQueueCount)
 	{
-		if(qspiLockFlag){qspiLockFlag--;}
-		return QSPI_ERROR;
+		if (QSPI_OK == QSPI_Suspend()){suspendFlag = 1U; break;}
 	}
-  
-	MODIFY_REG(QSPIHandle.Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_2_CYCLE);
 
-	/* Reception of the data */
-	if (HAL_QSPI_Receive(&QSPIHandle, pData, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+	if (waitFlag)
 	{
-		if(qspiLockFlag){qspiLockFlag--;}
-		return QSPI_ERROR;
+		cycles = (DWT->CYCCNT - cycles) / (SystemCoreClock / 1000000U);
+		qspiSuspendStats.WaitNbr++;
+		if (cycles > qspiSuspendStats.WaitMax){qspiSuspendStats.WaitMax = cycles;}
 	}
 
-	MODIFY_REG(QSPIHandle.Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_5_CYCLE);
+	/* Indirect access leaves the memory-mapped mode */
+	if (QSPI_ExitMemoryMappedMode(&QSPIHandle) != QSPI_OK){status = QSPI_ERROR;}
+	/* Read in the mode chosen at init */
+	else{status = QSPI_ReadData(&QSPIHandle, pData, ReadAddr, Size);}
+
+	/* The suspended operation goes on */
+	if ((suspendFlag) && (QSPI_Resume() != QSPI_OK)){status = QSPI_ERROR;}
 
 	if(qspiLockFlag){qspiLockFlag--;}
-	return QSPI_OK;
+	return status;
 }
 
 /**
@@ -260,7 +360,15 @@ uint8_t BSP_QSPI_Write(uint8_t* pData, uint32_t WriteAddr, uint32_t Size)
 	QSPI_CommandTypeDef sCommand;
 	uint32_t end_addr, current_size, current_addr;
 
+	QSPI_WaitIdle();
 	qspiLockFlag++;
+	/* Indirect access leaves the memory-mapped mode */
+	if (QSPI_ExitMemoryMappedMode(&QSPIHandle) != QSPI_OK)
+	{
+		if(qspiLockFlag){qspiLockFlag--;}
+		return QSPI_ERROR;
+	}
+
 	/* Calculation of the size between the write address and the end of the page */
 	current_size = N25Q512A_PAGE_SIZE - (WriteAddr % N25Q512A_PAGE_SIZE);
 
@@ -336,7 +444,15 @@ uint8_t BSP_QSPI_Erase_Block(uint32_t BlockAddress)
 {
 	QSPI_CommandTypeDef sCommand;
 
+	QSPI_WaitIdle();
 	qspiLockFlag++;
+	/* Indirect access leaves the memory-mapped mode */
+	if (QSPI_ExitMemoryMappedMode(&QSPIHandle) != QSPI_OK)
+	{
+		if(qspiLockFlag){qspiLockFlag--;}
+		return QSPI_ERROR;
+	}
+
 	/* Initialize the erase command */
 	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
 	sCommand.Instruction       = SUBSECTOR_ERASE_CMD;
@@ -376,18 +492,29 @@ uint8_t BSP_QSPI_Erase_Block(uint32_t BlockAddress)
 }
 
 /**
-  * @brief  Erases the entire QSPI memory.
+  * @brief  Erases the specified 64 KB sector of the QSPI memory.
+  * @param  SectorAddress: Sector address to erase
   * @retval QSPI memory status
   */
-uint8_t BSP_QSPI_Erase_Chip(void)
+uint8_t BSP_QSPI_Erase_Sector(uint32_t SectorAddress)
 {
 	QSPI_CommandTypeDef sCommand;
 
+	QSPI_WaitIdle();
 	qspiLockFlag++;
+	/* Indirect access leaves the memory-mapped mode */
+	if (QSPI_ExitMemoryMappedMode(&QSPIHandle) != QSPI_OK)
+	{
+		if(qspiLockFlag){qspiLockFlag--;}
+		return QSPI_ERROR;
+	}
+
 	/* Initialize the erase command */
 	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
-	sCommand.Instruction       = BULK_ERASE_CMD;
-	sCommand.AddressMode       = QSPI_ADDRESS_NONE;
+	sCommand.Instruction       = SECTOR_ERASE_CMD;
+	sCommand.AddressMode       = QSPI_ADDRESS_1_LINE;
+	sCommand.AddressSize       = QSPI_ADDRESS_32_BITS;
+	sCommand.Address           = SectorAddress;
 	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
 	sCommand.DataMode          = QSPI_DATA_NONE;
 	sCommand.DummyCycles       = 0;
@@ -410,7 +537,7 @@ uint8_t BSP_QSPI_Erase_Chip(void)
 	}
   
 	/* Configure automatic polling mode to wait for end of erase */
-	if (QSPI_AutoPollingMemReady(&QSPIHandle, N25Q512A_BULK_ERASE_MAX_TIME) != QSPI_OK)
+	if (QSPI_AutoPollingMemReady(&QSPIHandle, N25Q512A_SECTOR_ERASE_MAX_TIME) != QSPI_OK)
 	{
 		if(qspiLockFlag){qspiLockFlag--;}
 		return QSPI_ERROR;
@@ -421,36 +548,77 @@ uint8_t BSP_QSPI_Erase_Chip(void)
 }
 
 /**
-  * @brief  Reads current status of the QSPI memory.
+  * @brief  Erases the entire QSPI memory.
   * @retval QSPI memory status
   */
-uint8_t BSP_QSPI_GetStatus(void)
+uint8_t BSP_QSPI_Erase_Chip(void)
 {
 	QSPI_CommandTypeDef sCommand;
-	uint8_t reg;
 
+	QSPI_WaitIdle();
 	qspiLockFlag++;
-	/* Initialize the read flag status register command */
+	/* Indirect access leaves the memory-mapped mode */
+	if (QSPI_ExitMemoryMappedMode(&QSPIHandle) != QSPI_OK)
+	{
+		if(qspiLockFlag){qspiLockFlag--;}
+		return QSPI_ERROR;
+	}
+
+	/* Initialize the erase command */
 	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
-	sCommand.Instruction       = READ_FLAG_STATUS_REG_CMD;
+	sCommand.Instruction       = BULK_ERASE_CMD;
 	sCommand.AddressMode       = QSPI_ADDRESS_NONE;
 	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-	sCommand.DataMode          = QSPI_DATA_1_LINE;
+	sCommand.DataMode          = QSPI_DATA_NONE;
 	sCommand.DummyCycles       = 0;
-	sCommand.NbData            = 1;
 	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
 	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
 	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
 
-	/* Configure the command */
+	/* Enable write operations */
+	if (QSPI_WriteEnable(&QSPIHandle) != QSPI_OK)
+	{
+		if(qspiLockFlag){qspiLockFlag--;}
+		return QSPI_ERROR;
+	}
+
+	/* Send the command */
 	if (HAL_QSPI_Command(&QSPIHandle, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
 	{
 		if(qspiLockFlag){qspiLockFlag--;}
 		return QSPI_ERROR;
 	}
+  
+	/* Configure automatic polling mode to wait for end of erase */
+	if (QSPI_AutoPollingMemReady(&QSPIHandle, N25Q512A_BULK_ERASE_MAX_TIME) != QSPI_OK)
+	{
+		if(qspiLockFlag){qspiLockFlag--;}
+		return QSPI_ERROR;
+	}
 
-	/* Reception of the data */
-	if (HAL_QSPI_Receive(&QSPIHandle, &reg, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+	if(qspiLockFlag){qspiLockFlag--;}
+	return QSPI_OK;
+}
+
+/**
+  * @brief  Reads current status of the QSPI memory.
+  * @retval QSPI memory status
+  */
+uint8_t BSP_QSPI_GetStatus(void)
+{
+	uint8_t reg;
+
+	QSPI_WaitIdle();
+	qspiLockFlag++;
+	/* Indirect access leaves the memory-mapped mode */
+	if (QSPI_ExitMemoryMappedMode(&QSPIHandle) != QSPI_OK)
+	{
+		if(qspiLockFlag){qspiLockFlag--;}
+		return QSPI_ERROR;
+	}
+
+	/* Read the flag status register */
+	if (QSPI_ReadFlagStatus(&QSPIHandle, &reg) != QSPI_OK)
 	{
 		if(qspiLockFlag){qspiLockFlag--;}
 		return QSPI_ERROR;
@@ -505,32 +673,194 @@ uint8_t BSP_QSPI_EnableMemoryMappedMode(void)
 	QSPI_CommandTypeDef      sCommand;
 	QSPI_MemoryMappedTypeDef sMemMappedCfg;
 
+	QSPI_WaitIdle();
+	if(qspiMemoryMappedFlag){return QSPI_OK;}
+
 	qspiLockFlag++;
-	/* Configure the command for the read instruction */
-	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
-	sCommand.Instruction       = QUAD_OUT_FAST_READ_CMD;
-	sCommand.AddressMode       = QSPI_ADDRESS_1_LINE;
-	sCommand.AddressSize       = QSPI_ADDRESS_32_BITS;
-	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-	sCommand.DataMode          = QSPI_DATA_4_LINES;
-	sCommand.DummyCycles       = N25Q512A_DUMMY_CYCLES_READ_QUAD;
-	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
-	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
-	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+	/* Configure the command for the read instruction, in the mode chosen at init */
+	QSPI_ReadCommand(&sCommand);
   
 	/* Configure the memory mapped mode */
 	sMemMappedCfg.TimeOutActivation = QSPI_TIMEOUT_COUNTER_DISABLE;
+
+	/* The read timing holds until the memory-mapped mode is left */
+	QSPI_ReadTiming(&QSPIHandle, 1U);
   
 	if (HAL_QSPI_MemoryMapped(&QSPIHandle, &sCommand, &sMemMappedCfg) != HAL_OK)
 	{
+		QSPI_ReadTiming(&QSPIHandle, 0U);
 		if(qspiLockFlag){qspiLockFlag--;}
 		return QSPI_ERROR;
 	}
 
+	qspiMemoryMappedFlag=1;
+	if(qspiLockFlag){qspiLockFlag--;}
+	return QSPI_OK;
+}
+
+/**
+  * @brief  Leave the memory-mapped mode, the QSPI is back in the indirect mode
+  * @retval QSPI memory status
+  */
+uint8_t BSP_QSPI_DisableMemoryMappedMode(void)
+{
+	uint8_t status;
+
+	QSPI_WaitIdle();
+	qspiLockFlag++;
+	status = QSPI_ExitMemoryMappedMode(&QSPIHandle);
 	if(qspiLockFlag){qspiLockFlag--;}
+
+	return status;
+}
+
+/**
+  * @brief  Queue an asynchronous request, it starts at once when no other request is running.
+  *         The data moves by DMA and the end of a program or an erase is caught by the status
+  *         match interrupt, the CPU is free meanwhile. The blocking functions wait for the
+  *         queue to drain (BSP_QSPI_Read suspends a program or an erase instead), the busy
+  *         flag is set until then. Submit from the thread mode or from a completion callback.
+  * @param  pRequest: Request, owned by the driver while its status reads QSPI_BUSY
+  * @retval QSPI memory status, QSPI_BUSY when the queue is full
+  */
+uint8_t BSP_QSPI_Submit(QSPI_RequestTypeDef* pRequest)
+{
+	uint32_t primask;
+	uint8_t startFlag;
+
+	if ((pRequest == NULL) || (pRequest->Type > QSPI_REQUEST_ERASE_SECTOR) || (!qspiInitFlag)){return QSPI_ERROR;}
+	if ((pRequest->Type <= QSPI_REQUEST_PROGRAM) && ((pRequest->pData == NULL) || (pRequest->Size == 0U))){return QSPI_ERROR;}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (qspiQueueCount >= QSPI_QUEUE_DEPTH)
+	{
+		__set_PRIMASK(primask);
+		return QSPI_BUSY;
+	}
+
+	pRequest->Status = QSPI_BUSY;
+	pRequest->Offset = 0U;
+	qspiQueue[(qspiQueueHead + qspiQueueCount) % QSPI_QUEUE_DEPTH] = pRequest;
+	qspiQueueCount++;
+
+	startFlag = (1U == qspiQueueCount);
+
+	__set_PRIMASK(primask);
+
+	if (startFlag){QSPI_Request_Start();}
+
 	return QSPI_OK;
 }
 
+/**
+  * @brief  Wait for the end of a submitted request.
+  * @param  pRequest: Request
+  * @retval QSPI memory status of the request
+  */
+uint8_t BSP_QSPI_Wait(QSPI_RequestTypeDef* pRequest)
+{
+	while (QSPI_BUSY == pRequest->Status){}
+
+	return pRequest->Status;
+}
+
+/**
+  * @brief  Get QSPI busy flag, set while asynchronous requests are queued
+  * @retval Busy flag
+  */
+uint8_t BSP_QSPI_Get_Busy_Flag(void)
+{
+	return (qspiQueueCount != 0U);
+}
+
+/**
+  * @brief  Get the program/erase suspend statistics
+  * @retval Statistics
+  */
+const QSPI_SuspendStatsTypeDef* BSP_QSPI_Get_Suspend_Stats(void)
+{
+	return &qspiSuspendStats;
+}
+
+/**
+  * @brief  QUADSPI interrupt, to be called from QUADSPI_IRQHandler.
+  * @retval None
+  */
+void BSP_QSPI_IRQHandler(void)
+{
+	HAL_QSPI_IRQHandler(&QSPIHandle);
+}
+
+/**
+  * @brief  QUADSPI DMA channel interrupt, to be called from its IRQ handler.
+  * @retval None
+  */
+void BSP_QSPI_DMA_IRQHandler(void)
+{
+	HAL_DMA_IRQHandler(&QSPIDmaHandle);
+}
+
+/**
+  * @brief  Rx transfer completed: the next chunk of the read, or the end of the request.
+  * @param  hqspi: QSPI handle
+  * @retval None
+  */
+void HAL_QSPI_RxCpltCallback(QSPI_HandleTypeDef *hqspi)
+{
+	QSPI_RequestTypeDef* pRequest = qspiQueue[qspiQueueHead];
+
+	if (!qspiQueueCount){return;}
+
+	QSPI_ReadTiming(hqspi, 0U);
+
+	if (pRequest->Offset < pRequest->Size)
+	{
+		if (QSPI_Request_Read(pRequest) != QSPI_OK){QSPI_Request_Done(QSPI_ERROR);}
+	}
+	else{QSPI_Request_Done(QSPI_OK);}
+}
+
+/**
+  * @brief  Tx transfer completed: the page is programming, the memory status is polled.
+  * @param  hqspi: QSPI handle
+  * @retval None
+  */
+void HAL_QSPI_TxCpltCallback(QSPI_HandleTypeDef *hqspi)
+{
+	if (!qspiQueueCount){return;}
+
+	if (QSPI_AutoPollingMemReady_IT(hqspi) != QSPI_OK){QSPI_Request_Done(QSPI_ERROR);}
+}
+
+/**
+  * @brief  Status match: the memory is ready, the next page of the program or the end of the request.
+  * @param  hqspi: QSPI handle
+  * @retval None
+  */
+void HAL_QSPI_StatusMatchCallback(QSPI_HandleTypeDef *hqspi)
+{
+	qspiOpState = QSPI_OP_IDLE;
+	if (!qspiQueueCount){return;}
+
+	QSPI_Request_Ready();
+}
+
+/**
+  * @brief  Transfer error: the running request fails.
+  * @param  hqspi: QSPI handle
+  * @retval None
+  */
+void HAL_QSPI_ErrorCallback(QSPI_HandleTypeDef *hqspi)
+{
+	qspiOpState = QSPI_OP_IDLE;
+	if (!qspiQueueCount){return;}
+
+	QSPI_ReadTiming(hqspi, 0U);
+	QSPI_Request_Done(QSPI_ERROR);
+}
+
 /**
   * @}
   */
@@ -568,6 +898,25 @@ static void QSPI_MspInit(void)
     HAL_GPIO_Init(QSPI_DB_GPIO_PORT, &gpio_init_structure);
     gpio_init_structure.Pin = QSPI_D2_PIN|QSPI_D3_PIN;
     HAL_GPIO_Init(QSPI_DA_GPIO_PORT, &gpio_init_structure);
+
+    /* DMA channel of the asynchronous requests, the direction is set per transfer */
+    QSPI_DMA_CLK_ENABLE();
+    QSPIDmaHandle.Instance                 = QSPI_DMA_CHANNEL;
+    QSPIDmaHandle.Init.Request             = QSPI_DMA_REQUEST;
+    QSPIDmaHandle.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+    QSPIDmaHandle.Init.PeriphInc           = DMA_PINC_DISABLE;
+    QSPIDmaHandle.Init.MemInc              = DMA_MINC_ENABLE;
+    QSPIDmaHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    QSPIDmaHandle.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+    QSPIDmaHandle.Init.Mode                = DMA_NORMAL;
+    QSPIDmaHandle.Init.Priority            = DMA_PRIORITY_HIGH;
+    HAL_DMA_Init(&QSPIDmaHandle);
+    __HAL_LINKDMA(&QSPIHandle, hdma, QSPIDmaHandle);
+
+    HAL_NVIC_SetPriority(QUADSPI_IRQn, QSPI_IRQ_PRIORITY, 0U);
+    HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
+    HAL_NVIC_SetPriority(QSPI_DMA_IRQn, QSPI_IRQ_PRIORITY, 0U);
+    HAL_NVIC_EnableIRQ(QSPI_DMA_IRQn);
 }
 
 /**
@@ -585,6 +934,11 @@ static void QSPI_MspDeInit(void)
 	HAL_GPIO_DeInit(QSPI_DA_GPIO_PORT, QSPI_D2_PIN);
 	HAL_GPIO_DeInit(QSPI_DA_GPIO_PORT, QSPI_D3_PIN);
 
+	/* De-Configure the DMA channel and the interrupts */
+	HAL_NVIC_DisableIRQ(QUADSPI_IRQn);
+	HAL_NVIC_DisableIRQ(QSPI_DMA_IRQn);
+	HAL_DMA_DeInit(&QSPIDmaHandle);
+
 	/*##-3- Reset peripherals ##################################################*/
 	/* Reset the QuadSPI memory interface */
 	QSPI_FORCE_RESET();
@@ -660,11 +1014,13 @@ static uint8_t QSPI_EnterFourBytesAddress(QSPI_HandleTypeDef *hqspi)
 }
 
 /**
-  * @brief  This function configure the dummy cycles on memory side.
+  * @brief  This function configure the dummy cycles on memory side, the count of the
+  *         read mode (QSPI_READ_DUMMY_CYCLES) is used by every read instruction.
   * @param  hqspi: QSPI handle
+  * @param  DummyCycles: Dummy cycles of the read instructions
   * @retval None
   */
-static uint8_t QSPI_DummyCyclesCfg(QSPI_HandleTypeDef *hqspi)
+static uint8_t QSPI_DummyCyclesCfg(QSPI_HandleTypeDef *hqspi, uint8_t DummyCycles)
 {
 	QSPI_CommandTypeDef sCommand;
 	uint8_t reg;
@@ -692,7 +1048,7 @@ static uint8_t QSPI_DummyCyclesCfg(QSPI_HandleTypeDef *hqspi)
 
 	/* Update volatile configuration register (with new dummy cycles) */
 	sCommand.Instruction = WRITE_VOL_CFG_REG_CMD;
-	MODIFY_REG(reg, N25Q512A_VCR_NB_DUMMY, (N25Q512A_DUMMY_CYCLES_READ_QUAD << POSITION_VAL(N25Q512A_VCR_NB_DUMMY)));
+	MODIFY_REG(reg, N25Q512A_VCR_NB_DUMMY, (DummyCycles << POSITION_VAL(N25Q512A_VCR_NB_DUMMY)));
       
 	/* Configure the write volatile configuration register command */
 	if (HAL_QSPI_Command(&QSPIHandle, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK){return QSPI_ERROR;}
@@ -704,37 +1060,204 @@ static uint8_t QSPI_DummyCyclesCfg(QSPI_HandleTypeDef *hqspi)
 }
 
 /**
-  * @brief  This function send a Write Enable and wait it is effective.
+  * @brief  This function benchmarks the read modes and keeps the fastest one that reads back the
+  *         pattern of the last subsector. The pattern is known, a mode that reads a uniform or a
+  *         shifted content is left out. Nothing is written: when the 1-1-4 read does not find the
+  *         pattern, the 1-1-4 mode of the reset is kept. The 1-4-4 modes send the address on four lines,
+  *         the DTR mode also clocks the address and the data on both edges with its own dummy
+  *         cycles. The quad protocol (4-4-4) is left out: every command would change with it and
+  *         a reset of the MCU alone would leave the memory deaf to the 1-line reset of the init.
   * @param  hqspi: QSPI handle
-  * @retval None
+  * @retval QSPI memory status, QSPI_ERROR on a transfer error
   */
-static uint8_t QSPI_WriteEnable(QSPI_HandleTypeDef *hqspi)
+static uint8_t QSPI_ReadModeSelect(QSPI_HandleTypeDef *hqspi)
 {
-	QSPI_CommandTypeDef     sCommand;
-	QSPI_AutoPollingTypeDef sConfig;
+	uint8_t ref[QSPI_BENCH_SIZE], buf[QSPI_BENCH_SIZE];
+	uint32_t cycles, cost, best = 0xFFFFFFFFU;
+	uint8_t mode, loop, selected = QSPI_READ_MODE_NBR;
 
-	/* Enable write operations */
-	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
-	sCommand.Instruction       = WRITE_ENABLE_CMD;
-	sCommand.AddressMode       = QSPI_ADDRESS_NONE;
-	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-	sCommand.DataMode          = QSPI_DATA_NONE;
-	sCommand.DummyCycles       = 0;
-	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
-	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
-	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+	/* Cycle counter of the benchmark */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
-	if (HAL_QSPI_Command(&QSPIHandle, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK){return QSPI_ERROR;}
-  
-	/* Configure automatic polling mode to wait for write enabling */
-	sConfig.Match           = N25Q512A_SR_WREN;
-	sConfig.Mask            = N25Q512A_SR_WREN;
-	sConfig.MatchMode       = QSPI_MATCH_MODE_AND;
-	sConfig.StatusBytesSize = 1;
-	sConfig.Interval        = 0x10;
-	sConfig.AutomaticStop   = QSPI_AUTOMATIC_STOP_ENABLE;
+	for (cycles = 0U; cycles < QSPI_BENCH_SIZE; cycles++){ref[cycles] = QSPI_BENCH_PATTERN(cycles);}
 
-	sCommand.Instruction    = READ_STATUS_REG_CMD;
+	/* The pattern is looked for in the mode the memory supports since its reset */
+	qspiReadMode = QSPI_READ_MODE_1_1_4;
+	qspiBenchPatternFlag = 0U;
+	memset(qspiBench, 0, sizeof(qspiBench));
+	if (QSPI_ReadData(hqspi, buf, QSPI_BENCH_ADDR, QSPI_BENCH_SIZE) != QSPI_OK){return QSPI_ERROR;}
+	if (memcmp(buf, ref, QSPI_BENCH_SIZE) != 0){return QSPI_OK;}
+	qspiBenchPatternFlag = 1U;
+
+	for (mode = 0U; mode < QSPI_READ_MODE_NBR; mode++)
+	{
+		qspiReadMode = mode;
+		qspiBench[mode].Valid = 0U;
+		for (cycles = 0U; cycles < QSPI_BENCH_SIZE; cycles++){buf[cycles] = (uint8_t)~ref[cycles];}
+
+		/* The memory takes the dummy cycles of the mode */
+		if (QSPI_DummyCyclesCfg(hqspi, QSPI_READ_DUMMY_CYCLES(mode)) != QSPI_OK){break;}
+
+		/* Bulk read */
+		cycles = DWT->CYCCNT;
+		if (QSPI_ReadData(hqspi, buf, QSPI_BENCH_ADDR, QSPI_BENCH_SIZE) != QSPI_OK){break;}
+		qspiBench[mode].BulkCycles = DWT->CYCCNT - cycles;
+
+		/* Small reads, the unaligned address also checks the address phase */
+		cycles = DWT->CYCCNT;
+		for (loop = 0U; loop < QSPI_BENCH_LOOPS; loop++)
+		{
+			if (QSPI_ReadData(hqspi, &buf[QSPI_BENCH_SMALL_OFFSET], QSPI_BENCH_ADDR + QSPI_BENCH_SMALL_OFFSET, QSPI_BENCH_SMALL) != QSPI_OK){break;}
+		}
+		if (loop < QSPI_BENCH_LOOPS){break;}
+		qspiBench[mode].SmallCycles = (DWT->CYCCNT - cycles) / QSPI_BENCH_LOOPS;
+
+		/* A mode that reads wrong data is only left out */
+		if (memcmp(buf, ref, QSPI_BENCH_SIZE) != 0){continue;}
+
+		qspiBench[mode].Valid = 1U;
+		cost = qspiBench[mode].SmallCycles + qspiBench[mode].BulkCycles;
+		if (cost < best){best = cost; selected = mode;}
+	}
+
+	/* A transfer error is not a matter of the mode */
+	if ((mode < QSPI_READ_MODE_NBR) || (selected >= QSPI_READ_MODE_NBR))
+	{
+		qspiReadMode = QSPI_READ_MODE_1_1_4;
+		QSPI_DummyCyclesCfg(hqspi, QSPI_READ_DUMMY_CYCLES(QSPI_READ_MODE_1_1_4));
+		return QSPI_ERROR;
+	}
+
+	qspiReadMode = selected;
+
+	return QSPI_DummyCyclesCfg(hqspi, QSPI_READ_DUMMY_CYCLES(selected));
+}
+
+/**
+  * @brief  This function fills the read command of the current read mode, the address
+  *         and the size are left to the caller. The memory takes the dummy cycles of its
+  *         volatile configuration register for every read instruction, set for the mode.
+  * @param  sCommand: Command
+  * @retval None
+  */
+static void QSPI_ReadCommand(QSPI_CommandTypeDef *sCommand)
+{
+	sCommand->InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	sCommand->AddressSize       = QSPI_ADDRESS_32_BITS;
+	sCommand->AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	sCommand->DataMode          = QSPI_DATA_4_LINES;
+	sCommand->DummyCycles       = QSPI_READ_DUMMY_CYCLES(qspiReadMode);
+	sCommand->SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	switch (qspiReadMode)
+	{
+		case QSPI_READ_MODE_1_4_4:
+			sCommand->Instruction      = QUAD_INOUT_FAST_READ_CMD;
+			sCommand->AddressMode      = QSPI_ADDRESS_4_LINES;
+			sCommand->DdrMode          = QSPI_DDR_MODE_DISABLE;
+			sCommand->DdrHoldHalfCycle = QSPI_DDR_HHC_ANALOG_DELAY;
+			break;
+		case QSPI_READ_MODE_1_4_4_DTR:
+			sCommand->Instruction      = QUAD_INOUT_FAST_READ_DTR_CMD;
+			sCommand->AddressMode      = QSPI_ADDRESS_4_LINES;
+			sCommand->DdrMode          = QSPI_DDR_MODE_ENABLE;
+			sCommand->DdrHoldHalfCycle = QSPI_DDR_HHC_HALF_CLK_DELAY;
+			break;
+		default:
+			sCommand->Instruction      = QUAD_OUT_FAST_READ_CMD;
+			sCommand->AddressMode      = QSPI_ADDRESS_1_LINE;
+			sCommand->DdrMode          = QSPI_DDR_MODE_DISABLE;
+			sCommand->DdrHoldHalfCycle = QSPI_DDR_HHC_ANALOG_DELAY;
+			break;
+	}
+}
+
+/**
+  * @brief  This function sets the timing of a read, or back the one of the other commands:
+  *         a shorter chip select high time between reads, no sample shifting in DTR mode.
+  *         To be called while the QSPI is not busy.
+  * @param  hqspi: QSPI handle
+  * @param  ReadFlag: 1 before a read, 0 after it
+  * @retval None
+  */
+static void QSPI_ReadTiming(QSPI_HandleTypeDef *hqspi, uint8_t ReadFlag)
+{
+	if (ReadFlag)
+	{
+		MODIFY_REG(hqspi->Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_2_CYCLE);
+		if (QSPI_READ_MODE_1_4_4_DTR == qspiReadMode){MODIFY_REG(hqspi->Instance->CR, QUADSPI_CR_SSHIFT, QSPI_SAMPLE_SHIFTING_NONE);}
+	}
+	else
+	{
+		MODIFY_REG(hqspi->Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_5_CYCLE);
+		MODIFY_REG(hqspi->Instance->CR, QUADSPI_CR_SSHIFT, QSPI_SAMPLE_SHIFTING_HALFCYCLE);
+	}
+}
+
+/**
+  * @brief  This function reads an amount of data in the current read mode.
+  * @param  hqspi: QSPI handle
+  * @param  pData: Pointer to data to be read
+  * @param  ReadAddr: Read start address
+  * @param  Size: Size of data to read
+  * @retval QSPI memory status
+  */
+static uint8_t QSPI_ReadData(QSPI_HandleTypeDef *hqspi, uint8_t* pData, uint32_t ReadAddr, uint32_t Size)
+{
+	QSPI_CommandTypeDef sCommand;
+
+	/* Initialize the read command */
+	QSPI_ReadCommand(&sCommand);
+	sCommand.Address = ReadAddr;
+	sCommand.NbData  = Size;
+
+	QSPI_ReadTiming(hqspi, 1U);
+
+	/* Configure the command, then reception of the data */
+	if ((HAL_QSPI_Command(hqspi, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) || \
+		(HAL_QSPI_Receive(hqspi, pData, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK))
+	{
+		QSPI_ReadTiming(hqspi, 0U);
+		return QSPI_ERROR;
+	}
+
+	QSPI_ReadTiming(hqspi, 0U);
+	return QSPI_OK;
+}
+
+/**
+  * @brief  This function send a Write Enable and wait it is effective.
+  * @param  hqspi: QSPI handle
+  * @retval None
+  */
+static uint8_t QSPI_WriteEnable(QSPI_HandleTypeDef *hqspi)
+{
+	QSPI_CommandTypeDef     sCommand;
+	QSPI_AutoPollingTypeDef sConfig;
+
+	/* Enable write operations */
+	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	sCommand.Instruction       = WRITE_ENABLE_CMD;
+	sCommand.AddressMode       = QSPI_ADDRESS_NONE;
+	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	sCommand.DataMode          = QSPI_DATA_NONE;
+	sCommand.DummyCycles       = 0;
+	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	if (HAL_QSPI_Command(&QSPIHandle, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK){return QSPI_ERROR;}
+  
+	/* Configure automatic polling mode to wait for write enabling */
+	sConfig.Match           = N25Q512A_SR_WREN;
+	sConfig.Mask            = N25Q512A_SR_WREN;
+	sConfig.MatchMode       = QSPI_MATCH_MODE_AND;
+	sConfig.StatusBytesSize = 1;
+	sConfig.Interval        = 0x10;
+	sConfig.AutomaticStop   = QSPI_AUTOMATIC_STOP_ENABLE;
+
+	sCommand.Instruction    = READ_STATUS_REG_CMD;
 	sCommand.DataMode       = QSPI_DATA_1_LINE;
 
 	if (HAL_QSPI_AutoPolling(&QSPIHandle, &sCommand, &sConfig, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK){return QSPI_ERROR;}
@@ -776,6 +1299,378 @@ static uint8_t QSPI_AutoPollingMemReady(QSPI_HandleTypeDef *hqspi, uint32_t Time
   	return QSPI_OK;
 }
 
+/**
+  * @brief  This function aborts the memory-mapped mode, if active.
+  * @param  hqspi: QSPI handle
+  * @retval QSPI memory status
+  */
+static uint8_t QSPI_ExitMemoryMappedMode(QSPI_HandleTypeDef *hqspi)
+{
+	if(!qspiMemoryMappedFlag){return QSPI_OK;}
+
+	/* Abort the memory-mapped transfer, it also clears the prefetch buffer */
+	if (HAL_QSPI_Abort(hqspi) != HAL_OK){return QSPI_ERROR;}
+
+	QSPI_ReadTiming(hqspi, 0U);
+	qspiMemoryMappedFlag=0;
+	return QSPI_OK;
+}
+
+/**
+  * @brief  This function starts the status register polling of the memory, the status
+  *         match interrupt tells the end of the program or the erase.
+  * @param  hqspi: QSPI handle
+  * @retval QSPI memory status
+  */
+static uint8_t QSPI_AutoPollingMemReady_IT(QSPI_HandleTypeDef *hqspi)
+{
+	QSPI_CommandTypeDef     sCommand;
+	QSPI_AutoPollingTypeDef sConfig;
+
+	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	sCommand.Instruction       = READ_STATUS_REG_CMD;
+	sCommand.AddressMode       = QSPI_ADDRESS_NONE;
+	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	sCommand.DataMode          = QSPI_DATA_1_LINE;
+	sCommand.DummyCycles       = 0;
+	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	sConfig.Match           = 0;
+	sConfig.Mask            = N25Q512A_SR_WIP;
+	sConfig.MatchMode       = QSPI_MATCH_MODE_AND;
+	sConfig.StatusBytesSize = 1;
+	sConfig.Interval        = 0x10;
+	sConfig.AutomaticStop   = QSPI_AUTOMATIC_STOP_ENABLE;
+
+	/* Running before the interrupt can tell the end */
+	qspiOpState = QSPI_OP_RUNNING;
+	if (HAL_QSPI_AutoPolling_IT(hqspi, &sCommand, &sConfig) != HAL_OK)
+	{
+		qspiOpState = QSPI_OP_IDLE;
+		return QSPI_ERROR;
+	}
+
+	return QSPI_OK;
+}
+
+/**
+  * @brief  This function waits for the asynchronous requests to drain.
+  * @retval None
+  */
+static void QSPI_WaitIdle(void)
+{
+	while (qspiQueueCount){}
+}
+
+/**
+  * @brief  This function starts the request at the head of the queue.
+  * @retval None
+  */
+static void QSPI_Request_Start(void)
+{
+	QSPI_RequestTypeDef* pRequest = qspiQueue[qspiQueueHead];
+	uint8_t status;
+
+	/* Indirect access leaves the memory-mapped mode */
+	if (QSPI_ExitMemoryMappedMode(&QSPIHandle) != QSPI_OK)
+	{
+		QSPI_Request_Done(QSPI_ERROR);
+		return;
+	}
+
+	switch (pRequest->Type)
+	{
+		case QSPI_REQUEST_READ: status = QSPI_Request_Read(pRequest); break;
+		case QSPI_REQUEST_PROGRAM: status = QSPI_Request_Page(pRequest); break;
+		default: status = QSPI_Request_Erase(pRequest); break;
+	}
+
+	if (status != QSPI_OK){QSPI_Request_Done(status);}
+}
+
+/**
+  * @brief  This function ends the request at the head of the queue, starts the next one
+  *         and calls the completion callback.
+  * @param  Status: QSPI memory status of the request
+  * @retval None
+  */
+static void QSPI_Request_Done(uint8_t Status)
+{
+	QSPI_RequestTypeDef* pRequest = qspiQueue[qspiQueueHead];
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	qspiQueueHead = (qspiQueueHead + 1U) % QSPI_QUEUE_DEPTH;
+	qspiQueueCount--;
+	__set_PRIMASK(primask);
+
+	pRequest->Status = (Status == QSPI_OK) ? QSPI_OK : QSPI_ERROR;
+
+	if (qspiQueueCount){QSPI_Request_Start();}
+	if (pRequest->Callback != NULL){pRequest->Callback(pRequest);}
+}
+
+/**
+  * @brief  This function starts the DMA read of the next chunk of a request.
+  * @param  pRequest: Request
+  * @retval QSPI memory status
+  */
+static uint8_t QSPI_Request_Read(QSPI_RequestTypeDef* pRequest)
+{
+	QSPI_CommandTypeDef sCommand;
+	uint32_t size = pRequest->Size - pRequest->Offset;
+
+	if (size > QSPI_READ_CHUNK){size = QSPI_READ_CHUNK;}
+
+	QSPI_ReadCommand(&sCommand);
+	sCommand.Address           = pRequest->Address + pRequest->Offset;
+	sCommand.NbData            = size;
+
+	QSPI_ReadTiming(&QSPIHandle, 1U);
+
+	if ((HAL_QSPI_Command(&QSPIHandle, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) || \
+		(HAL_QSPI_Receive_DMA(&QSPIHandle, &pRequest->pData[pRequest->Offset]) != HAL_OK))
+	{
+		QSPI_ReadTiming(&QSPIHandle, 0U);
+		return QSPI_ERROR;
+	}
+
+	pRequest->Offset += size;
+	return QSPI_OK;
+}
+
+/**
+  * @brief  This function starts the DMA program of the next page of a request.
+  * @param  pRequest: Request
+  * @retval QSPI memory status
+  */
+static uint8_t QSPI_Request_Page(QSPI_RequestTypeDef* pRequest)
+{
+	QSPI_CommandTypeDef sCommand;
+	uint32_t addr = pRequest->Address + pRequest->Offset;
+	uint32_t size = N25Q512A_PAGE_SIZE - (addr % N25Q512A_PAGE_SIZE);
+
+	if (size > (pRequest->Size - pRequest->Offset)){size = pRequest->Size - pRequest->Offset;}
+
+	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	sCommand.Instruction       = QUAD_IN_FAST_PROG_CMD;
+	sCommand.AddressMode       = QSPI_ADDRESS_1_LINE;
+	sCommand.AddressSize       = QSPI_ADDRESS_32_BITS;
+	sCommand.Address           = addr;
+	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	sCommand.DataMode          = QSPI_DATA_4_LINES;
+	sCommand.DummyCycles       = 0;
+	sCommand.NbData            = size;
+	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	if (QSPI_WriteEnable(&QSPIHandle) != QSPI_OK){return QSPI_ERROR;}
+	if (HAL_QSPI_Command(&QSPIHandle, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK){return QSPI_ERROR;}
+	if (HAL_QSPI_Transmit_DMA(&QSPIHandle, &pRequest->pData[pRequest->Offset]) != HAL_OK){return QSPI_ERROR;}
+
+	pRequest->Offset += size;
+	return QSPI_OK;
+}
+
+/**
+  * @brief  This function sends the erase command of a request, the status match interrupt
+  *         tells its end.
+  * @param  pRequest: Request
+  * @retval QSPI memory status
+  */
+static uint8_t QSPI_Request_Erase(QSPI_RequestTypeDef* pRequest)
+{
+	QSPI_CommandTypeDef sCommand;
+
+	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	sCommand.Instruction       = (QSPI_REQUEST_ERASE_SECTOR == pRequest->Type) ? SECTOR_ERASE_CMD : SUBSECTOR_ERASE_CMD;
+	sCommand.AddressMode       = QSPI_ADDRESS_1_LINE;
+	sCommand.AddressSize       = QSPI_ADDRESS_32_BITS;
+	sCommand.Address           = pRequest->Address;
+	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	sCommand.DataMode          = QSPI_DATA_NONE;
+	sCommand.DummyCycles       = 0;
+	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	if (QSPI_WriteEnable(&QSPIHandle) != QSPI_OK){return QSPI_ERROR;}
+	if (HAL_QSPI_Command(&QSPIHandle, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK){return QSPI_ERROR;}
+
+	return QSPI_AutoPollingMemReady_IT(&QSPIHandle);
+}
+
+/**
+  * @brief  This function goes on with the request at the head of the queue once its
+  *         program or erase ended: the next page of a program, or the end of the request.
+  * @retval None
+  */
+static void QSPI_Request_Ready(void)
+{
+	QSPI_RequestTypeDef* pRequest = qspiQueue[qspiQueueHead];
+
+	if ((QSPI_REQUEST_PROGRAM == pRequest->Type) && (pRequest->Offset < pRequest->Size))
+	{
+		if (QSPI_Request_Page(pRequest) != QSPI_OK){QSPI_Request_Done(QSPI_ERROR);}
+	}
+	else{QSPI_Request_Done(QSPI_OK);}
+}
+
+/**
+  * @brief  This function reads the flag status register of the memory.
+  * @param  hqspi: QSPI handle
+  * @param  pReg: Register value
+  * @retval QSPI memory status
+  */
+static uint8_t QSPI_ReadFlagStatus(QSPI_HandleTypeDef *hqspi, uint8_t* pReg)
+{
+	QSPI_CommandTypeDef sCommand;
+
+	/* Initialize the read flag status register command */
+	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	sCommand.Instruction       = READ_FLAG_STATUS_REG_CMD;
+	sCommand.AddressMode       = QSPI_ADDRESS_NONE;
+	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	sCommand.DataMode          = QSPI_DATA_1_LINE;
+	sCommand.DummyCycles       = 0;
+	sCommand.NbData            = 1;
+	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	/* Configure the command, then reception of the data */
+	if (HAL_QSPI_Command(hqspi, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK){return QSPI_ERROR;}
+	if (HAL_QSPI_Receive(hqspi, pReg, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK){return QSPI_ERROR;}
+
+	return QSPI_OK;
+}
+
+/**
+  * @brief  This function suspends the program or the erase of the running request for a read,
+  *         from the thread mode. The status match interrupt is stopped first, then the memory
+  *         takes the suspend command and gets ready. An operation that ended meanwhile goes on
+  *         as on a status match. A resumed operation is not suspended again before
+  *         QSPI_RESUME_HOLD_TIME, repeated suspends would never let it end.
+  * @retval QSPI_OK once suspended, QSPI_BUSY when the requests are to be waited for
+  */
+static uint8_t QSPI_Suspend(void)
+{
+	QSPI_CommandTypeDef     sCommand;
+	QSPI_AutoPollingTypeDef sConfig;
+	uint32_t primask, cycles;
+	uint8_t reg;
+
+	if ((QSPI_OP_RUNNING != qspiOpState) || ((HAL_GetTick() - qspiResumeTick) <= QSPI_RESUME_HOLD_TIME)){return QSPI_BUSY;}
+
+	/* The status match interrupt cannot end the request anymore */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (QSPI_OP_RUNNING != qspiOpState)
+	{
+		__set_PRIMASK(primask);
+		return QSPI_BUSY;
+	}
+	qspiOpState = QSPI_OP_SUSPENDED;
+	__HAL_QSPI_DISABLE_IT(&QSPIHandle, (QSPI_IT_SM | QSPI_IT_TE));
+	__set_PRIMASK(primask);
+
+	cycles = DWT->CYCCNT;
+
+	/* Suspend command */
+	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	sCommand.Instruction       = PROG_ERASE_SUSPEND_CMD;
+	sCommand.AddressMode       = QSPI_ADDRESS_NONE;
+	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	sCommand.DataMode          = QSPI_DATA_NONE;
+	sCommand.DummyCycles       = 0;
+	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	/* Wait for the memory ready, the flag status register tells a suspend from an end */
+	sConfig.Match           = N25Q512A_FSR_READY;
+	sConfig.Mask            = N25Q512A_FSR_READY;
+	sConfig.MatchMode       = QSPI_MATCH_MODE_AND;
+	sConfig.StatusBytesSize = 1;
+	sConfig.Interval        = 0x10;
+	sConfig.AutomaticStop   = QSPI_AUTOMATIC_STOP_ENABLE;
+
+	/* Stop the polling, a match it left would end the next polling at once */
+	if (HAL_QSPI_Abort(&QSPIHandle) != HAL_OK)
+	{
+		qspiOpState = QSPI_OP_IDLE;
+		QSPI_Request_Done(QSPI_ERROR);
+		return QSPI_BUSY;
+	}
+	__HAL_QSPI_CLEAR_FLAG(&QSPIHandle, (QSPI_FLAG_SM | QSPI_FLAG_TE));
+
+	if (HAL_QSPI_Command(&QSPIHandle, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+	{
+		qspiOpState = QSPI_OP_IDLE;
+		QSPI_Request_Done(QSPI_ERROR);
+		return QSPI_BUSY;
+	}
+
+	sCommand.Instruction = READ_FLAG_STATUS_REG_CMD;
+	sCommand.DataMode    = QSPI_DATA_1_LINE;
+
+	if ((HAL_QSPI_AutoPolling(&QSPIHandle, &sCommand, &sConfig, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) || \
+		(QSPI_ReadFlagStatus(&QSPIHandle, &reg) != QSPI_OK))
+	{
+		qspiOpState = QSPI_OP_IDLE;
+		QSPI_Request_Done(QSPI_ERROR);
+		return QSPI_BUSY;
+	}
+
+	if (!(reg & (N25Q512A_FSR_PGSUS | N25Q512A_FSR_ERSUS)))
+	{
+		qspiOpState = QSPI_OP_IDLE;
+		QSPI_Request_Ready();
+		return QSPI_BUSY;
+	}
+
+	cycles = (DWT->CYCCNT - cycles) / (SystemCoreClock / 1000000U);
+	qspiSuspendStats.SuspendNbr++;
+	if (cycles > qspiSuspendStats.SuspendMax){qspiSuspendStats.SuspendMax = cycles;}
+
+	return QSPI_OK;
+}
+
+/**
+  * @brief  This function resumes the suspended program or erase, the status match interrupt
+  *         tells its end again.
+  * @retval QSPI memory status
+  */
+static uint8_t QSPI_Resume(void)
+{
+	QSPI_CommandTypeDef sCommand;
+
+	sCommand.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+	sCommand.Instruction       = PROG_ERASE_RESUME_CMD;
+	sCommand.AddressMode       = QSPI_ADDRESS_NONE;
+	sCommand.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+	sCommand.DataMode          = QSPI_DATA_NONE;
+	sCommand.DummyCycles       = 0;
+	sCommand.DdrMode           = QSPI_DDR_MODE_DISABLE;
+	sCommand.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+	sCommand.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+	qspiResumeTick = HAL_GetTick();
+
+	if ((HAL_QSPI_Command(&QSPIHandle, &sCommand, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK) || \
+		(QSPI_AutoPollingMemReady_IT(&QSPIHandle) != QSPI_OK))
+	{
+		qspiOpState = QSPI_OP_IDLE;
+		QSPI_Request_Done(QSPI_ERROR);
+		return QSPI_ERROR;
+	}
+
+	return QSPI_OK;
+}
+
 /**
   * @}
   */
@@ -77,6 +77,43 @@
 #define QSPI_D3_PIN                	BSP_FLASH_IO3_PIN
 #define QSPI_DA_GPIO_PORT          	BSP_FLASH_IO2_PORT
 
+/* Definition for the asynchronous requests: DMA channel, interrupt priority (under the HCI UART) and queue */
+#define QSPI_DMA_CLK_ENABLE()			__HAL_RCC_DMA1_CLK_ENABLE()
+#define QSPI_DMA_CHANNEL				DMA1_Channel5
+#define QSPI_DMA_REQUEST				DMA_REQUEST_5
+#define QSPI_DMA_IRQn					DMA1_Channel5_IRQn
+#define QSPI_IRQ_PRIORITY				2U
+#define QSPI_QUEUE_DEPTH				4U
+#define QSPI_READ_CHUNK					0x8000U /* Bytes per DMA read, below the 16-bit DMA counter */
+
+/* Asynchronous request types */
+#define QSPI_REQUEST_READ				((uint8_t)0x00)
+#define QSPI_REQUEST_PROGRAM			((uint8_t)0x01)
+#define QSPI_REQUEST_ERASE_BLOCK		((uint8_t)0x02)
+#define QSPI_REQUEST_ERASE_SECTOR		((uint8_t)0x03)
+
+/* Read modes (instruction-address-data lines), the fastest one that reads back right is chosen at init */
+#define QSPI_READ_MODE_1_1_4			((uint8_t)0x00) /* Quad output fast read */
+#define QSPI_READ_MODE_1_4_4			((uint8_t)0x01) /* Quad I/O fast read */
+#define QSPI_READ_MODE_1_4_4_DTR		((uint8_t)0x02) /* Quad I/O fast read, address and data on both clock edges */
+#define QSPI_READ_MODE_NBR				3U
+#define QSPI_READ_DUMMY_CYCLES(_mode)	((QSPI_READ_MODE_1_4_4_DTR == (_mode)) ? N25Q512A_DUMMY_CYCLES_READ_QUAD_DTR : N25Q512A_DUMMY_CYCLES_READ_QUAD)
+
+/* Read mode benchmark: a bulk read, then small reads at an unaligned address, of a pattern in the last subsector of the
+   memory. Every byte value appears once in the pattern, a mode has to read it back to be chosen. */
+#define QSPI_BENCH_ADDR					(N25Q512A_FLASH_SIZE - N25Q512A_SUBSECTOR_SIZE)
+#define QSPI_BENCH_PATTERN(_idx)		((uint8_t)(((_idx) * 0x4DU) + 0x5AU))
+#define QSPI_BENCH_SIZE					256U
+#define QSPI_BENCH_SMALL				16U
+#define QSPI_BENCH_SMALL_OFFSET			0x35U
+#define QSPI_BENCH_LOOPS				8U
+
+/* Program/erase states of the running request, a read suspends a running one */
+#define QSPI_OP_IDLE					((uint8_t)0x00)
+#define QSPI_OP_RUNNING					((uint8_t)0x01) /* Status polled by the status match interrupt */
+#define QSPI_OP_SUSPENDED				((uint8_t)0x02)
+#define QSPI_RESUME_HOLD_TIME			2U /* ms a resumed program or erase runs before it can be suspended again */
+
 /**
   * @}
   */
@@ -94,6 +131,34 @@ typedef struct{
 	uint32_t ProgPagesNumber;    /*!< Number of pages for the program operation */
 }QSPI_Info;
 
+/* QSPI asynchronous request, owned by the caller until its status leaves QSPI_BUSY */
+typedef struct QSPI_Request QSPI_RequestTypeDef;
+struct QSPI_Request{
+	uint8_t Type;                                       /*!< QSPI_REQUEST_xxx */
+	__IO uint8_t Status;                                /*!< QSPI_BUSY while queued, then QSPI_OK or QSPI_ERROR */
+	uint8_t* pData;                                     /*!< Data buffer of a read or a program */
+	uint32_t Address;                                   /*!< Memory address */
+	uint32_t Size;                                      /*!< Bytes to read or program */
+	void (*Callback)(QSPI_RequestTypeDef* pRequest);    /*!< Completion, called from the QSPI interrupt, may be NULL */
+	void* pContext;                                     /*!< Caller data */
+	uint32_t Offset;                                    /*!< Bytes done, used by the driver */
+};
+
+/* QSPI read mode benchmark */
+typedef struct{
+	uint32_t SmallCycles;        /*!< Core cycles of a QSPI_BENCH_SMALL bytes read */
+	uint32_t BulkCycles;         /*!< Core cycles of a QSPI_BENCH_SIZE bytes read */
+	uint8_t  Valid;              /*!< The mode read the benchmark pattern back */
+}QSPI_BenchTypeDef;
+
+/* QSPI program/erase suspend statistics */
+typedef struct{
+	uint32_t SuspendNbr;         /*!< Programs or erases suspended for a read */
+	uint32_t WaitNbr;            /*!< Reads that found an asynchronous request running */
+	uint32_t WaitMax;            /*!< Longest wait of such a read before its data, in us */
+	uint32_t SuspendMax;         /*!< Longest suspend, command to memory ready, in us */
+}QSPI_SuspendStatsTypeDef;
+
 /**
   * @}
   */
@@ -105,14 +170,26 @@ typedef struct{
 uint8_t BSP_QSPI_Init(void);
 uint8_t BSP_QSPI_Get_Init_Flag(void);
 uint8_t BSP_QSPI_Get_Lock_Flag(void);
+uint8_t BSP_QSPI_Get_Memory_Mapped_Flag(void);
+uint8_t BSP_QSPI_Get_Read_Mode(void);
+const QSPI_BenchTypeDef* BSP_QSPI_Get_Bench(uint8_t Mode);
+uint8_t BSP_QSPI_Write_Bench_Pattern(void);
 uint8_t BSP_QSPI_DeInit(void);
 uint8_t BSP_QSPI_Read(uint8_t* pData, uint32_t ReadAddr, uint32_t Size);
 uint8_t BSP_QSPI_Write(uint8_t* pData, uint32_t WriteAddr, uint32_t Size);
 uint8_t BSP_QSPI_Erase_Block(uint32_t BlockAddress);
+uint8_t BSP_QSPI_Erase_Sector(uint32_t SectorAddress);
 uint8_t BSP_QSPI_Erase_Chip(void);
 uint8_t BSP_QSPI_GetStatus(void);
 uint8_t BSP_QSPI_GetInfo(QSPI_Info* pInfo);
 uint8_t BSP_QSPI_EnableMemoryMappedMode(void);
+uint8_t BSP_QSPI_DisableMemoryMappedMode(void);
+uint8_t BSP_QSPI_Submit(QSPI_RequestTypeDef* pRequest);
+uint8_t BSP_QSPI_Wait(QSPI_RequestTypeDef* pRequest);
+uint8_t BSP_QSPI_Get_Busy_Flag(void);
+const QSPI_SuspendStatsTypeDef* BSP_QSPI_Get_Suspend_Stats(void);
+void BSP_QSPI_IRQHandler(void);
+void BSP_QSPI_DMA_IRQHandler(void);
 
 /**
   * @}
@@ -76,6 +76,7 @@ typedef struct _USBD_STORAGE
   int8_t (* Write)(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
   int8_t (* GetMaxLun)(void);
   int8_t *pInquiry;
+  int8_t (* Unmap)(uint8_t lun, uint32_t blk_addr, uint32_t blk_len);
 
 } USBD_StorageTypeDef;
 
@@ -73,6 +73,7 @@ extern "C" {
 
 #define SCSI_SEND_DIAGNOSTIC                        0x1DU
 #define SCSI_READ_FORMAT_CAPACITIES                 0x23U
+#define SCSI_UNMAP                                  0x42U
 
 #define NO_SENSE                                    0U
 #define RECOVERED_ERROR                             1U
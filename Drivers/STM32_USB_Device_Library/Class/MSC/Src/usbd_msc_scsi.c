@@ -92,6 +92,7 @@ static int8_t SCSI_Write12(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *param
 static int8_t SCSI_Read10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
 static int8_t SCSI_Read12(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
 static int8_t SCSI_Verify10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_Unmap(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
 static int8_t SCSI_CheckAddressRange(USBD_HandleTypeDef *pdev, uint8_t lun,
                                      uint32_t blk_offset, uint32_t blk_nbr);
 
@@ -185,6 +186,10 @@ int8_t SCSI_ProcessCmd(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *cmd)
     ret = SCSI_Verify10(pdev, lun, cmd);
     break;
 
+  case SCSI_UNMAP:
+    ret = SCSI_Unmap(pdev, lun, cmd);
+    break;
+
   default:
     SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, INVALID_CDB);
     hmsc->bot_status = USBD_BOT_STATUS_ERROR;
@@ -265,6 +270,14 @@ static int8_t SCSI_Inquiry(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *param
     {
       (void)SCSI_UpdateBotData(hmsc, MSC_Page80_Inquiry_Data, LENGTH_INQUIRY_PAGE80);
     }
+    else if (params[2] == 0xB0U) /* Request for VPD page 0xB0 Block Limits */
+    {
+      (void)SCSI_UpdateBotData(hmsc, MSC_PageB0_Inquiry_Data, LENGTH_INQUIRY_PAGEB0);
+    }
+    else if (params[2] == 0xB2U) /* Request for VPD page 0xB2 Logical Block Provisioning */
+    {
+      (void)SCSI_UpdateBotData(hmsc, MSC_PageB2_Inquiry_Data, LENGTH_INQUIRY_PAGEB2);
+    }
     else /* Request Not supported */
     {
       SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST,
@@ -370,6 +383,12 @@ static int8_t SCSI_ReadCapacity16(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t
   hmsc->bot_data[10] = (uint8_t)(hmsc->scsi_blk_size >>  8);
   hmsc->bot_data[11] = (uint8_t)(hmsc->scsi_blk_size);
 
+  /* LBPME: the logical blocks are provisioned, the host may unmap them */
+  if (((USBD_StorageTypeDef *)pdev->pUserData)->Unmap != NULL)
+  {
+    hmsc->bot_data[14] = 0x80U;
+  }
+
   hmsc->bot_data_length = ((uint32_t)params[10] << 24) |
                           ((uint32_t)params[11] << 16) |
                           ((uint32_t)params[12] <<  8) |
@@ -933,6 +952,125 @@ static int8_t SCSI_Verify10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *para
   return 0;
 }
 
+/**
+* @brief  SCSI_Unmap
+*         Process Unmap command, the parameter list is received before the
+*         block descriptors are passed to the storage
+* @param  lun: Logical unit number
+* @param  params: Command parameters
+* @retval status
+*/
+static int8_t SCSI_Unmap(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params)
+{
+  USBD_MSC_BOT_HandleTypeDef *hmsc = (USBD_MSC_BOT_HandleTypeDef *)pdev->pClassData;
+  uint32_t len;
+  uint32_t desc_len;
+  uint32_t blk_addr;
+  uint32_t blk_len;
+  uint8_t *pDesc;
+
+  len = ((uint32_t)params[7] << 8) | (uint32_t)params[8];
+
+  if (hmsc->bot_state == USBD_BOT_IDLE) /* Idle */
+  {
+    if (((USBD_StorageTypeDef *)pdev->pUserData)->Unmap == NULL)
+    {
+      SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, INVALID_CDB);
+      return -1;
+    }
+
+    /* case 8 : Hi <> Do */
+    if ((hmsc->cbw.dDataLength != 0U) && ((hmsc->cbw.bmFlags & 0x80U) == 0x80U))
+    {
+      SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST, INVALID_CDB);
+      return -1;
+    }
+
+    if ((hmsc->cbw.dDataLength != len) || (len > MSC_MEDIA_PACKET))
+    {
+      SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST, PARAMETER_LIST_LENGTH_ERROR);
+      return -1;
+    }
+
+    if (((USBD_StorageTypeDef *)pdev->pUserData)->IsReady(lun) != 0)
+    {
+      SCSI_SenseCode(pdev, lun, NOT_READY, MEDIUM_NOT_PRESENT);
+      return -1;
+    }
+
+    if (((USBD_StorageTypeDef *)pdev->pUserData)->IsWriteProtected(lun) != 0)
+    {
+      SCSI_SenseCode(pdev, lun, NOT_READY, WRITE_PROTECTED);
+      return -1;
+    }
+
+    /* An empty parameter list unmaps nothing */
+    if (len == 0U)
+    {
+      hmsc->bot_data_length = 0U;
+      return 0;
+    }
+
+    /* Prepare EP to receive the parameter list */
+    hmsc->bot_state = USBD_BOT_DATA_OUT;
+    (void)USBD_LL_PrepareReceive(pdev, MSC_EPOUT_ADDR, hmsc->bot_data, len);
+
+    return 0;
+  }
+
+  /* Parameter list received: 8 byte header, then 16 byte block descriptors */
+  if (len < 8U)
+  {
+    SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, PARAMETER_LIST_LENGTH_ERROR);
+    return -1;
+  }
+
+  desc_len = ((uint32_t)hmsc->bot_data[2] << 8) | (uint32_t)hmsc->bot_data[3];
+  desc_len = MIN(desc_len, (len - 8U)) & ~0x0FU;
+
+  for (pDesc = &hmsc->bot_data[8]; pDesc < &hmsc->bot_data[8U + desc_len]; pDesc += 16U)
+  {
+    blk_addr = ((uint32_t)pDesc[4] << 24) |
+               ((uint32_t)pDesc[5] << 16) |
+               ((uint32_t)pDesc[6] <<  8) |
+                (uint32_t)pDesc[7];
+
+    blk_len = ((uint32_t)pDesc[8] << 24) |
+              ((uint32_t)pDesc[9] << 16) |
+              ((uint32_t)pDesc[10] << 8) |
+               (uint32_t)pDesc[11];
+
+    /* The upper half of the 64 bit LBA is beyond the medium, the 32 bit sum must not wrap */
+    if (((pDesc[0] | pDesc[1] | pDesc[2] | pDesc[3]) != 0U) || ((blk_addr + blk_len) < blk_addr))
+    {
+      SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, ADDRESS_OUT_OF_RANGE);
+      return -1;
+    }
+
+    if (blk_len == 0U)
+    {
+      continue;
+    }
+
+    if (SCSI_CheckAddressRange(pdev, lun, blk_addr, blk_len) < 0)
+    {
+      return -1; /* error */
+    }
+
+    if (((USBD_StorageTypeDef *)pdev->pUserData)->Unmap(lun, blk_addr, blk_len) < 0)
+    {
+      SCSI_SenseCode(pdev, lun, HARDWARE_ERROR, WRITE_FAULT);
+      return -1;
+    }
+  }
+
+  /* case 12 : Ho = Do */
+  hmsc->csw.dDataResidue -= len;
+  MSC_BOT_SendCSW(pdev, USBD_CSW_CMD_PASSED);
+
+  return 0;
+}
+
 /**
 * @brief  SCSI_CheckAddressRange
 *         Check address range
@@ -37,6 +37,7 @@
 /* Global functions prototypes */
 void BSP_System_Clock_Config(void);
 void BSP_System_GPIO_Init(void);
+uint8_t BSP_USB_Get_VBUS_Status(void);
 void BSP_Error_Handler(void);
 void BSP_System_off(void);
 
@@ -11,6 +11,7 @@
 #include "SS1BTHIDS.h" /* Main SS1 HIDS Service Header */
 #include "BTPSKRNL.h" /* BTPS Kernel Header */
 #include "HCITRANS.h" /* HCI Transport Layer Header */
+#include "BTPSVEND.h" /* Vendor Specific Controller Bring-up Header */
 
 #define BT_HOGP_APPLICATION_ERROR_INVALID_PARAMETERS       			(-1000)
 #define BT_HOGP_APPLICATION_ERROR_UNABLE_TO_OPEN_STACK     			(-1001)
@@ -119,5 +120,7 @@ void BT_HOGP_Task_Handler(void);
 void BT_HOGP_Send_Data_Reports(const uint8_t* _data, uint8_t _nbr);
 void BT_HOGP_Update_Battery_Level(void);
 uint8_t BT_HOGP_Get_Connection_Status(void);
+void BT_HOGP_Warm_Up_Start(HCI_DriverInformation_t *_hciDriverInformation);
+uint8_t BT_HOGP_Warm_Up_Task(void);
 
 #endif
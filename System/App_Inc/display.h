@@ -7,6 +7,14 @@
 #define DISPLAY_MAX_CONTEXTS		4U
 #define DISPLAY_UPDATE_TMO			60U /* ms */
 #define DISPLAY_PASSWORD_NBR		5U
+#define DISPLAY_LIST_ROWS			4U
+
+typedef enum {
+	DISPLAY_USB_WAIT = 0U,
+	DISPLAY_USB_PLUGGED,
+	DISPLAY_USB_RELOAD,
+	DISPLAY_USB_FORMAT /* The edit of a blank memory waits for the format to be confirmed */
+} display_usb_status_te;
 
 typedef struct {
 	uint8_t context;
@@ -14,9 +22,11 @@ typedef struct {
 	uint8_t passwordNbr;
 	uint8_t verticalListIdx;
 	uint16_t horizontalListIdx;
+	uint8_t sortFlag;
 	uint8_t xDirection;
 	int16_t xScroll;
 	uint8_t btFlag;
+	display_usb_status_te usbStatus;
 } display_ts;
 
 /* Global functions declarations */
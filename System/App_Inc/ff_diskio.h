@@ -1,6 +1,53 @@
 #ifndef __FF_DISKIO_H
 #define __FF_DISKIO_H
 
+/* Disk geometry, the last 64 KB block of the QSPI memory is reserved outside the FAT volume (PIN and usage logs, QSPI read
+   mode pattern). The logical sectors of the volume are spread over the rest of the memory by the FTL (ff_ftl.c), the
+   subsectors left over keep the writes out of place. */
+#define DISKIO_PHY_BLK_NBR	0x4000U
+#define DISKIO_RSV_BLK_NBR	16U
+#define DISKIO_RSV_BLK_BASE	(DISKIO_PHY_BLK_NBR - DISKIO_RSV_BLK_NBR)
+#define DISKIO_BLK_NBR		0x2000U
+#define DISKIO_BLK_SIZ  	0x1000
+#define DISKIO_ERASE_BLK_NBR	16U /* Sectors in a 64 KB sector of the QSPI memory */
+
+/* Write-back sector cache in front of the QSPI memory, it also keeps the single sector reads of the FatFs window (_FS_TINY) */
+#define DISKIO_CACHE_NBR		2U
+#define DISKIO_CACHE_FLUSH_TMO	2000U /* ms without a cached write before the dirty sectors are programmed */
+
+/* Subsector location in the QSPI memory and in the memory-mapped QSPI window */
+#define DISKIO_SECTOR_ADDR(_sector)		((uint32_t)(_sector) * DISKIO_BLK_SIZ)
+#define DISKIO_SECTOR_MMAP(_sector)		((const uint8_t*)(QSPI_BASE + DISKIO_SECTOR_ADDR(_sector)))
+
+/* Sector write statistics, a write is skipped when the sector already holds the data, programmed in place
+   when it only clears bits and written out of place by the FTL otherwise */
+typedef struct{
+	uint32_t skipNbr;
+	uint32_t programNbr;
+	uint32_t remapNbr;
+	uint32_t pageNbr; /* Pages programmed by the writes */
+}diskio_write_stats_ts;
+
+/* Sector cache statistics, the read counters only cover the single sector reads */
+typedef struct{
+	uint32_t writeNbr; /* Sector writes taken by the write-back cache */
+	uint32_t mergeNbr; /* Cached writes that replaced a dirty copy of the same sector */
+	uint32_t flushNbr; /* Dirty sectors programmed by the write-back cache */
+	uint32_t readHits;
+	uint32_t readMisses;
+	uint32_t readFills; /* Missed reads kept as clean copies */
+}diskio_cache_stats_ts;
+
 extern Diskio_drvTypeDef  FF_Driver;
 
+DRESULT DISKIO_Read_Sectors(uint8_t* _buff, uint32_t _sector, uint32_t _count);
+DRESULT DISKIO_Write_Sectors(const uint8_t* _buff, uint32_t _sector, uint32_t _count);
+DRESULT DISKIO_Trim_Sectors(uint32_t _sector, uint32_t _count);
+const uint8_t* DISKIO_Map_Sectors(uint32_t _sector, uint32_t _count);
+DRESULT DISKIO_Cache_Flush(void);
+void DISKIO_Cache_Invalidate(void);
+void DISKIO_Cache_Task(void);
+const diskio_write_stats_ts* DISKIO_Get_Write_Stats(void);
+const diskio_cache_stats_ts* DISKIO_Get_Cache_Stats(void);
+
 #endif
@@ -0,0 +1,92 @@
+#ifndef __FF_FTL_H
+#define __FF_FTL_H
+
+#include "ff_gen_drv.h"
+#include "n25q512a_qspi.h"
+#include "ff_diskio.h"
+
+/* Physical layout of the QSPI memory in 4 KB subsectors: the data pool, two checkpoints of the mapping table,
+   the log of the remaps since the last checkpoint, then the reserved block */
+#define FF_FTL_TABLE_BLK_NBR		((DISKIO_BLK_NBR * sizeof(uint16_t)) / DISKIO_BLK_SIZ)
+#define FF_FTL_CKPT_BLK_NBR			(FF_FTL_TABLE_BLK_NBR + 1U) /* The table, then the header */
+#define FF_FTL_LOG_BLK_NBR			8U
+#define FF_FTL_LOG_BASE				(DISKIO_RSV_BLK_BASE - FF_FTL_LOG_BLK_NBR)
+#define FF_FTL_CKPT_BASE(_area)		(FF_FTL_LOG_BASE - ((2U - (_area)) * FF_FTL_CKPT_BLK_NBR))
+#define FF_FTL_PHY_NBR				FF_FTL_CKPT_BASE(0U) /* Subsectors of the data pool */
+#define FF_FTL_MAP_WORDS			((FF_FTL_PHY_NBR + 31U) / 32U)
+#define FF_FTL_UNMAPPED				0xFFFFU
+#define FF_FTL_CKPT_MAGIC			0x4C54464CUL /* "FTL" checkpoint */
+#define FF_FTL_RECORD_CHECK			0xA55AU
+#define FF_FTL_LOG_NBR				(DISKIO_BLK_SIZ / sizeof(ftl_record_ts)) /* Records per log subsector */
+#define FF_FTL_LOG_SIZE				(FF_FTL_LOG_BLK_NBR * FF_FTL_LOG_NBR)
+#define FF_FTL_CKPT_LEVEL			((FF_FTL_LOG_SIZE * 3U) / 4U) /* Records logged before the idle task writes a checkpoint */
+#define FF_FTL_ERASED_AHEAD			16U /* Data subsectors kept erased ahead of the allocation */
+#define FF_FTL_GC_SCAN				8U /* Subsectors blank checked per FF_FTL_Task call */
+#define FF_FTL_GC_IDLE_TMO			500U /* ms without a disk write before the task erases */
+#define FF_FTL_SECTOR_ERASE_MIN		4U /* Subsectors left to erase in a free 64 KB sector that are worth one sector erase */
+#define FF_FTL_BOOT_SIGNATURE		0xAA55U /* Boot sector and partition table signature at offset 510 */
+#define FF_FTL_BOOT_PART_OFFSET		446U /* First partition entry of a partition table */
+
+/* Remap record of the log, programmed once the data of the new subsector is. A discard logs FF_FTL_UNMAPPED. */
+typedef struct {
+	uint16_t logical;
+	uint16_t physical;
+	uint16_t generation; /* Checkpoint the record follows */
+	uint16_t check;
+} ftl_record_ts;
+
+/* Checkpoint header, programmed after the table it closes */
+typedef struct {
+	uint32_t magic;
+	uint16_t generation;
+	uint16_t logicalNbr;
+	uint32_t checksum; /* FNV-1a of the table */
+	uint32_t check;
+} ftl_header_ts;
+
+typedef struct {
+	uint32_t checkpointNbr;
+	uint32_t recordNbr; /* Remaps logged */
+	uint32_t gcEraseNbr; /* Subsectors erased by the idle task */
+	uint32_t syncEraseNbr; /* Subsectors erased on the write path */
+	uint32_t blankNbr; /* Free subsectors found erased by a blank check */
+	uint32_t trimNbr; /* Logical sectors unmapped by a discard */
+	uint32_t sectorEraseNbr; /* 64 KB sectors erased by the idle task */
+	uint16_t erasedNbr; /* Free subsectors known to be erased */
+	uint16_t discardNbr; /* Discarded subsectors waiting for the idle task */
+	uint16_t generation;
+	uint8_t oversizeFlag; /* The memory holds a volume larger than the logical sectors, left unmapped and untouched until written */
+} ftl_stats_ts;
+
+typedef struct {
+	uint16_t table[DISKIO_BLK_NBR]; /* Logical sector to data pool subsector */
+	uint32_t usedMap[FF_FTL_MAP_WORDS];
+	uint32_t erasedMap[FF_FTL_MAP_WORDS];
+	uint32_t discardMap[FF_FTL_MAP_WORDS]; /* Free subsectors released by a discard, not erased yet */
+	uint8_t page[N25Q512A_PAGE_SIZE] __attribute__((aligned(4)));
+	QSPI_RequestTypeDef erase; /* Idle erase, runs in the background */
+	ftl_stats_ts stats;
+	uint32_t logPosition;
+	uint32_t writeTick;
+	uint16_t allocIdx;
+	uint16_t discardIdx;
+	uint16_t eraseBase; /* First subsector of the idle erase */
+	uint8_t eraseNbr; /* Subsectors the idle erase marks erased once it ends */
+	uint16_t generation;
+	uint8_t area;
+	uint8_t mountFlag;
+	uint8_t hostFlag; /* USB host attached, no idle work */
+} ftl_ts;
+
+/* Global functions declarations */
+DRESULT FF_FTL_Mount(void);
+uint16_t FF_FTL_Get_Physical(uint32_t _sector);
+DRESULT FF_FTL_Read(uint8_t* _buff, uint32_t _sector, uint32_t _count);
+uint16_t FF_FTL_Allocate(uint32_t _sector);
+DRESULT FF_FTL_Commit(uint32_t _sector, uint16_t _physical);
+DRESULT FF_FTL_Trim(uint32_t _sector, uint32_t _count);
+void FF_FTL_Task(void);
+void FF_FTL_Set_Host_Flag(uint8_t _hostFlag);
+const ftl_stats_ts* FF_FTL_Get_Stats(void);
+
+#endif
@@ -7,29 +7,355 @@
 
 #define FF_PROFILE_DATA_FNAME			_T("data.txt")
 #define FF_PROFILE_ERROR_LOG_FNAME		_T("error.txt")
+#define FF_PROFILE_IMAGE_FNAME			_T("data.bin")
+#define FF_PROFILE_BUILD_FNAME			_T("data.new")
+#define FF_PROFILE_SORT_FNAME			_T("sort.tmp")
+#define FF_PROFILE_VAULT_DIR			_T("vault")
+#define FF_PROFILE_VAULT_PATTERN		_T("*.txt")
+#define FF_PROFILE_FORMAT_OPT			(FM_FAT | FM_SFD) /* FAT16 without partition table */
+#define FF_PROFILE_FORMAT_AU			DISKIO_BLK_SIZ /* One cluster per logical sector */
+#define FF_PROFILE_IMAGE_MAGIC			0x46525053UL /* "SPRF" */
+#define FF_PROFILE_IMAGE_VERSION		7U
+#define FF_PROFILE_SOURCE_NBR			16U /* data.txt and the text files of the vault folder */
+#define FF_PROFILE_PATH_SIZE			20U /* "vault/" + 8.3 name */
+#define FF_PROFILE_CACHE_SIZE			32U
+#define FF_PROFILE_ARENA_SIZE			4096U
+#define FF_PROFILE_CLMT_SIZE			32U
+#define FF_PROFILE_NO_DATA				0xFFFFU
+#define FF_PROFILE_IMAGE_TIME(_fno)		(((uint32_t)(_fno)->fdate << 16U) | (_fno)->ftime)
+#define FF_PROFILE_MAX_DATA				(FF_PROFILE_NO_DATA - 1U)
+#define FF_PROFILE_MAX_FIELDS			16U
+#define FF_PROFILE_URL_SIZE				128U
+#define FF_PROFILE_FIELD_SIZE			128U
+#define FF_PROFILE_TOKEN_SIZE			(FF_PROFILE_FIELD_SIZE + 16U) /* Longest "name:value" token */
+#define FF_PROFILE_SORT_KEY_SIZE		14U
+#define FF_PROFILE_GROUP_NBR			27U /* '#' and 'A' - 'Z' */
+#define FF_PROFILE_RECORD_SIZE			(FF_PROFILE_URL_SIZE + 2U + (FF_PROFILE_MAX_FIELDS * (FF_PROFILE_FIELD_SIZE + 2U)))
+#define FF_PROFILE_POOL_NBR				32U
+#define FF_PROFILE_POOL_SIZE			1024U
+#define FF_PROFILE_POOL_CANDIDATES		64U /* Values seen once, a value is pooled on its second occurrence */
+#define FF_PROFILE_POOL_FIELDS			((1U << FF_PROFILE_FIELD_EMAIL) | (1U << FF_PROFILE_FIELD_USER))
+#define FF_PROFILE_POOL_REF				0xFFU /* Field size of a pooled value, the next byte is the pool index */
+#define FF_PROFILE_NO_POOL				0xFFU
+#define FF_PROFILE_COMPRESS				1U /* 1: the cached records are kept compressed against the image dictionary */
+#define FF_PROFILE_DICT_NBR				48U
+#define FF_PROFILE_DICT_WORD_SIZE		16U
+#define FF_PROFILE_DICT_MIN				3U
+#define FF_PROFILE_DICT_SIZE			(FF_PROFILE_DICT_NBR * (FF_PROFILE_DICT_WORD_SIZE + 1U))
+#define FF_PROFILE_DICT_TOKEN			0x80U /* Packed byte of the first dictionary word */
+#define FF_PROFILE_DICT_ESCAPE			0xFFU /* Packed byte followed by a literal byte >= 0x80 */
+#define FF_PROFILE_LOAD_SLICE			5U /* ms of load steps per FF_PROFILE_Load_Task call */
+#define FF_PROFILE_STEP_SECTORS			4U /* Image sectors checked per step */
+#define FF_PROFILE_STEP_RECORDS			16U /* Records compiled per step */
+#define FF_PROFILE_STACK_PAINT			0xA5A5A5A5UL
+#define FF_PROFILE_STACK_GUARD			64U /* Bytes left unpainted below the current frame */
+#define FF_PROFILE_PIN_LOG_SLOTS		(DISKIO_RSV_BLK_NBR / 2U) /* The upper half of the reserved block holds the usage log */
+#define FF_PROFILE_PIN_LOG_ADDR(_slot)	DISKIO_SECTOR_ADDR(DISKIO_RSV_BLK_BASE + (_slot))
+#define FF_PROFILE_PIN_LOG_MAGIC		0x4C50U /* "PL" */
+#define FF_PROFILE_PIN_FAIL_MAX			3U
+#define FF_PROFILE_PIN_FAIL				0xF0U
+#define FF_PROFILE_PIN_CLEAR			0x00U
+#define FF_PROFILE_USAGE_SLOTS			(DISKIO_RSV_BLK_NBR - FF_PROFILE_PIN_LOG_SLOTS - 1U) /* The last subsector holds the QSPI read mode pattern */
+#define FF_PROFILE_USAGE_ADDR(_slot)	FF_PROFILE_PIN_LOG_ADDR(FF_PROFILE_PIN_LOG_SLOTS + (_slot))
+#define FF_PROFILE_USAGE_MAGIC			0x5355U /* "US" */
+#define FF_PROFILE_USAGE_NBR			64U
+#define FF_PROFILE_USAGE_RECENT			3U /* Last used entries listed ahead of the frequency order */
+#define FF_PROFILE_USAGE_FLUSH_TMO		10000U /* ms without a use before the pending records are programmed */
+#define FF_PROFILE_USAGE_CLOCK_MAX		0xF000U /* The stamps are renumbered before the use clock wraps */
+#define FF_PROFILE_USAGE_CHECK			0x5AU
 
+typedef enum {
+	FF_PROFILE_FIELD_EMAIL,
+	FF_PROFILE_FIELD_USER,
+	FF_PROFILE_FIELD_PASSWORD,
+	FF_PROFILE_FIELD_NOTES,
+	FF_PROFILE_FIELD_OTP,
+	FF_PROFILE_FIELD_TYPES
+} profile_field_type_te;
+
+typedef enum {
+	FF_PROFILE_PARSE_COUNT,
+	FF_PROFILE_PARSE_URL,
+	FF_PROFILE_PARSE_FIELD_NBR,
+	FF_PROFILE_PARSE_FIELD,
+	FF_PROFILE_PARSE_DONE
+} profile_parse_state_te;
+
+typedef enum {
+	FF_PROFILE_ORDER_VAULT,
+	FF_PROFILE_ORDER_URL,
+	FF_PROFILE_ORDER_RECENT
+} profile_order_te;
+
+typedef enum {
+	FF_PROFILE_LOAD_MOUNT,
+	FF_PROFILE_LOAD_CHECK,
+	FF_PROFILE_LOAD_OFFSETS,
+	FF_PROFILE_LOAD_TABLES,
+	FF_PROFILE_LOAD_RECORDS,
+	FF_PROFILE_LOAD_INDEX,
+	FF_PROFILE_LOAD_DONE
+} profile_load_state_te;
+
+/* NUL terminated string inside a packed record */
+typedef struct {
+	const uint8_t* buffer;
+	uint8_t size;
+} profile_string_ts;
+
+/* Profile entry view, the strings point into the record arena or the string pool */
 typedef struct {
-	uint8_t url[128];
-	uint8_t urlSize;
+	profile_string_ts url;
 	uint8_t dataNbr;
-	uint8_t dataNameCode[3];
-	uint8_t dataSize[3];
-	uint8_t dataBuffer[3][64];
-} profile_data_ts;
+	uint8_t dataNameCode[FF_PROFILE_MAX_FIELDS];
+	profile_string_ts data[FF_PROFILE_MAX_FIELDS];
+} profile_view_ts;
+
+/* data.bin layout (contiguous when possible): header, source table, string pool, uint32_t record offset per entry, packed records,
+   uint16_t entry index per sorted position, uint16_t first sorted position per letter group (+ end).
+   The entries of each source are consecutive, in the source table order.
+   Record: urlSize, url[urlSize], 0, dataNbr, {nameCode, size, data[size], 0} x dataNbr.
+   A repeated email or user value is stored once in the pool as {size, data[size], 0}, the field becomes {nameCode, 0xFF, poolIdx}.
+   The image ends with the dictionary of the most frequent URL prefixes and domain labels, {size, word[size]} x dictNbr.
+   The records are copied into the RAM arena as they are, or packed against the dictionary with FF_PROFILE_COMPRESS. */
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t dataNbr;
+	uint16_t sourceNbr;
+	uint16_t poolSize;
+	uint16_t dictSize;
+	uint16_t dictNbr;
+	uint32_t imageSize;
+	uint32_t indexOffset;
+	uint32_t crc;
+} profile_image_header_ts;
+
+/* Vault source file, the same entry is stored in the data.bin source table */
+typedef struct {
+	char path[FF_PROFILE_PATH_SIZE];
+	uint32_t size;
+	uint32_t time;
+	uint16_t dataNbr;
+	uint16_t imageIdx; /* First entry in data.bin, FF_PROFILE_NO_DATA when the source has to be parsed */
+} profile_source_ts;
+
+/* sort.tmp entry: letter group, lower case URL prefix */
+typedef struct {
+	uint8_t key[FF_PROFILE_SORT_KEY_SIZE];
+	uint16_t dataIdx;
+} profile_sort_key_ts;
+
+typedef struct {
+	uint32_t pos;
+	uint32_t end;
+	profile_sort_key_ts* buffer;
+	uint16_t bufferSize;
+	uint16_t bufferIdx;
+	uint16_t bufferLen;
+} profile_sort_run_ts;
+
+typedef struct {
+	FIL* file;
+	uint8_t* buffer;
+	uint32_t bufferSize;
+	uint32_t bufferIdx;
+	uint32_t bufferLen;
+	uint32_t readNbr;
+	uint8_t crcFlag;
+	uint32_t crc;
+} profile_reader_ts;
+
+/* Dictionary candidate, counted with the Misra-Gries frequent item scheme while the records are written */
+typedef struct {
+	uint8_t word[FF_PROFILE_DICT_WORD_SIZE];
+	uint8_t size;
+	uint16_t count;
+} profile_dict_word_ts;
+
+typedef struct {
+	FIL* file;
+	uint32_t crc;
+	uint8_t status;
+} profile_writer_ts;
+
+typedef struct {
+	profile_parse_state_te state;
+	uint16_t dataNbr;
+	uint16_t dataIdx;
+	uint8_t fieldNbr;
+	uint8_t fieldIdx;
+	uint16_t recordLen;
+	uint16_t poolRefNbr;
+	uint32_t poolSaved;
+} profile_parser_ts;
+
+/* Resumable load, the check and compile context is kept here between the steps */
+typedef struct {
+	profile_load_state_te state;
+	profile_image_header_ts header; /* Image being checked or compiled */
+	profile_reader_ts reader;
+	profile_parser_ts parser;
+	profile_writer_ts writer;
+	profile_dict_word_ts dict[FF_PROFILE_DICT_NBR];
+	uint32_t recordsLen;
+	uint32_t recordsStart;
+	uint32_t tableLen; /* Offset table bytes left to copy */
+	uint32_t busyTime; /* us */
+	uint16_t dataIdx;
+	uint16_t recordIdx;
+	uint8_t sourceIdx;
+	uint8_t sourceOpenFlag;
+} profile_load_ts;
+
+/* Load statistics of the last vault load, the f_read counters keep running in the open mode */
+typedef struct {
+	uint32_t loadTime; /* ms spent in the load steps */
+	uint32_t loadStepMax; /* us */
+	uint16_t loadStepNbr;
+	uint32_t readCalls;
+	uint32_t readBytes;
+	uint32_t stackPeak;
+	uint32_t staticSize;
+	uint16_t dataNbr;
+	uint8_t compileFlag;
+	uint8_t blankFlag; /* The memory holds no FAT volume, the load stopped at the mount */
+	uint8_t sourceNbr;
+	uint8_t parseNbr;
+	uint8_t poolNbr;
+	uint16_t poolSize;
+	uint16_t poolRefNbr; /* References written by the parsed sources */
+	uint32_t poolSaved; /* Bytes the references save against inline copies */
+	uint8_t dictNbr;
+	uint16_t dictSize;
+	uint32_t packNbr; /* Records packed into the arena */
+	uint32_t packRawBytes;
+	uint32_t packBytes;
+	uint32_t unpackNbr; /* Records unpacked into the scratch buffer */
+	uint32_t unpackCycles;
+	uint32_t unpackMax;
+	uint8_t usageNbr; /* Entries with a usage record */
+	uint16_t usageWrites; /* Usage records programmed in this session */
+	uint8_t usageMoves; /* Usage log slots erased in this session */
+} profile_stats_ts;
+
+/* PIN log slot: header, then one byte per entry programmed into the erased area */
+typedef struct {
+	uint16_t magic;
+	uint16_t sequence;
+} profile_pin_log_header_ts;
+
+typedef struct {
+	uint8_t slot;
+	uint16_t sequence;
+	uint16_t entryIdx;
+	uint8_t failNbr;
+} profile_pin_log_ts;
+
+/* Usage log slot: header, then the records programmed into the erased area. A later record of the same index replaces
+   the earlier one, a record with a zero count frees its index. The live records are copied to the next slot when one is full. */
+typedef struct {
+	uint16_t magic;
+	uint16_t sequence;
+} profile_usage_header_ts;
+
+typedef struct {
+	uint8_t recordIdx;
+	uint8_t check; /* XOR of the other bytes and FF_PROFILE_USAGE_CHECK, a torn record is skipped */
+	uint16_t dataIdx; /* Vault order entry index at the last use */
+	uint32_t urlHash;
+	uint16_t count;
+	uint16_t stamp; /* Use clock at the last use */
+} profile_usage_record_ts;
+
+/* Usage table, the list orders hold record indexes and are kept sorted by insertion as the records change */
+typedef struct {
+	profile_usage_record_ts record[FF_PROFILE_USAGE_NBR];
+	uint8_t pendingFlag[FF_PROFILE_USAGE_NBR];
+	uint8_t rank[FF_PROFILE_USAGE_NBR]; /* By use count, then by the last use */
+	uint8_t entry[FF_PROFILE_USAGE_NBR]; /* By vault entry index */
+	uint8_t recent[FF_PROFILE_USAGE_RECENT]; /* Last uses, newest first */
+	uint8_t rankNbr;
+	uint8_t recentNbr;
+	uint8_t pendingNbr;
+	uint16_t clock;
+	uint16_t lastIdx; /* Entry of the last use, repeated sends from one entry count once */
+	uint32_t useTick;
+	uint8_t slot;
+	uint16_t sequence;
+	uint16_t recordPos; /* Offset of the next record in the slot */
+	uint8_t logFlag; /* The reserved block is outside the FAT volume */
+	uint8_t openFlag;
+	uint8_t resolveFlag;
+} profile_usage_ts;
+
+/* Cached record descriptor */
+typedef struct {
+	uint16_t dataIdx;
+	uint16_t arenaIdx;
+	uint16_t arenaSize;
+	uint8_t packFlag;
+	uint32_t useStamp;
+} profile_cache_ts;
 
 typedef struct {
 	char ffPath[4];
 	FATFS ffFs;
 	FIL dataFile;
-	FIL errLogFile;
+	FIL imageFile;
+	FIL sortFile;
+	FIL buildFile;
+	DWORD imageClmt[FF_PROFILE_CLMT_SIZE];
+	CRC_HandleTypeDef crc;
+	uint8_t ffBuffer[DISKIO_BLK_SIZ] __ALIGNED(4);
+	profile_stats_ts stats;
+	profile_load_ts load;
+	profile_source_ts source[FF_PROFILE_SOURCE_NBR];
+	uint8_t sourceNbr;
 	uint16_t dataNbr;
-	profile_data_ts data[200];
+	uint32_t offsetTable;
+	uint32_t indexOffset;
+	const uint8_t* imageMap;
+	uint16_t groupStart[FF_PROFILE_GROUP_NBR + 1U];
+	uint8_t pool[FF_PROFILE_POOL_SIZE];
+	uint16_t poolOffset[FF_PROFILE_POOL_NBR];
+	uint8_t poolNbr;
+	uint16_t poolLen;
+	uint8_t poolBaseNbr;
+	uint16_t poolBaseLen;
+	uint32_t poolCandidate[FF_PROFILE_POOL_CANDIDATES];
+	uint8_t poolCandidateIdx;
+	uint8_t dict[FF_PROFILE_DICT_SIZE];
+	uint16_t dictOffset[FF_PROFILE_DICT_NBR];
+	uint8_t dictNbr;
+	uint8_t sortFlag; /* The list positions are in URL order */
+	profile_order_te order;
+	profile_usage_ts usage;
+	uint32_t useStamp;
+	profile_cache_ts cache[FF_PROFILE_CACHE_SIZE];
+	uint16_t arenaLen;
+	uint8_t arena[FF_PROFILE_ARENA_SIZE] __ALIGNED(4);
+	profile_view_ts view;
+	uint16_t viewIdx; /* Entry unpacked into ffBuffer, FF_PROFILE_NO_DATA when the scratch buffer was reused */
 } profile_ts;
 
 /* Global functions definitions */
 void FF_PROFILE_Init(void);
+void FF_PROFILE_Reload(void);
+uint8_t FF_PROFILE_Load_Task(void);
+profile_load_state_te FF_PROFILE_Get_Load_State(void);
 void FF_PROFILE_Check_Error_Log(uint8_t _status);
-uint8_t FF_PROFILE_Get_Data_Number(void);
-profile_data_ts* FF_PROFILE_Get_Data(uint16_t _dataIdx);
+void FF_PROFILE_Format(void);
+const profile_stats_ts* FF_PROFILE_Get_Stats(void);
+uint16_t FF_PROFILE_Get_Data_Number(void);
+const profile_view_ts* FF_PROFILE_Get_Data(uint16_t _dataIdx);
+void FF_PROFILE_Prefetch(uint16_t _dataIdx);
+void FF_PROFILE_Set_Order(profile_order_te _order);
+uint16_t FF_PROFILE_Record_Use(uint16_t _dataIdx);
+void FF_PROFILE_Usage_Task(void);
+void FF_PROFILE_Usage_Flush(void);
+uint8_t FF_PROFILE_Get_Group(uint16_t _dataIdx);
+uint16_t FF_PROFILE_Get_Group_Start(uint8_t _group);
+uint16_t FF_PROFILE_Jump_Group(uint16_t _dataIdx, uint8_t _nextFlag);
 
 #endif
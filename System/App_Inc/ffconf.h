@@ -170,7 +170,7 @@
   */
 
 /* System Configurations */
-#define _FS_TINY    			0 /* 0:Normal or 1:Tiny */
+#define _FS_TINY    			1 /* 0:Normal or 1:Tiny */
 /** This option switches tiny buffer configuration. (0:Normal or 1:Tiny)
   * At the tiny configuration, size of file object (FIL) is reduced _MAX_SS bytes.
   * Instead of private sector buffer eliminated from the file object, common sector
@@ -197,7 +197,7 @@
   * These options have no effect at read-only configuration (_FS_READONLY = 1).
   */
 
-#define _FS_LOCK    			2 /* 0:Disable or >=1:Enable */
+#define _FS_LOCK    			4 /* 0:Disable or >=1:Enable */
 /** The option _FS_LOCK switches file lock function to control duplicated file open
   * and illegal operation to open objects. This option must be 0 when _FS_READONLY
   * is 1.
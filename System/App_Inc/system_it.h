@@ -12,5 +12,7 @@ void DebugMon_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
 void USB_IRQHandler(void);
+void QUADSPI_IRQHandler(void);
+void DMA1_Channel5_IRQHandler(void);
 
 #endif
@@ -112,8 +112,6 @@ void BSP_System_GPIO_Init(void)
 	_gpioInitStruct.Pull = GPIO_NOPULL;
 	_gpioInitStruct.Pin = GPIO_PIN_13;
 	HAL_GPIO_Init(GPIOC, &_gpioInitStruct);
-	_gpioInitStruct.Pin = BSP_USB_VBUS_PIN;
-	HAL_GPIO_Init(BSP_USB_VBUS_PORT, &_gpioInitStruct);
 	/* Configure unused GPIO pins : PH0 PH1 PH3 */
 	_gpioInitStruct.Pin = GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_3;
 	HAL_GPIO_Init(GPIOH, &_gpioInitStruct);
@@ -124,6 +122,12 @@ void BSP_System_GPIO_Init(void)
 	_gpioInitStruct.Pin = GPIO_PIN_9;
 	HAL_GPIO_Init(GPIOB, &_gpioInitStruct);
 
+	/* Configure GPIO pin : USB_VBUS_Pin, cable detection in the edit mode */
+	_gpioInitStruct.Mode = GPIO_MODE_INPUT;
+	_gpioInitStruct.Pull = GPIO_PULLDOWN;
+	_gpioInitStruct.Pin = BSP_USB_VBUS_PIN;
+	HAL_GPIO_Init(BSP_USB_VBUS_PORT, &_gpioInitStruct);
+
 	HAL_GPIO_WritePin(GPIOB,GPIO_PIN_7, GPIO_PIN_RESET);
 	HAL_GPIO_WritePin(GPIOB,GPIO_PIN_8, GPIO_PIN_RESET);
 	_gpioInitStruct.Mode = GPIO_MODE_OUTPUT_PP;
@@ -160,6 +164,18 @@ void BSP_System_GPIO_Init(void)
 	HAL_GPIO_Init(GPIOA, &_gpioInitStruct);
 }
 
+/**
+  ***************************************************************************************************************************************
+  * @brief  USB VBUS status
+  * @param  None
+  * @retval USB cable plugged flag (uint8_t)
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_USB_Get_VBUS_Status(void)
+{
+	return (GPIO_PIN_SET == HAL_GPIO_ReadPin(BSP_USB_VBUS_PORT, BSP_USB_VBUS_PIN));
+}
+
 /**
   ***************************************************************************************************************************************
   * @brief  This function is executed in case of error occurrence
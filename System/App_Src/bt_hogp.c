@@ -190,6 +190,9 @@ int BT_HOGP_Application_Init(HCI_DriverInformation_t *_hciDriverInformation, BTP
 	/* Next, makes sure that the Driver Information passed appears to be semi-valid. */
 	if((_hciDriverInformation) && (_btpsInitialization))
 	{
+		/* The stack takes over the controller once the warm up is over, a failed warm up is redone by the stack */
+		while(!HCI_VS_WarmUpProcess()){}
+
 		/* Try to Open the stack and check if it was successful. */
 		if(!BT_HOGP_Open_Stack(_hciDriverInformation, _btpsInitialization))
 		{
@@ -2320,3 +2323,27 @@ uint8_t BT_HOGP_Get_Connection_Status(void)
 {
 	return BT_HOGP_ApplicationStateInfo.LEConnectionInfo.connectionFlag;
 }
+
+/**
+  ***************************************************************************************************************************************
+  * @brief Start the controller bring-up and the patch download in the background, the stack is only opened by BT_HOGP_Application_Init
+  * @param HCI driver information (HCI_DriverInformation_t*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void BT_HOGP_Warm_Up_Start(HCI_DriverInformation_t *_hciDriverInformation)
+{
+	HCI_VS_WarmUpStart(_hciDriverInformation);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief Advance the controller bring-up, never blocks
+  * @param None
+  * @retval Bring-up over (uint8_t)
+  ***************************************************************************************************************************************
+  */
+uint8_t BT_HOGP_Warm_Up_Task(void)
+{
+	return (uint8_t)HCI_VS_WarmUpProcess();
+}
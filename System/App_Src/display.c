@@ -27,6 +27,14 @@ static void DISPLAY_Prepare_4_Context(display_ts* _display);
 static void DISPLAY_Battery_Status(uint8_t _x, uint8_t _y);
 static void DISPLAY_Selection_Mark(uint8_t _x, uint8_t _y);
 
+static const char* const DISPLAY_FIELD_LABELS[FF_PROFILE_FIELD_TYPES] = {
+	"EMAIL",
+	"USER",
+	"PASSWORD",
+	"NOTES",
+	"OTP"
+};
+
 typedef void (*f_display)(display_ts* _display);
 static const f_display DISPLAY_CONTEXTS[DISPLAY_MAX_CONTEXTS] = {
 	DISPLAY_Prepare_1_Context,
@@ -97,13 +105,19 @@ static void DISPLAY_Prepare_2_Context(display_ts* _display)
 
 	SSD1306_Fill(OLED_COLOR_BLACK);
 	DISPLAY_Battery_Status(79U, 0U);
-	sprintf(_numBuff, "  0/%d", FF_PROFILE_Get_Data_Number());
+
+	/* A blank memory has nothing to open, the EDIT item formats it */
+	if(FF_PROFILE_Get_Stats()->blankFlag){sprintf(_numBuff, "NO FILESYS");}
+	else{sprintf(_numBuff, "  0/%d", FF_PROFILE_Get_Data_Number());}
+
 	SSD1306_Draw_String(0, 0, 0, _numBuff, &TM_Font_7x10, OLED_COLOR_WHITE);
 	SSD1306_Draw_Line(0, 14, 127, 14, OLED_COLOR_WHITE);
-	SSD1306_Draw_String(10, 30, 0, "OPEN", &TM_Font_7x10, OLED_COLOR_WHITE);
-	SSD1306_Draw_String(10, 40, 0, "EDIT", &TM_Font_7x10, OLED_COLOR_WHITE);
+	SSD1306_Draw_String(10, 20, 0, "OPEN", &TM_Font_7x10, OLED_COLOR_WHITE);
+	SSD1306_Draw_String(10, 30, 0, (FF_PROFILE_Get_Stats()->blankFlag ? "FORMAT" : "EDIT"), &TM_Font_7x10, OLED_COLOR_WHITE);
+	SSD1306_Draw_String(10, 40, 0, "A-Z", &TM_Font_7x10, OLED_COLOR_WHITE);
+	SSD1306_Draw_String(10, 50, 0, "RECENT", &TM_Font_7x10, OLED_COLOR_WHITE);
 	SSD1306_Draw_Line(0, 63, 127, 63, OLED_COLOR_WHITE);
-	DISPLAY_Selection_Mark(0U, (_display->verticalListIdx * 10U + 30U));
+	DISPLAY_Selection_Mark(0U, (_display->verticalListIdx * 10U + 20U));
 	SSD1306_Driver_Update();
 }
 
@@ -117,10 +131,14 @@ static void DISPLAY_Prepare_2_Context(display_ts* _display)
 static void DISPLAY_Prepare_3_Context(display_ts* _display)
 {
 	uint8_t _idx;
-	uint8_t* _buff;
+	uint8_t _firstRow;
+	uint8_t _group;
+	uint16_t _groupStart;
+	uint16_t _groupSize;
+	const profile_string_ts* _string;
 	int16_t _xLength;
 	char _numBuff[16];
-	profile_data_ts* _data = FF_PROFILE_Get_Data(_display->horizontalListIdx);
+	const profile_view_ts* _data = FF_PROFILE_Get_Data(_display->horizontalListIdx);
 
 	SSD1306_Fill(OLED_COLOR_BLACK);
 	DISPLAY_Battery_Status(79U, 0U);
@@ -128,7 +146,20 @@ static void DISPLAY_Prepare_3_Context(display_ts* _display)
 	if(_display->btFlag){SSD1306_Draw_String(58, 0, 0, ">>", &TM_Font_7x10, OLED_COLOR_WHITE);}
 	else{SSD1306_Draw_String(58, 0, 0, "  ", &TM_Font_7x10, OLED_COLOR_WHITE);}
 
-	if((_display->horizontalListIdx + 1U) < 10U){sprintf(_numBuff,"  %d/%d",(_display->horizontalListIdx + 1),FF_PROFILE_Get_Data_Number());}
+	/* A-Z mode - letter group and the position inside of it */
+	if(_display->sortFlag)
+	{
+		_group = FF_PROFILE_Get_Group(_display->horizontalListIdx);
+		_groupStart = FF_PROFILE_Get_Group_Start(_group);
+		_groupSize = FF_PROFILE_Get_Group_Start(_group + 1U) - _groupStart;
+
+		if(_groupSize < 100U)
+		{sprintf(_numBuff, "%c %2d/%d", ((0U == _group) ? '#' : ('A' + _group - 1U)), (_display->horizontalListIdx - _groupStart + 1), _groupSize);}
+		else{sprintf(_numBuff, "%c %5d", ((0U == _group) ? '#' : ('A' + _group - 1U)), (_display->horizontalListIdx - _groupStart + 1));}
+	}
+	/* The total does not fit next to the BT mark beyond three digits */
+	else if(FF_PROFILE_Get_Data_Number() >= 1000U){sprintf(_numBuff, "%5d", (_display->horizontalListIdx + 1));}
+	else if((_display->horizontalListIdx + 1U) < 10U){sprintf(_numBuff,"  %d/%d",(_display->horizontalListIdx + 1),FF_PROFILE_Get_Data_Number());}
 	// cppcheck-suppress knownConditionTrueFalse
 	else if(((_display->horizontalListIdx + 1U) >= 10U) && ((_display->horizontalListIdx + 1U) < 100U))
 	{sprintf(_numBuff, " %d/%d", (_display->horizontalListIdx + 1), FF_PROFILE_Get_Data_Number());}
@@ -138,35 +169,29 @@ static void DISPLAY_Prepare_3_Context(display_ts* _display)
 	SSD1306_Draw_String(0, 0, 0, _numBuff, &TM_Font_7x10, OLED_COLOR_WHITE);
 	SSD1306_Draw_Line(0, 14, 127, 14, OLED_COLOR_WHITE);
 
-	if(0U == _display->verticalListIdx){SSD1306_Draw_String(_display->xScroll, 20, 10, (char*)_data->url, &TM_Font_7x10, OLED_COLOR_WHITE);}
-	else{SSD1306_Draw_String(10, 20, 10, "NAME", &TM_Font_7x10, OLED_COLOR_WHITE);}
+	/* Row 0 is the URL, the field rows scroll with the selection */
+	_firstRow = (_display->verticalListIdx >= DISPLAY_LIST_ROWS) ? (_display->verticalListIdx - DISPLAY_LIST_ROWS + 1U) : 0U;
 
-	for(_idx = 0U; _idx < _data->dataNbr; _idx++)
+	for(_idx = _firstRow; (_idx < (_firstRow + DISPLAY_LIST_ROWS)) && (_idx <= _data->dataNbr); _idx++)
 	{
-		if(_display->verticalListIdx == (_idx + 1U))
-		{SSD1306_Draw_String(_display->xScroll, (_idx * 10 + 30), 10, (char*)_data->dataBuffer[_idx], &TM_Font_7x10, OLED_COLOR_WHITE);}
-		else
+		if(_display->verticalListIdx == _idx)
 		{
-			if(0U == _data->dataNameCode[_idx]){SSD1306_Draw_String(10, (_idx * 10 + 30), 10, "EMAIL", &TM_Font_7x10, OLED_COLOR_WHITE);}
-			else if(1U == _data->dataNameCode[_idx]){SSD1306_Draw_String(10, (_idx * 10 + 30), 10, "USER", &TM_Font_7x10, OLED_COLOR_WHITE);}
-			else if(2U == _data->dataNameCode[_idx]){SSD1306_Draw_String(10, (_idx * 10 + 30), 10, "PASSWORD", &TM_Font_7x10, OLED_COLOR_WHITE);}
+			_string = (0U == _idx) ? &_data->url : &_data->data[_idx - 1U];
+			SSD1306_Draw_String(_display->xScroll, ((_idx - _firstRow) * 10 + 20), 10, (char*)_string->buffer, &TM_Font_7x10, OLED_COLOR_WHITE);
 		}
+		else if(0U == _idx){SSD1306_Draw_String(10, 20, 10, "NAME", &TM_Font_7x10, OLED_COLOR_WHITE);}
+		else
+		{SSD1306_Draw_String(10, ((_idx - _firstRow) * 10 + 20), 10, (char*)DISPLAY_FIELD_LABELS[_data->dataNameCode[_idx - 1U]], &TM_Font_7x10, OLED_COLOR_WHITE);}
 	}
 
 	SSD1306_Draw_Line(0, 63, 127, 63, OLED_COLOR_WHITE);
-	DISPLAY_Selection_Mark(0U, (_display->verticalListIdx * 10U + 20U));
+	DISPLAY_Selection_Mark(0U, ((_display->verticalListIdx - _firstRow) * 10U + 20U));
 	SSD1306_Driver_Update();
 
-	_idx=0U;
-	if(0U == _display->verticalListIdx){_buff=_data->url;}
-	else{_buff=_data->dataBuffer[_display->verticalListIdx - 1U];}
+	if(0U == _display->verticalListIdx){_string=&_data->url;}
+	else{_string=&_data->data[_display->verticalListIdx - 1U];}
 
-	while(*_buff)
-	{
-		_idx++;
-		_buff++;
-	}
-	_xLength = _idx * 7 + 3;
+	_xLength = _string->size * 7 + 3;
 
 	if(_xLength > 118)
 	{
@@ -198,9 +223,25 @@ static void DISPLAY_Prepare_4_Context(display_ts* _display)
 	sprintf(_numBuff, "  0/%d", FF_PROFILE_Get_Data_Number());
 	SSD1306_Draw_String(0, 0, 0, _numBuff, &TM_Font_7x10, OLED_COLOR_WHITE);
 	SSD1306_Draw_Line(0, 14, 127, 14, OLED_COLOR_WHITE);
-	SSD1306_Draw_String(14, 20, 0, "PLUG USB CABLE", &TM_Font_7x10, OLED_COLOR_WHITE);
-	SSD1306_Draw_String(38, 30, 0, "TO EDIT", &TM_Font_7x10, OLED_COLOR_WHITE);
-	SSD1306_Draw_String(3, 50, 0, "OFF/ON TO RESTART", &TM_Font_7x10, OLED_COLOR_WHITE);
+	switch(_display->usbStatus)
+	{
+		case(DISPLAY_USB_PLUGGED):
+			SSD1306_Draw_String(25, 20, 0, "USB EDITING", &TM_Font_7x10, OLED_COLOR_WHITE);
+			SSD1306_Draw_String(11, 50, 0, "EJECT TO FINISH", &TM_Font_7x10, OLED_COLOR_WHITE);
+			break;
+		case(DISPLAY_USB_RELOAD):
+			SSD1306_Draw_String(29, 30, 0, "LOADING...", &TM_Font_7x10, OLED_COLOR_WHITE);
+			break;
+		case(DISPLAY_USB_FORMAT):
+			SSD1306_Draw_String(15, 20, 0, "FORMAT MEMORY?", &TM_Font_7x10, OLED_COLOR_WHITE);
+			SSD1306_Draw_String(40, 40, 0, "OK: YES", &TM_Font_7x10, OLED_COLOR_WHITE);
+			SSD1306_Draw_String(15, 50, 0, "OTHER KEY: OFF", &TM_Font_7x10, OLED_COLOR_WHITE);
+			break;
+		default:
+			SSD1306_Draw_String(14, 20, 0, "PLUG USB CABLE", &TM_Font_7x10, OLED_COLOR_WHITE);
+			SSD1306_Draw_String(38, 30, 0, "TO EDIT", &TM_Font_7x10, OLED_COLOR_WHITE);
+			break;
+	}
 	SSD1306_Draw_Line(0, 63, 127, 63, OLED_COLOR_WHITE);
 	SSD1306_Driver_Update();
 }
@@ -17,13 +17,36 @@
 #include <string.h>
 #include "ff_gen_drv.h"
 #include "n25q512a_qspi.h"
+#include "ff_diskio.h"
+#include "ff_ftl.h"
 
 /* Disk status */
-#define DISKIO_BLK_NBR	0x4000
-#define DISKIO_BLK_SIZ  0x1000
 static volatile DSTATUS Stat = STA_NOINIT;
 
+/* Write-back cache sector */
+typedef struct{
+	uint32_t sector;
+	uint32_t stamp; /* Order of the last write, the dirty sectors are programmed oldest first */
+	uint8_t validFlag;
+	uint8_t dirtyFlag;
+	uint8_t data[DISKIO_BLK_SIZ] __attribute__((aligned(4)));
+}diskio_cache_ts;
+
+static diskio_cache_ts DiskioCache[DISKIO_CACHE_NBR];
+static uint32_t DiskioCacheClock;
+static uint32_t DiskioCacheTick; /* HAL tick of the last cached write */
+
+/* Page read back by the sector writes */
+static uint8_t DiskioPage[N25Q512A_PAGE_SIZE] __attribute__((aligned(4)));
+static diskio_write_stats_ts DiskioWriteStats;
+static diskio_cache_stats_ts DiskioCacheStats;
+
 /* Private function prototypes */
+static diskio_cache_ts* DISKIO_Cache_Find(uint32_t _sector);
+static diskio_cache_ts* DISKIO_Cache_Oldest(uint8_t _dirtyFlag);
+static DRESULT DISKIO_Cache_Program(diskio_cache_ts* _slot);
+static DRESULT DISKIO_Cache_Write(const uint8_t* _buff, uint32_t _sector);
+static void DISKIO_Cache_Fill(const uint8_t* _buff, uint32_t _sector);
 DSTATUS USER_initialize(BYTE _pdrv);
 DSTATUS USER_status(BYTE _pdrv);
 DRESULT USER_read(BYTE _pdrv, BYTE *_buff, DWORD _sector, UINT _count);
@@ -56,8 +79,8 @@ Diskio_drvTypeDef FF_Driver = {
 DSTATUS USER_initialize(BYTE _pdrv)
 {
 	if(BSP_QSPI_Get_Lock_Flag()){Stat |= STA_NOINIT;}
-	else if(BSP_QSPI_Get_Init_Flag()){Stat &= ~STA_NOINIT;}
-	else if(BSP_QSPI_Init() != QSPI_OK){Stat |= STA_NOINIT;}
+	else if((!BSP_QSPI_Get_Init_Flag()) && (BSP_QSPI_Init() != QSPI_OK)){Stat |= STA_NOINIT;}
+	else if(RES_OK != FF_FTL_Mount()){Stat |= STA_NOINIT;}
 	else{Stat &= ~STA_NOINIT;}
 
     return Stat;
@@ -95,12 +118,34 @@ DSTATUS USER_status(BYTE _pdrv)
   */
 DRESULT USER_read(BYTE _pdrv, BYTE *_buff, DWORD _sector, UINT _count)
 {
-	uint32_t _bufferSize = (DISKIO_BLK_SIZ * _count);
-	uint32_t _address = (_sector * DISKIO_BLK_SIZ);
+	diskio_cache_ts* _slot;
 
 	if(BSP_QSPI_Get_Lock_Flag()){return RES_ERROR;}
 
-	if(QSPI_OK != BSP_QSPI_Read(_buff, _address, _bufferSize)){return RES_ERROR;}
+	if((1U == _count) && (NULL != (_slot = DISKIO_Cache_Find(_sector))))
+	{
+		memcpy(_buff, _slot->data, DISKIO_BLK_SIZ);
+		DiskioCacheStats.readHits++;
+		return RES_OK;
+	}
+
+	if(RES_OK != DISKIO_Read_Sectors(_buff, _sector, _count)){return RES_ERROR;}
+
+	/* The file data, FAT and directory sectors share the FatFs window, a clean copy saves reading them again */
+	if(1U == _count)
+	{
+		DiskioCacheStats.readMisses++;
+		DISKIO_Cache_Fill(_buff, _sector);
+		return RES_OK;
+	}
+
+	/* The dirty sectors in the range are newer than the memory */
+	for(uint8_t _idx = 0U; _idx < DISKIO_CACHE_NBR; _idx++)
+	{
+		_slot = &DiskioCache[_idx];
+		if(_slot->validFlag && _slot->dirtyFlag && ((_slot->sector - _sector) < _count))
+		{memcpy(&_buff[(_slot->sector - _sector) * DISKIO_BLK_SIZ], _slot->data, DISKIO_BLK_SIZ);}
+	}
 
 	return RES_OK;
 }
@@ -118,23 +163,373 @@ DRESULT USER_read(BYTE _pdrv, BYTE *_buff, DWORD _sector, UINT _count)
 #if (1U == _USE_WRITE)
 DRESULT USER_write(BYTE _pdrv, const BYTE *_buff, DWORD _sector, UINT _count)
 {
-	uint32_t _subsectorAddr = (_sector * DISKIO_BLK_SIZ);
-	uint32_t _bufferSize = (DISKIO_BLK_SIZ * _count);
-	uint32_t _address = (_sector * DISKIO_BLK_SIZ);
+	diskio_cache_ts* _slot;
 
 	if(BSP_QSPI_Get_Lock_Flag()){return RES_ERROR;}
 
-	for(uint32_t _i = 0U; _i < _count; _i++)
+	/* Single sectors are the FAT, directory and partial file sector updates, they are cached */
+	if(1U == _count){return DISKIO_Cache_Write(_buff, _sector);}
+
+	/* A direct file write goes behind the writes cached before it, the cached copies of its sectors are dropped */
+	if(RES_OK != DISKIO_Cache_Flush()){return RES_ERROR;}
+
+	for(uint8_t _idx = 0U; _idx < DISKIO_CACHE_NBR; _idx++)
 	{
-		if(QSPI_OK != BSP_QSPI_Erase_Block(_subsectorAddr)){return RES_ERROR;}
-		_subsectorAddr += DISKIO_BLK_SIZ;
+		_slot = &DiskioCache[_idx];
+		if((_slot->sector - _sector) < _count){_slot->validFlag = 0U;}
 	}
 
-	if(QSPI_OK != BSP_QSPI_Write((uint8_t*)_buff, _address, _bufferSize)){return RES_ERROR;}
+	return DISKIO_Write_Sectors(_buff, _sector, _count);
+}
+#endif /* _USE_WRITE == 1 */
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Read sectors of the volume through the FTL, shared by FatFs and the USB mass storage
+  * @param  *buff: Data buffer to store read data
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to read
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+DRESULT DISKIO_Read_Sectors(uint8_t* _buff, uint32_t _sector, uint32_t _count)
+{
+	return FF_FTL_Read(_buff, _sector, _count);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Write sectors of the volume, shared by FatFs and the USB mass storage. Each sector is read back page by page first:
+  *         an unchanged sector is skipped, a sector that only needs 1 to 0 bit transitions gets its changed pages programmed
+  *         in place, any other sector is written out of place into an erased subsector from the FTL with its pages that are
+  *         not blank, and remapped once programmed. No write waits for an erase while the FTL keeps erased subsectors ahead.
+  * @param  *buff: Data to be written
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to write
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+DRESULT DISKIO_Write_Sectors(const uint8_t* _buff, uint32_t _sector, uint32_t _count)
+{
+	const uint8_t* _data;
+	uint32_t _page, _byte;
+	uint16_t _pageMask, _physical;
+	uint8_t _remapFlag;
+
+	for(; _count; _count--, _sector++, _buff += DISKIO_BLK_SIZ)
+	{
+		_physical = FF_FTL_Get_Physical(_sector);
+		_pageMask = 0U;
+		_remapFlag = 0U;
+
+		for(_page = 0U; (_page < (DISKIO_BLK_SIZ / N25Q512A_PAGE_SIZE)) && (!_remapFlag); _page++)
+		{
+			_data = &_buff[_page * N25Q512A_PAGE_SIZE];
+
+			/* A sector never written reads erased */
+			if(FF_FTL_UNMAPPED == _physical){memset(DiskioPage, 0xFF, N25Q512A_PAGE_SIZE);}
+			else if(QSPI_OK != BSP_QSPI_Read(DiskioPage, (DISKIO_SECTOR_ADDR(_physical) + (_page * N25Q512A_PAGE_SIZE)), N25Q512A_PAGE_SIZE))
+			{return RES_ERROR;}
+			if(0 == memcmp(DiskioPage, _data, N25Q512A_PAGE_SIZE)){continue;}
+
+			_pageMask |= (uint16_t)(1U << _page);
+			if(FF_FTL_UNMAPPED == _physical){_remapFlag = 1U;}
+
+			/* Programming only clears bits, a bit to be set needs a new copy */
+			for(_byte = 0U; (_byte < N25Q512A_PAGE_SIZE) && (!_remapFlag); _byte++)
+			{
+				if((DiskioPage[_byte] & _data[_byte]) != _data[_byte]){_remapFlag = 1U;}
+			}
+		}
+
+		if(!_pageMask)
+		{
+			DiskioWriteStats.skipNbr++;
+			continue;
+		}
+
+		if(_remapFlag)
+		{
+			if(FF_FTL_UNMAPPED == (_physical = FF_FTL_Allocate(_sector))){return RES_ERROR;}
+			DiskioWriteStats.remapNbr++;
+
+			/* The new subsector reads 0xFF, blank pages need no program */
+			_pageMask = 0U;
+			for(_page = 0U; _page < (DISKIO_BLK_SIZ / N25Q512A_PAGE_SIZE); _page++)
+			{
+				_data = &_buff[_page * N25Q512A_PAGE_SIZE];
+				for(_byte = 0U; (_byte < N25Q512A_PAGE_SIZE) && (0xFFU == _data[_byte]); _byte++){}
+				if(_byte < N25Q512A_PAGE_SIZE){_pageMask |= (uint16_t)(1U << _page);}
+			}
+		}
+		else{DiskioWriteStats.programNbr++;}
+
+		for(_page = 0U; _page < (DISKIO_BLK_SIZ / N25Q512A_PAGE_SIZE); _page++)
+		{
+			if(!(_pageMask & (1U << _page))){continue;}
+			if(QSPI_OK != BSP_QSPI_Write((uint8_t*)&_buff[_page * N25Q512A_PAGE_SIZE], (DISKIO_SECTOR_ADDR(_physical) + (_page * N25Q512A_PAGE_SIZE)), N25Q512A_PAGE_SIZE))
+			{return RES_ERROR;}
+			DiskioWriteStats.pageNbr++;
+		}
+
+		if((_remapFlag) && (RES_OK != FF_FTL_Commit(_sector, _physical))){return RES_ERROR;}
+	}
 
 	return RES_OK;
 }
-#endif /* _USE_WRITE == 1 */
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Discard sectors of the volume, shared by the FatFs trim and the USB mass storage unmap. The cached copies of the range
+  *         are dropped, the other dirty sectors are programmed first so the memory keeps the writes and the discard in order.
+  * @param  sector: First sector (LBA)
+  * @param  count: Number of sectors
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+DRESULT DISKIO_Trim_Sectors(uint32_t _sector, uint32_t _count)
+{
+	if(((_sector + _count) > DISKIO_BLK_NBR) || ((_sector + _count) < _sector)){return RES_PARERR;}
+
+	for(uint8_t _idx = 0U; _idx < DISKIO_CACHE_NBR; _idx++)
+	{
+		if((DiskioCache[_idx].sector >= _sector) && (DiskioCache[_idx].sector < (_sector + _count))){DiskioCache[_idx].validFlag = 0U;}
+	}
+
+	if(RES_OK != DISKIO_Cache_Flush()){return RES_ERROR;}
+
+	return FF_FTL_Trim(_sector, _count);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Get the memory-mapped QSPI window of a sector range, it exists when the FTL placed the sectors one after the other.
+  *         A dirty cached sector of the range is newer than the memory, the cache is flushed before the sectors are located.
+  * @param  sector: First sector (LBA)
+  * @param  count: Number of sectors
+  * @retval Window, NULL when the range is not contiguous in the memory or the flush failed
+  ***************************************************************************************************************************************
+  */
+const uint8_t* DISKIO_Map_Sectors(uint32_t _sector, uint32_t _count)
+{
+	uint16_t _physical;
+
+	for(uint8_t _idx = 0U; _idx < DISKIO_CACHE_NBR; _idx++)
+	{
+		if(DiskioCache[_idx].validFlag && DiskioCache[_idx].dirtyFlag && ((DiskioCache[_idx].sector - _sector) < _count))
+		{
+			if(RES_OK != DISKIO_Cache_Flush()){return NULL;}
+			break;
+		}
+	}
+
+	_physical = FF_FTL_Get_Physical(_sector);
+	if(FF_FTL_UNMAPPED == _physical){return NULL;}
+
+	for(uint32_t _idx = 1U; _idx < _count; _idx++)
+	{
+		if(FF_FTL_Get_Physical(_sector + _idx) != (_physical + _idx)){return NULL;}
+	}
+
+	return DISKIO_SECTOR_MMAP(_physical);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Find the cached copy of a sector
+  * @param  sector: Sector address (LBA)
+  * @retval Cache slot, NULL when the sector is not cached
+  ***************************************************************************************************************************************
+  */
+static diskio_cache_ts* DISKIO_Cache_Find(uint32_t _sector)
+{
+	for(uint8_t _idx = 0U; _idx < DISKIO_CACHE_NBR; _idx++)
+	{
+		if(DiskioCache[_idx].validFlag && (DiskioCache[_idx].sector == _sector)){return &DiskioCache[_idx];}
+	}
+
+	return NULL;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Find the cache slot written first among the dirty or among the clean ones
+  * @param  dirtyFlag: Slot state to look for
+  * @retval Cache slot, NULL when no valid slot is in the state
+  ***************************************************************************************************************************************
+  */
+static diskio_cache_ts* DISKIO_Cache_Oldest(uint8_t _dirtyFlag)
+{
+	diskio_cache_ts* _oldest = NULL;
+
+	for(uint8_t _idx = 0U; _idx < DISKIO_CACHE_NBR; _idx++)
+	{
+		diskio_cache_ts* _slot = &DiskioCache[_idx];
+
+		if((!_slot->validFlag) || (_slot->dirtyFlag != _dirtyFlag)){continue;}
+		if((NULL == _oldest) || ((DiskioCacheClock - _slot->stamp) > (DiskioCacheClock - _oldest->stamp))){_oldest = _slot;}
+	}
+
+	return _oldest;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Program a dirty cache slot, the slot keeps its data as a clean copy
+  * @param  *slot: Cache slot
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+static DRESULT DISKIO_Cache_Program(diskio_cache_ts* _slot)
+{
+	if(RES_OK != DISKIO_Write_Sectors(_slot->data, _slot->sector, 1U)){return RES_ERROR;}
+
+	_slot->dirtyFlag = 0U;
+	DiskioCacheStats.flushNbr++;
+
+	return RES_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Write a sector into the cache. The memory always holds the writes in the order FatFs issued them: a dirty copy is only
+  *         replaced when it was the last sector written, otherwise the dirty sectors are programmed first. A slot is reused free,
+  *         then clean, then dirty, the oldest one first, so an evicted dirty slot is always the oldest write.
+  * @param  *buff: Sector data
+  * @param  sector: Sector address (LBA)
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+static DRESULT DISKIO_Cache_Write(const uint8_t* _buff, uint32_t _sector)
+{
+	diskio_cache_ts* _slot = DISKIO_Cache_Find(_sector);
+	uint8_t _idx;
+
+	if((NULL != _slot) && (_slot->dirtyFlag))
+	{
+		if(_slot->stamp == DiskioCacheClock){DiskioCacheStats.mergeNbr++;}
+		else if(RES_OK != DISKIO_Cache_Flush()){return RES_ERROR;}
+	}
+
+	if(NULL == _slot)
+	{
+		for(_idx = 0U; (_idx < DISKIO_CACHE_NBR) && (DiskioCache[_idx].validFlag); _idx++){}
+
+		if(_idx < DISKIO_CACHE_NBR){_slot = &DiskioCache[_idx];}
+		else if(NULL == (_slot = DISKIO_Cache_Oldest(0U)))
+		{
+			_slot = DISKIO_Cache_Oldest(1U);
+			if(RES_OK != DISKIO_Cache_Program(_slot)){return RES_ERROR;}
+		}
+	}
+
+	memcpy(_slot->data, _buff, DISKIO_BLK_SIZ);
+	_slot->sector = _sector;
+	_slot->validFlag = 1U;
+	_slot->dirtyFlag = 1U;
+	_slot->stamp = ++DiskioCacheClock;
+	DiskioCacheTick = HAL_GetTick();
+	DiskioCacheStats.writeNbr++;
+
+	return RES_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Keep a sector read as a clean copy in a free or clean slot, the dirty slots are never evicted for a read. The copy takes
+  *         the stamp of the last write so the next write of that sector can still replace it in RAM.
+  * @param  *buff: Sector data
+  * @param  sector: Sector address (LBA)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void DISKIO_Cache_Fill(const uint8_t* _buff, uint32_t _sector)
+{
+	diskio_cache_ts* _slot;
+	uint8_t _idx;
+
+	for(_idx = 0U; (_idx < DISKIO_CACHE_NBR) && (DiskioCache[_idx].validFlag); _idx++){}
+
+	if(_idx < DISKIO_CACHE_NBR){_slot = &DiskioCache[_idx];}
+	else if(NULL == (_slot = DISKIO_Cache_Oldest(0U))){return;}
+
+	memcpy(_slot->data, _buff, DISKIO_BLK_SIZ);
+	_slot->sector = _sector;
+	_slot->validFlag = 1U;
+	_slot->dirtyFlag = 0U;
+	_slot->stamp = DiskioCacheClock;
+	DiskioCacheStats.readFills++;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Program the dirty cached sectors in the order they were written
+  * @param  None
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+DRESULT DISKIO_Cache_Flush(void)
+{
+	diskio_cache_ts* _slot;
+
+	while(NULL != (_slot = DISKIO_Cache_Oldest(1U)))
+	{
+		if(RES_OK != DISKIO_Cache_Program(_slot)){return RES_ERROR;}
+	}
+
+	return RES_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Drop the cached sectors, called once they are flushed and the memory is written around the cache (USB mass storage)
+  * @param  None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void DISKIO_Cache_Invalidate(void)
+{
+	for(uint8_t _idx = 0U; _idx < DISKIO_CACHE_NBR; _idx++){DiskioCache[_idx].validFlag = 0U;}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Program the dirty cached sectors once no write came for DISKIO_CACHE_FLUSH_TMO
+  * @param  None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void DISKIO_Cache_Task(void)
+{
+	if((NULL != DISKIO_Cache_Oldest(1U)) && ((HAL_GetTick() - DiskioCacheTick) >= DISKIO_CACHE_FLUSH_TMO))
+	{
+		if(RES_OK != DISKIO_Cache_Flush()){BSP_Error_Handler();}
+	}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Get the sector write statistics
+  * @param  None
+  * @retval Statistics (const diskio_write_stats_ts*)
+  ***************************************************************************************************************************************
+  */
+const diskio_write_stats_ts* DISKIO_Get_Write_Stats(void)
+{
+	return &DiskioWriteStats;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Get the sector cache statistics
+  * @param  None
+  * @retval Statistics (const diskio_cache_stats_ts*)
+  ***************************************************************************************************************************************
+  */
+const diskio_cache_stats_ts* DISKIO_Get_Cache_Stats(void)
+{
+	return &DiskioCacheStats;
+}
 
 /**
   ***************************************************************************************************************************************
@@ -155,7 +550,7 @@ DRESULT USER_ioctl(BYTE _pdrv, BYTE _cmd, void *_buff)
 	switch(_cmd)
 	{
 		/* Make sure that no pending write process */
-	  	case CTRL_SYNC : _res = RES_OK; break;
+	  	case CTRL_SYNC : _res = DISKIO_Cache_Flush(); break;
 
 	  	/* Get number of sectors on the disk (DWORD) */
 	  	case GET_SECTOR_COUNT :
@@ -169,12 +564,17 @@ DRESULT USER_ioctl(BYTE _pdrv, BYTE _cmd, void *_buff)
 	  		_res = RES_OK;
 	    break;
 
-	    /* Get erase block size in unit of sector (DWORD) */
+	    /* Get erase block size in unit of sector (DWORD), the 64 KB sector rather than the 4 KB subsector a sector write erases */
 	  	case GET_BLOCK_SIZE :
-	  		*(DWORD*)_buff = DISKIO_BLK_SIZ;
+	  		*(DWORD*)_buff = DISKIO_ERASE_BLK_NBR;
 	  		_res = RES_OK;
 	    break;
 
+	  	/* Sectors no longer used by the volume (DWORD start, DWORD end) */
+	  	case CTRL_TRIM :
+	  		_res = DISKIO_Trim_Sectors(((DWORD*)_buff)[0], ((((DWORD*)_buff)[1] - ((DWORD*)_buff)[0]) + 1U));
+	    break;
+
 	  	default: _res = RES_PARERR; break;
 	  }
 
@@ -0,0 +1,768 @@
+/**
+  ***************************************************************************************************************************************
+  * @file     ff_ftl.c
+  * @owner    SimonBat
+  * @version  v0.0.1
+  * @date     2021.09.06
+  * @update   2021.09.06
+  * @brief    sentinel v1.0
+  ***************************************************************************************************************************************
+  * @attention
+  *
+  * Flash translation layer under the FAT volume. A logical sector is written out of place into an erased subsector of the
+  * data pool and the remap is logged, the subsector it leaves is erased later by the idle task. The logical sector and the
+  * subsector are both 4 KB, so no valid data is ever copied to reclaim space. The sectors the volume discards are unmapped and
+  * their subsectors erased ahead of time too, a whole free 64 KB sector at once.
+  *
+  ***************************************************************************************************************************************
+  */
+
+#include <string.h>
+#include "ff_ftl.h"
+
+static ftl_ts FTL;
+
+static uint8_t FF_FTL_Map_Test(const uint32_t* _map, uint16_t _physical);
+static void FF_FTL_Map_Set(uint32_t* _map, uint16_t _physical, uint8_t _value);
+static uint32_t FF_FTL_Checksum(void);
+static uint8_t FF_FTL_Load_Checkpoint(uint8_t _area, uint16_t* _generation, uint8_t* _validFlag);
+static DRESULT FF_FTL_Checkpoint(void);
+static uint8_t FF_FTL_Replay_Log(uint8_t* _usableFlag);
+static uint8_t FF_FTL_Volume_End(uint32_t* _end);
+static DRESULT FF_FTL_Log_Append(uint16_t _logical, uint16_t _physical);
+static uint8_t FF_FTL_Blank_Check(uint16_t _physical, uint8_t* _blankFlag);
+static uint16_t FF_FTL_Next_Free(uint16_t _start, uint8_t _erasedFlag);
+static DRESULT FF_FTL_Prepare(uint16_t _physical);
+static void FF_FTL_Set_Erased(uint16_t _physical);
+static void FF_FTL_Discard_Erase(void);
+static void FF_FTL_Erase_Submit(uint16_t _physical, uint8_t _count);
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Mount the translation layer: the newest valid checkpoint is loaded and the log replayed on top of it. A memory without
+  *         a checkpoint holds the volume as it was written before the translation layer, each logical sector at its own
+  *         subsector. A volume that ends within the logical sectors is mapped one to one by the first checkpoint. A larger one
+  *         (the whole memory of an older firmware) would lose its tail, it is left unmapped and nothing is written: the volume
+  *         reads blank, and only the first write, a format the user confirmed, closes the empty table into a checkpoint.
+  *         A failed read fails the mount and nothing is written, the checkpoints are only rewritten from a table read back in full.
+  * @param  None
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+DRESULT FF_FTL_Mount(void)
+{
+	uint32_t _volumeEnd;
+	uint16_t _generation[2];
+	uint8_t _validFlag[2], _area, _usableFlag, _hostFlag = FTL.hostFlag;
+
+	if(FTL.mountFlag){return RES_OK;}
+
+	memset(&FTL, 0, sizeof(FTL));
+	FTL.hostFlag = _hostFlag;
+	if((!FF_FTL_Load_Checkpoint(0U, &_generation[0], &_validFlag[0])) || (!FF_FTL_Load_Checkpoint(1U, &_generation[1], &_validFlag[1])))
+	{return RES_ERROR;}
+
+	/* The newer one first, the other one is the fallback when its table does not check */
+	_area = ((_validFlag[1]) && ((!_validFlag[0]) || ((int16_t)(_generation[1] - _generation[0]) > 0))) ? 1U : 0U;
+	if(_validFlag[_area])
+	{
+		if(!FF_FTL_Load_Checkpoint((_area | 0x80U), &_generation[_area], &_validFlag[_area])){return RES_ERROR;}
+	}
+
+	if(!_validFlag[_area])
+	{
+		_area ^= 1U;
+		if((_validFlag[_area]) && (!FF_FTL_Load_Checkpoint((_area | 0x80U), &_generation[_area], &_validFlag[_area]))){return RES_ERROR;}
+	}
+
+	if(_validFlag[_area])
+	{
+		FTL.area = _area;
+		FTL.generation = _generation[_area];
+		if(!FF_FTL_Replay_Log(&_usableFlag)){return RES_ERROR;}
+
+		/* A record cut by a power loss leaves the log unusable past it, the table is closed into a new checkpoint */
+		if((!_usableFlag) && (RES_OK != FF_FTL_Checkpoint())){return RES_ERROR;}
+	}
+	else
+	{
+		if(!FF_FTL_Volume_End(&_volumeEnd)){return RES_ERROR;}
+
+		FTL.area = 1U;
+		FTL.generation = 0U;
+
+		if(_volumeEnd > DISKIO_BLK_NBR)
+		{
+			memset(FTL.table, 0xFF, sizeof(FTL.table));
+			FTL.stats.oversizeFlag = 1U;
+		}
+		else
+		{
+			for(uint32_t _sector = 0U; _sector < DISKIO_BLK_NBR; _sector++){FTL.table[_sector] = (uint16_t)_sector;}
+			if(RES_OK != FF_FTL_Checkpoint()){return RES_ERROR;}
+		}
+	}
+
+	for(uint32_t _sector = 0U; _sector < DISKIO_BLK_NBR; _sector++)
+	{
+		if(FTL.table[_sector] < FF_FTL_PHY_NBR){FF_FTL_Map_Set(FTL.usedMap, FTL.table[_sector], 1U);}
+		else{FTL.table[_sector] = FF_FTL_UNMAPPED;}
+	}
+
+	FTL.stats.generation = FTL.generation;
+	FTL.mountFlag = 1U;
+
+	return RES_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Get the data pool subsector of a logical sector
+  * @param  sector: Logical sector
+  * @retval Subsector, FF_FTL_UNMAPPED when the sector was never written
+  ***************************************************************************************************************************************
+  */
+uint16_t FF_FTL_Get_Physical(uint32_t _sector)
+{
+	if(_sector >= DISKIO_BLK_NBR){return FF_FTL_UNMAPPED;}
+
+	return FTL.table[_sector];
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Read logical sectors, the sectors that follow each other in the data pool are read in one go
+  * @param  *buff: Data buffer
+  * @param  sector: First logical sector
+  * @param  count: Number of sectors
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+DRESULT FF_FTL_Read(uint8_t* _buff, uint32_t _sector, uint32_t _count)
+{
+	uint32_t _run;
+	uint16_t _physical;
+
+	if(!FTL.mountFlag){return RES_NOTRDY;}
+	if((_sector + _count) > DISKIO_BLK_NBR){return RES_PARERR;}
+
+	while(_count)
+	{
+		_physical = FTL.table[_sector];
+
+		for(_run = 1U; (_run < _count) && (FTL.table[_sector + _run] == ((FF_FTL_UNMAPPED == _physical) ? FF_FTL_UNMAPPED : (_physical + _run))); _run++){}
+
+		if(FF_FTL_UNMAPPED == _physical){memset(_buff, 0xFF, (_run * DISKIO_BLK_SIZ));}
+		else if(QSPI_OK != BSP_QSPI_Read(_buff, DISKIO_SECTOR_ADDR(_physical), (_run * DISKIO_BLK_SIZ))){return RES_ERROR;}
+
+		_buff += (_run * DISKIO_BLK_SIZ);
+		_sector += _run;
+		_count -= _run;
+	}
+
+	return RES_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Get an erased data pool subsector for a new copy of a logical sector. The subsector that follows the copy of the
+  *         previous sector is taken when it is erased, a sequentially written file stays contiguous. Otherwise the erased
+  *         subsectors are taken round-robin, so the hot sectors rotate across the whole pool.
+  * @param  sector: Logical sector
+  * @retval Subsector, FF_FTL_UNMAPPED on error
+  ***************************************************************************************************************************************
+  */
+uint16_t FF_FTL_Allocate(uint32_t _sector)
+{
+	uint16_t _physical = FF_FTL_UNMAPPED;
+
+	if((_sector >= DISKIO_BLK_NBR) || (!FTL.mountFlag)){return FF_FTL_UNMAPPED;}
+
+	/* The oversized volume is given up by the first write, a power loss after it leaves the memory blank */
+	if((FTL.stats.oversizeFlag) && (RES_OK != FF_FTL_Checkpoint())){return FF_FTL_UNMAPPED;}
+
+	FTL.writeTick = HAL_GetTick();
+
+	if((_sector) && (FTL.table[_sector - 1U] < (FF_FTL_PHY_NBR - 1U)) && \
+	   (!FF_FTL_Map_Test(FTL.usedMap, (FTL.table[_sector - 1U] + 1U))) && (FF_FTL_Map_Test(FTL.erasedMap, (FTL.table[_sector - 1U] + 1U))))
+	{_physical = (FTL.table[_sector - 1U] + 1U);}
+	else if(FTL.stats.erasedNbr){_physical = FF_FTL_Next_Free(FTL.allocIdx, 1U);}
+
+	/* Nothing erased ahead, the write waits for a blank check or an erase */
+	if(FF_FTL_UNMAPPED == _physical)
+	{
+		_physical = FF_FTL_Next_Free(FTL.allocIdx, 0U);
+		if((FF_FTL_UNMAPPED == _physical) || (RES_OK != FF_FTL_Prepare(_physical))){return FF_FTL_UNMAPPED;}
+	}
+
+	/* A subsector of the idle erase taken before the erase is accounted. Only the program and erase calls wait for the queue
+	   (QSPI_WaitIdle), a read suspends the erase instead: the blank check of Prepare may see the erase half done, but the erase
+	   of Prepare or the program of the caller ends it first. A read of an erasing subsector is never issued otherwise, it is
+	   free or discarded and so not mapped. The subsectors of the erase may be written again by the time the task accounts it. */
+	if((_physical >= FTL.eraseBase) && (_physical < (FTL.eraseBase + FTL.eraseNbr))){FTL.eraseNbr = 0U;}
+
+	FF_FTL_Map_Set(FTL.erasedMap, _physical, 0U);
+	FTL.stats.erasedNbr--;
+	FTL.allocIdx = ((_physical + 1U) < FF_FTL_PHY_NBR) ? (_physical + 1U) : 0U;
+
+	return _physical;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Move a logical sector to the subsector its new copy was programmed to. The remap is logged before the old subsector
+  *         is released, a power loss leaves either the old or the new copy mapped.
+  * @param  sector: Logical sector
+  * @param  physical: Subsector from FF_FTL_Allocate
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+DRESULT FF_FTL_Commit(uint32_t _sector, uint16_t _physical)
+{
+	uint16_t _old;
+
+	if((_sector >= DISKIO_BLK_NBR) || (_physical >= FF_FTL_PHY_NBR)){return RES_PARERR;}
+
+	_old = FTL.table[_sector];
+	FTL.table[_sector] = _physical;
+	FF_FTL_Map_Set(FTL.usedMap, _physical, 1U);
+
+	if(RES_OK != FF_FTL_Log_Append((uint16_t)_sector, _physical))
+	{
+		FTL.table[_sector] = _old;
+		FF_FTL_Map_Set(FTL.usedMap, _physical, 0U);
+		return RES_ERROR;
+	}
+
+	if(FF_FTL_UNMAPPED != _old){FF_FTL_Map_Set(FTL.usedMap, _old, 0U);}
+
+	return RES_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Unmap logical sectors the volume no longer uses (FatFs trim, SCSI unmap), they read erased again. Each unmap is logged
+  *         before its subsector is handed to the idle task to erase, a discard that does not fit in the log left is closed into
+  *         a checkpoint instead.
+  * @param  sector: First logical sector
+  * @param  count: Number of sectors
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+DRESULT FF_FTL_Trim(uint32_t _sector, uint32_t _count)
+{
+	uint32_t _end = (_sector + _count), _mappedNbr = 0U;
+	uint16_t _physical;
+	uint8_t _logFlag;
+
+	if((_end > DISKIO_BLK_NBR) || (_end < _sector) || (!FTL.mountFlag)){return RES_PARERR;}
+
+	for(uint32_t _idx = _sector; _idx < _end; _idx++){if(FF_FTL_UNMAPPED != FTL.table[_idx]){_mappedNbr++;}}
+	if(!_mappedNbr){return RES_OK;}
+
+	FTL.writeTick = HAL_GetTick();
+	_logFlag = (_mappedNbr <= (FF_FTL_LOG_SIZE - FTL.logPosition));
+
+	for(; _sector < _end; _sector++)
+	{
+		_physical = FTL.table[_sector];
+		if(FF_FTL_UNMAPPED == _physical){continue;}
+
+		FTL.table[_sector] = FF_FTL_UNMAPPED;
+		if((_logFlag) && (RES_OK != FF_FTL_Log_Append((uint16_t)_sector, FF_FTL_UNMAPPED)))
+		{
+			FTL.table[_sector] = _physical;
+			return RES_ERROR;
+		}
+
+		FF_FTL_Map_Set(FTL.usedMap, _physical, 0U);
+		FF_FTL_Map_Set(FTL.discardMap, _physical, 1U);
+		FTL.stats.discardNbr++;
+		FTL.stats.trimNbr++;
+	}
+
+	if(!_logFlag){return FF_FTL_Checkpoint();}
+
+	return RES_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Background work once the disk is idle: a checkpoint when the log fills up, then the free subsectors ahead of the
+  *         allocation are blank checked, then the discarded subsectors are erased. The erase runs in the background through the
+  *         asynchronous QSPI requests, the subsectors count as erased on a later call once it has ended.
+  * @param  None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void FF_FTL_Task(void)
+{
+	uint16_t _physical;
+	uint8_t _blankFlag;
+
+	/* The subsectors of an oversized volume are not erased before it is given up */
+	if((!FTL.mountFlag) || (FTL.stats.oversizeFlag) || (QSPI_BUSY == FTL.erase.Status)){return;}
+
+	if(FTL.eraseNbr)
+	{
+		if(QSPI_OK != FTL.erase.Status){BSP_Error_Handler();}
+		for(uint8_t _idx = 0U; _idx < FTL.eraseNbr; _idx++){FF_FTL_Set_Erased(FTL.eraseBase + _idx);}
+		FTL.eraseNbr = 0U;
+	}
+
+	/* The memory belongs to the USB host while it is attached */
+	if(FTL.hostFlag){return;}
+
+	if((HAL_GetTick() - FTL.writeTick) < FF_FTL_GC_IDLE_TMO){return;}
+
+	if(FTL.logPosition >= FF_FTL_CKPT_LEVEL)
+	{
+		if(RES_OK != FF_FTL_Checkpoint()){BSP_Error_Handler();}
+		return;
+	}
+
+	_physical = FTL.allocIdx;
+
+	for(uint8_t _idx = 0U; (_idx < FF_FTL_GC_SCAN) && (FTL.stats.erasedNbr < FF_FTL_ERASED_AHEAD); _idx++)
+	{
+		_physical = FF_FTL_Next_Free(_physical, 0U);
+		if(FF_FTL_UNMAPPED == _physical){return;}
+
+		if(!FF_FTL_Blank_Check(_physical, &_blankFlag)){BSP_Error_Handler();}
+		if(!_blankFlag)
+		{
+			FF_FTL_Erase_Submit(_physical, 1U);
+			FTL.stats.gcEraseNbr++;
+			return;
+		}
+
+		FTL.stats.blankNbr++;
+		FF_FTL_Set_Erased(_physical);
+	}
+
+	if(FTL.stats.discardNbr){FF_FTL_Discard_Erase();}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Attach or detach the USB host. No idle work is started while it is attached, the attach waits for the running erase:
+  *         the mass storage callbacks run in the USB interrupt and never find the memory busy.
+  * @param  hostFlag: 1 before the USB device starts, 0 once it is stopped
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void FF_FTL_Set_Host_Flag(uint8_t _hostFlag)
+{
+	FTL.hostFlag = _hostFlag;
+	if(_hostFlag){(void)BSP_QSPI_Wait(&FTL.erase);}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Get the translation layer statistics
+  * @param  None
+  * @retval Statistics (const ftl_stats_ts*)
+  ***************************************************************************************************************************************
+  */
+const ftl_stats_ts* FF_FTL_Get_Stats(void)
+{
+	return &FTL.stats;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Test a subsector in a data pool bitmap
+  * @param  *map: Bitmap
+  * @param  physical: Subsector
+  * @retval Bit (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_FTL_Map_Test(const uint32_t* _map, uint16_t _physical)
+{
+	return ((_map[_physical >> 5U] >> (_physical & 31U)) & 1U);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Set or clear a subsector in a data pool bitmap
+  * @param  *map: Bitmap
+  * @param  physical: Subsector
+  * @param  value: Bit
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_FTL_Map_Set(uint32_t* _map, uint16_t _physical, uint8_t _value)
+{
+	if(_value){_map[_physical >> 5U] |= (1UL << (_physical & 31U));}
+	else{_map[_physical >> 5U] &= ~(1UL << (_physical & 31U));}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  FNV-1a of the mapping table
+  * @param  None
+  * @retval Checksum (uint32_t)
+  ***************************************************************************************************************************************
+  */
+static uint32_t FF_FTL_Checksum(void)
+{
+	const uint8_t* _byte = (const uint8_t*)FTL.table;
+	uint32_t _hash = 2166136261UL;
+
+	for(uint32_t _idx = 0U; _idx < sizeof(FTL.table); _idx++){_hash = ((_hash ^ _byte[_idx]) * 16777619UL);}
+
+	return _hash;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Check the header of a checkpoint, with bit 7 of the area set the table is loaded and its checksum verified as well
+  * @param  area: Checkpoint area (uint8_t)
+  * @param  *generation: Generation of the checkpoint
+  * @param  *validFlag: Checkpoint valid
+  * @retval Read done (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_FTL_Load_Checkpoint(uint8_t _area, uint16_t* _generation, uint8_t* _validFlag)
+{
+	ftl_header_ts _header;
+	uint32_t _base = FF_FTL_CKPT_BASE(_area & 0x01U);
+
+	*_validFlag = 0U;
+
+	if(QSPI_OK != BSP_QSPI_Read((uint8_t*)&_header, DISKIO_SECTOR_ADDR(_base + FF_FTL_TABLE_BLK_NBR), sizeof(_header))){return 0U;}
+
+	if((FF_FTL_CKPT_MAGIC != _header.magic) || (DISKIO_BLK_NBR != _header.logicalNbr) || \
+	   ((_header.magic ^ _header.generation ^ _header.checksum) != _header.check))
+	{return 1U;}
+
+	*_generation = _header.generation;
+
+	if(_area & 0x80U)
+	{
+		if(QSPI_OK != BSP_QSPI_Read((uint8_t*)FTL.table, DISKIO_SECTOR_ADDR(_base), sizeof(FTL.table))){return 0U;}
+		if(FF_FTL_Checksum() != _header.checksum){return 1U;}
+	}
+
+	*_validFlag = 1U;
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Close the mapping table into the other checkpoint area and restart the log. The header is programmed last, a power
+  *         loss before it leaves the previous checkpoint and its log in charge.
+  * @param  None
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+static DRESULT FF_FTL_Checkpoint(void)
+{
+	ftl_header_ts _header;
+	uint8_t _area = (FTL.area ^ 1U);
+	uint32_t _base = FF_FTL_CKPT_BASE(_area);
+
+	for(uint32_t _idx = 0U; _idx < FF_FTL_CKPT_BLK_NBR; _idx++)
+	{
+		if(QSPI_OK != BSP_QSPI_Erase_Block(DISKIO_SECTOR_ADDR(_base + _idx))){return RES_ERROR;}
+	}
+
+	if(QSPI_OK != BSP_QSPI_Write((uint8_t*)FTL.table, DISKIO_SECTOR_ADDR(_base), sizeof(FTL.table))){return RES_ERROR;}
+
+	_header.magic = FF_FTL_CKPT_MAGIC;
+	_header.generation = (uint16_t)(FTL.generation + 1U);
+	_header.logicalNbr = DISKIO_BLK_NBR;
+	_header.checksum = FF_FTL_Checksum();
+	_header.check = (_header.magic ^ _header.generation ^ _header.checksum);
+
+	if(QSPI_OK != BSP_QSPI_Write((uint8_t*)&_header, DISKIO_SECTOR_ADDR(_base + FF_FTL_TABLE_BLK_NBR), sizeof(_header))){return RES_ERROR;}
+
+	FTL.area = _area;
+	FTL.generation = _header.generation;
+	FTL.stats.generation = FTL.generation;
+	FTL.logPosition = 0U;
+	FTL.stats.checkpointNbr++;
+	FTL.stats.oversizeFlag = 0U;
+
+	return RES_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Apply the log records of the current checkpoint, they run from the start of the log up to the first other slot
+  * @param  *usableFlag: Log usable, 0 when a cut record is left in the middle of a log subsector
+  * @retval Read done (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_FTL_Replay_Log(uint8_t* _usableFlag)
+{
+	const ftl_record_ts* _record;
+	uint32_t _position, _slot;
+	uint16_t _last = FF_FTL_UNMAPPED;
+	uint8_t _erasedFlag = 1U;
+
+	for(_position = 0U; _position < FF_FTL_LOG_SIZE; _position++)
+	{
+		_slot = (_position % (sizeof(FTL.page) / sizeof(ftl_record_ts)));
+
+		if(0U == _slot)
+		{
+			if(QSPI_OK != BSP_QSPI_Read(FTL.page, (DISKIO_SECTOR_ADDR(FF_FTL_LOG_BASE) + (_position * sizeof(ftl_record_ts))), sizeof(FTL.page)))
+			{return 0U;}
+		}
+
+		_record = &((const ftl_record_ts*)FTL.page)[_slot];
+
+		if((_record->generation != FTL.generation) || (_record->logical >= DISKIO_BLK_NBR) || \
+		   ((_record->physical >= FF_FTL_PHY_NBR) && (FF_FTL_UNMAPPED != _record->physical)) || \
+		   ((_record->logical ^ _record->physical ^ _record->generation ^ FF_FTL_RECORD_CHECK) != _record->check))
+		{
+			_erasedFlag = ((0xFFFFU == _record->logical) && (0xFFFFU == _record->physical) && (0xFFFFU == _record->generation) && (0xFFFFU == _record->check));
+			break;
+		}
+
+		FTL.table[_record->logical] = _record->physical;
+		if(FF_FTL_UNMAPPED != _record->physical){_last = _record->physical;}
+	}
+
+	FTL.logPosition = _position;
+	if((FF_FTL_UNMAPPED != _last) && ((_last + 1U) < FF_FTL_PHY_NBR)){FTL.allocIdx = (_last + 1U);}
+
+	/* At a subsector start the slot is erased with its subsector before the next record */
+	*_usableFlag = ((_erasedFlag) || (0U == (_position % FF_FTL_LOG_NBR)) || (_position >= FF_FTL_LOG_SIZE));
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Find the end of the volume written before the translation layer from its boot sector (no partition table) or from the
+  *         first entry of its partition table, both at subsector 0. The sectors are 4 KB, as the USB mass storage reported them.
+  * @param  *end: Sector after the volume, 0 when the memory holds no volume
+  * @retval Read done (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_FTL_Volume_End(uint32_t* _end)
+{
+	const uint8_t* _entry = &FTL.page[FF_FTL_BOOT_PART_OFFSET - sizeof(FTL.page)];
+	uint32_t _total;
+	uint16_t _bytesPerSector;
+	uint8_t _partitionFlag;
+
+	*_end = 0U;
+
+	/* Partition table and signature */
+	if(QSPI_OK != BSP_QSPI_Read(FTL.page, sizeof(FTL.page), sizeof(FTL.page))){return 0U;}
+	if(FF_FTL_BOOT_SIGNATURE != (FTL.page[510U - sizeof(FTL.page)] | ((uint16_t)FTL.page[511U - sizeof(FTL.page)] << 8U))){return 1U;}
+	_total = (_entry[8] | ((uint32_t)_entry[9] << 8U) | ((uint32_t)_entry[10] << 16U) | ((uint32_t)_entry[11] << 24U)) + \
+			 (_entry[12] | ((uint32_t)_entry[13] << 8U) | ((uint32_t)_entry[14] << 16U) | ((uint32_t)_entry[15] << 24U));
+	_partitionFlag = (0U != _entry[4]); /* Partition type */
+
+	/* Boot sector: jump instruction, then BPB_BytsPerSec, BPB_TotSec16 and BPB_TotSec32 */
+	if(QSPI_OK != BSP_QSPI_Read(FTL.page, 0U, sizeof(FTL.page))){return 0U;}
+	_bytesPerSector = (FTL.page[11] | ((uint16_t)FTL.page[12] << 8U));
+
+	if(((0xEBU == FTL.page[0]) || (0xE9U == FTL.page[0]) || (0xE8U == FTL.page[0])) && (_bytesPerSector >= 512U) && \
+	   (_bytesPerSector <= DISKIO_BLK_SIZ) && (0U == (_bytesPerSector & (_bytesPerSector - 1U))))
+	{
+		_total = (FTL.page[19] | ((uint32_t)FTL.page[20] << 8U));
+		if(0U == _total){_total = (FTL.page[32] | ((uint32_t)FTL.page[33] << 8U) | ((uint32_t)FTL.page[34] << 16U) | ((uint32_t)FTL.page[35] << 24U));}
+		*_end = (_total / (DISKIO_BLK_SIZ / _bytesPerSector)) + ((_total % (DISKIO_BLK_SIZ / _bytesPerSector)) ? 1U : 0U);
+	}
+	else if(_partitionFlag){*_end = _total;}
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Log a remap, a log subsector is erased when the log enters it and a full log is closed into a checkpoint instead
+  * @param  logical: Logical sector
+  * @param  physical: Subsector
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+static DRESULT FF_FTL_Log_Append(uint16_t _logical, uint16_t _physical)
+{
+	ftl_record_ts _record;
+
+	/* The table already holds the remap */
+	if(FTL.logPosition >= FF_FTL_LOG_SIZE){return FF_FTL_Checkpoint();}
+
+	if(0U == (FTL.logPosition % FF_FTL_LOG_NBR))
+	{
+		if(QSPI_OK != BSP_QSPI_Erase_Block(DISKIO_SECTOR_ADDR(FF_FTL_LOG_BASE + (FTL.logPosition / FF_FTL_LOG_NBR)))){return RES_ERROR;}
+	}
+
+	_record.logical = _logical;
+	_record.physical = _physical;
+	_record.generation = FTL.generation;
+	_record.check = (_logical ^ _physical ^ FTL.generation ^ FF_FTL_RECORD_CHECK);
+
+	if(QSPI_OK != BSP_QSPI_Write((uint8_t*)&_record, (DISKIO_SECTOR_ADDR(FF_FTL_LOG_BASE) + (FTL.logPosition * sizeof(ftl_record_ts))), sizeof(_record)))
+	{return RES_ERROR;}
+
+	FTL.logPosition++;
+	FTL.stats.recordNbr++;
+
+	return RES_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Blank check a data pool subsector page by page
+  * @param  physical: Subsector
+  * @param  *blankFlag: Subsector erased
+  * @retval Read done (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_FTL_Blank_Check(uint16_t _physical, uint8_t* _blankFlag)
+{
+	const uint32_t* _word = (const uint32_t*)FTL.page;
+
+	*_blankFlag = 1U;
+
+	for(uint32_t _offset = 0U; (_offset < DISKIO_BLK_SIZ) && (*_blankFlag); _offset += sizeof(FTL.page))
+	{
+		if(QSPI_OK != BSP_QSPI_Read(FTL.page, (DISKIO_SECTOR_ADDR(_physical) + _offset), sizeof(FTL.page))){return 0U;}
+
+		for(uint32_t _idx = 0U; _idx < (sizeof(FTL.page) / sizeof(uint32_t)); _idx++)
+		{
+			if(0xFFFFFFFFUL != _word[_idx]){*_blankFlag = 0U; break;}
+		}
+	}
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Find the next free data pool subsector, wrapping around the pool
+  * @param  start: First subsector to look at
+  * @param  erasedFlag: 1 for a subsector known to be erased, 0 for one that is not known to be
+  * @retval Subsector, FF_FTL_UNMAPPED when there is none
+  ***************************************************************************************************************************************
+  */
+static uint16_t FF_FTL_Next_Free(uint16_t _start, uint8_t _erasedFlag)
+{
+	uint16_t _physical = _start;
+
+	for(uint32_t _idx = 0U; _idx < FF_FTL_PHY_NBR; _idx++)
+	{
+		if(_physical >= FF_FTL_PHY_NBR){_physical = 0U;}
+
+		if((!FF_FTL_Map_Test(FTL.usedMap, _physical)) && (FF_FTL_Map_Test(FTL.erasedMap, _physical) == _erasedFlag)){return _physical;}
+
+		_physical++;
+	}
+
+	return FF_FTL_UNMAPPED;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Make a free subsector known to be erased, by a blank check or else by an erase on the write path
+  * @param  physical: Subsector
+  * @retval DRESULT: Operation result
+  ***************************************************************************************************************************************
+  */
+static DRESULT FF_FTL_Prepare(uint16_t _physical)
+{
+	uint8_t _blankFlag;
+
+	if(!FF_FTL_Blank_Check(_physical, &_blankFlag)){return RES_ERROR;}
+
+	if(!_blankFlag)
+	{
+		if(QSPI_OK != BSP_QSPI_Erase_Block(DISKIO_SECTOR_ADDR(_physical))){return RES_ERROR;}
+		FTL.stats.syncEraseNbr++;
+	}
+	else{FTL.stats.blankNbr++;}
+
+	FF_FTL_Set_Erased(_physical);
+
+	return RES_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Mark a free subsector erased, it is no longer waiting as a discard. A subsector already marked is left as it is.
+  * @param  physical: Subsector
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_FTL_Set_Erased(uint16_t _physical)
+{
+	if(FF_FTL_Map_Test(FTL.erasedMap, _physical)){return;}
+
+	if(FF_FTL_Map_Test(FTL.discardMap, _physical))
+	{
+		FF_FTL_Map_Set(FTL.discardMap, _physical, 0U);
+		FTL.stats.discardNbr--;
+	}
+
+	FF_FTL_Map_Set(FTL.erasedMap, _physical, 1U);
+	FTL.stats.erasedNbr++;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Start the erase of the next discarded subsector. When its whole 64 KB sector is free and enough of it is left to erase,
+  *         the sector is erased in one go, it takes far less than its subsectors one by one.
+  * @param  None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_FTL_Discard_Erase(void)
+{
+	uint16_t _physical = FTL.discardIdx, _base;
+	uint8_t _eraseNbr = 0U, _idx;
+
+	for(uint32_t _scan = 0U; _scan < FF_FTL_PHY_NBR; _scan++, _physical++)
+	{
+		if(_physical >= FF_FTL_PHY_NBR){_physical = 0U;}
+		if(FF_FTL_Map_Test(FTL.discardMap, _physical)){break;}
+	}
+
+	if(!FF_FTL_Map_Test(FTL.discardMap, _physical)){return;}
+	FTL.discardIdx = ((_physical + 1U) < FF_FTL_PHY_NBR) ? (_physical + 1U) : 0U;
+
+	_base = (uint16_t)(_physical & ~(DISKIO_ERASE_BLK_NBR - 1U));
+	if((_base + DISKIO_ERASE_BLK_NBR) <= FF_FTL_PHY_NBR)
+	{
+		for(_idx = 0U; (_idx < DISKIO_ERASE_BLK_NBR) && (!FF_FTL_Map_Test(FTL.usedMap, (_base + _idx))); _idx++)
+		{
+			if(!FF_FTL_Map_Test(FTL.erasedMap, (_base + _idx))){_eraseNbr++;}
+		}
+
+		if((DISKIO_ERASE_BLK_NBR == _idx) && (_eraseNbr >= FF_FTL_SECTOR_ERASE_MIN))
+		{
+			FF_FTL_Erase_Submit(_base, DISKIO_ERASE_BLK_NBR);
+			FTL.stats.sectorEraseNbr++;
+			return;
+		}
+	}
+
+	FF_FTL_Erase_Submit(_physical, 1U);
+	FTL.stats.gcEraseNbr++;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Start the idle erase of a subsector or of a whole 64 KB sector in the background
+  * @param  physical: First subsector
+  * @param  count: 1, or DISKIO_ERASE_BLK_NBR for the 64 KB sector
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_FTL_Erase_Submit(uint16_t _physical, uint8_t _count)
+{
+	FTL.erase.Type = (DISKIO_ERASE_BLK_NBR == _count) ? QSPI_REQUEST_ERASE_SECTOR : QSPI_REQUEST_ERASE_BLOCK;
+	FTL.erase.Address = DISKIO_SECTOR_ADDR(_physical);
+	FTL.erase.Callback = NULL;
+	FTL.eraseBase = _physical;
+	FTL.eraseNbr = _count;
+
+	if(QSPI_OK != BSP_QSPI_Submit(&FTL.erase)){BSP_Error_Handler();}
+}
@@ -16,220 +16,2879 @@
 
 #include "ff_profile.h"
 #include "string.h"
+#include "stdlib.h"
+#include "ctype.h"
 #include "bsp.h"
+#include "n25q512a_qspi.h"
+#include "ff_ftl.h"
 
 /* Global variables */
 static profile_ts PROFILE;
+extern uint32_t _estack;
+extern uint32_t _Min_Stack_Size; /* Linker symbol, its address is the size */
+static const char* const FF_PROFILE_FIELD_NAMES[FF_PROFILE_FIELD_TYPES] = {
+	"email",
+	"user",
+	"password",
+	"notes",
+	"otp"
+};
+static const char* const FF_PROFILE_SORT_SKIP[] = {
+	"https://",
+	"http://",
+	"www."
+};
+
+static void FF_PROFILE_CRC_Init(void);
+static void FF_PROFILE_Mount(void);
+static void FF_PROFILE_Scan_Sources(void);
+static void FF_PROFILE_Add_Source(const char* _dir, const FILINFO* _fileInfo);
+static void FF_PROFILE_Paint_Stack(void);
+static uint32_t FF_PROFILE_Get_Stack_Peak(void);
+static FRESULT FF_PROFILE_Read_File(FIL* _file, void* _dst, UINT _len, UINT* _bytesRead);
+static uint8_t FF_PROFILE_Read_Error_File(uint8_t* _errorNbr);
+static void FF_PROFILE_Check_Error_File(uint8_t _status);
+static uint8_t FF_PROFILE_Pin_Log_Open(profile_pin_log_ts* _log);
+static void FF_PROFILE_Pin_Log_Format(profile_pin_log_ts* _log, uint8_t _slot, uint16_t _sequence, uint8_t _failNbr);
+static void FF_PROFILE_Pin_Log_Append(profile_pin_log_ts* _log, uint8_t _entry);
+static uint8_t FF_PROFILE_Reserved_Block_Free(void);
+static void FF_PROFILE_Usage_Open(void);
+static uint8_t FF_PROFILE_Usage_Log_Read(void);
+static void FF_PROFILE_Usage_Log_Move(void);
+static uint16_t FF_PROFILE_Usage_Stage(uint16_t _len, profile_usage_record_ts* _record);
+static void FF_PROFILE_Usage_Resolve(void);
+static void FF_PROFILE_Usage_Rebase(void);
+static void FF_PROFILE_Usage_Build(void);
+static void FF_PROFILE_Usage_Sort(uint8_t* _order, uint8_t _nbr, uint8_t _rankFlag);
+static uint8_t FF_PROFILE_Usage_Before(const profile_usage_record_ts* _recordA, const profile_usage_record_ts* _recordB, uint8_t _rankFlag);
+static profile_usage_record_ts* FF_PROFILE_Usage_Find(uint16_t _entryIdx);
+static profile_usage_record_ts* FF_PROFILE_Usage_Add(uint16_t _entryIdx, uint32_t _urlHash);
+static void FF_PROFILE_Usage_Touch(profile_usage_record_ts* _record);
+static uint8_t FF_PROFILE_Usage_Is_Recent(uint8_t _recordIdx);
+static uint16_t FF_PROFILE_Recent_Entry(uint16_t _dataIdx);
+static uint16_t FF_PROFILE_Recent_Position(uint16_t _entryIdx);
+static uint16_t FF_PROFILE_Get_Entry(uint16_t _dataIdx);
+static uint32_t FF_PROFILE_Entry_Hash(uint16_t _entryIdx);
+static uint32_t FF_PROFILE_Url_Hash(const uint8_t* _url, uint8_t _size);
+static uint8_t FF_PROFILE_Check_Image(void);
+static void FF_PROFILE_Check_Step(void);
+static uint8_t FF_PROFILE_Open_Image(void);
+static uint8_t FF_PROFILE_Load_Pool(const profile_image_header_ts* _header);
+static void FF_PROFILE_Reset_Pool(void);
+static uint8_t FF_PROFILE_Intern_Value(uint8_t _code, const uint8_t* _value, uint8_t _size);
+static uint8_t FF_PROFILE_Load_Dict(const profile_image_header_ts* _header);
+static void FF_PROFILE_Compile_Start(void);
+static void FF_PROFILE_Offsets_Step(void);
+static void FF_PROFILE_Tables_Step(void);
+static void FF_PROFILE_Records_Step(void);
+static uint8_t FF_PROFILE_Source_Step(uint8_t _recordsFlag);
+static void FF_PROFILE_Emit_Record(uint8_t _recordsFlag, uint16_t _dataIdx, uint16_t _recordSize);
+static void FF_PROFILE_Finish_Image(void);
+static void FF_PROFILE_Learn_Url(profile_dict_word_ts* _dict, const uint8_t* _record);
+static void FF_PROFILE_Learn_Word(profile_dict_word_ts* _dict, const uint8_t* _word, uint8_t _size);
+static void FF_PROFILE_Write_Dict(profile_writer_ts* _writer, profile_image_header_ts* _header);
+static void FF_PROFILE_Sort_Key(const uint8_t* _record, uint16_t _dataIdx, profile_sort_key_ts* _key);
+static int FF_PROFILE_Sort_Compare(const void* _keyA, const void* _keyB);
+static uint8_t FF_PROFILE_Sort_Access(uint32_t _keyPos, profile_sort_key_ts* _keys, uint16_t _keyNbr, uint8_t _writeFlag);
+static profile_sort_key_ts* FF_PROFILE_Sort_Run_Key(profile_sort_run_ts* _run);
+static uint8_t FF_PROFILE_Sort_Merge(uint32_t _startA, uint32_t _startB, uint32_t _endB, uint32_t _dst);
+static void FF_PROFILE_Sort_Index(profile_writer_ts* _writer, uint16_t _dataNbr);
+static void FF_PROFILE_Read_Image(uint32_t _offset, void* _dst, uint32_t _len);
+static uint16_t FF_PROFILE_Sorted_Entry(uint16_t _dataIdx);
+static uint32_t FF_PROFILE_Locate_Data(uint16_t _dataIdx, uint16_t* _recordSize);
+static uint32_t FF_PROFILE_Locate_Entry(uint16_t _entryIdx, uint16_t* _recordSize);
+static void FF_PROFILE_Load_Data(uint16_t _dataIdx, profile_cache_ts* _cache);
+static profile_cache_ts* FF_PROFILE_Find_Cache(uint16_t _dataIdx);
+static profile_cache_ts* FF_PROFILE_Fetch_Cache(uint16_t _dataIdx);
+static void FF_PROFILE_Evict_Cache(void);
+#if (1U == FF_PROFILE_COMPRESS)
+static uint16_t FF_PROFILE_Pack_Record(const uint8_t* _src, uint16_t _srcSize, uint8_t* _dst);
+#endif
+static uint16_t FF_PROFILE_Unpack_Record(const uint8_t* _src, uint16_t _srcSize, uint8_t* _dst);
+static uint8_t FF_PROFILE_Decode_Record(const uint8_t* _record, uint16_t _recordSize, profile_view_ts* _view);
+static uint8_t FF_PROFILE_Fill_Buffer(profile_reader_ts* _reader);
+static void FF_PROFILE_Write_Bytes(profile_writer_ts* _writer, const uint8_t* _src, uint32_t _len);
+static uint8_t FF_PROFILE_Read_Token(profile_reader_ts* _reader, uint8_t* _token, uint16_t _tokenSize, uint16_t* _tokenLen);
+static uint8_t FF_PROFILE_Parse_Number(const uint8_t* _token, uint16_t _tokenLen, uint16_t* _value);
+static uint8_t FF_PROFILE_Parse_Token(profile_parser_ts* _parser, uint8_t* _record, const uint8_t* _token, uint16_t _tokenLen);
+static void FF_PROFILE_Next_Data(profile_parser_ts* _parser);
 
 /**
   ***************************************************************************************************************************************
-  * @brief FAT file system profile initialization
+  * @brief FAT file system profile initialization, the vault is loaded by FF_PROFILE_Load_Task
   * @param None
   * @retval None
   ***************************************************************************************************************************************
   */
 void FF_PROFILE_Init(void)
 {
-	FRESULT _res;
-	uint8_t _ffBuffer[128];
-	__IO uint8_t _idx = 0U;
-	__IO uint32_t _bytesRead;
+	FF_PROFILE_CRC_Init();
+
+	/* Cycle counter for the load step and unpack statistics */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	if(0U == FATFS_LinkDriver(&FF_Driver,PROFILE.ffPath)){PROFILE.load.state = FF_PROFILE_LOAD_MOUNT;}
+	else{BSP_Error_Handler();}
+}
 
-	if(0U == FATFS_LinkDriver(&FF_Driver,PROFILE.ffPath))
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile advance the vault load, the bounded load steps run for about FF_PROFILE_LOAD_SLICE ms per call.
+  *        The other FF_PROFILE functions may only be used once the load is done, FF_PROFILE_Check_Error_Log once the volume
+  *        is mounted.
+  * @param None
+  * @retval Load done (uint8_t)
+  ***************************************************************************************************************************************
+  */
+uint8_t FF_PROFILE_Load_Task(void)
+{
+	uint32_t _tickStart = HAL_GetTick();
+	uint32_t _cycles;
+	uint32_t _stepTime;
+
+	while(FF_PROFILE_LOAD_DONE != PROFILE.load.state)
 	{
-		if(FR_OK == f_mount(&PROFILE.ffFs, PROFILE.ffPath, 0U))
+		_cycles = DWT->CYCCNT;
+
+		switch(PROFILE.load.state)
 		{
-			if(FR_OK == f_open(&PROFILE.dataFile, FF_PROFILE_DATA_FNAME, FA_READ))
-			{
-				/* Find the first '<' symbol */
-				do{
-					_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-					if((0U == _bytesRead)||(FR_OK != _res)){BSP_Error_Handler();}
-					else{_idx++;}
-				}while('<' != _ffBuffer[_idx - 1U]);
-
-				/* Find the '>' symbol */
-				_idx = 0U;
-				do{
-					_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-					if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
-					else{_idx++;}
-				}while('>' != _ffBuffer[_idx - 1U]);
-
-				if(2U == _idx){PROFILE.dataNbr = _ffBuffer[0] - 48U;}
-				else if(3U == _idx){PROFILE.dataNbr = (_ffBuffer[0] - 48U) * 10U + (_ffBuffer[1] - 48U);}
-				else if(4U == _idx){PROFILE.dataNbr = (_ffBuffer[0] - 48U) * 100U + ((_ffBuffer[1] - 48U) * 10U) + (_ffBuffer[1] - 48U);}
-				else{BSP_Error_Handler();}
-
-				for(uint16_t _urlNbrIdx = 0U; _urlNbrIdx < PROFILE.dataNbr; _urlNbrIdx++)
-				{
-					/* Find the '<' symbol */
-					do{
-						_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-						if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
-						else{_idx++;}
-					}while(('<' != _ffBuffer[_idx - 1U]));
-
-					/* Filter the "url:" mark */
-					_res = f_read(&PROFILE.dataFile, &_ffBuffer[0], 4U, (UINT*)&_bytesRead);
-
-					if(('u' != _ffBuffer[0]) || ('r' != _ffBuffer[1]) || ('l' != _ffBuffer[2]) || \
-					   (':' != _ffBuffer[3]) || (FR_OK != _res) || (4U != _bytesRead)){BSP_Error_Handler();}
-
-					/* Find the '>' symbol */
-					_idx = 0U;
-					do{
-						_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-						if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
-						else{_idx++;}
-					}while('>' != _ffBuffer[_idx - 1U]);
-
-					PROFILE.data[_urlNbrIdx].urlSize = _idx - 1U;
-					memcpy(&PROFILE.data[_urlNbrIdx].url[0], &_ffBuffer[0], PROFILE.data[_urlNbrIdx].urlSize);
-
-					/* Find the '<' symbol */
-					_idx = 0U;
-					do{
-						_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-						if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
-						else{_idx++;}
-					}while('<' != _ffBuffer[_idx - 1U]);
-
-					/* Find the '>' symbol */
-					_idx = 0U;
-					do{
-						_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-						if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
-						else{_idx++;}
-					}while('>' != _ffBuffer[_idx - 1U]);
-
-					PROFILE.data[_urlNbrIdx].dataNbr = _ffBuffer[0] - 48U;
-
-					for(uint8_t _urlDataNbrIdx = 0U; _urlDataNbrIdx < PROFILE.data[_urlNbrIdx].dataNbr; _urlDataNbrIdx++)
-					{
-						/* Find the '<' symbol */
-						_idx = 0U;
-						do{
-							_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-							if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
-							else{_idx++;}
-						}while('<' != _ffBuffer[_idx - 1U]);
-
-						_idx = 0U;
-						do{
-							_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-							if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
-							else{_idx++;}
-						}while(':' != _ffBuffer[_idx - 1U]);
-
-						if((6U == _idx) && ('e' == _ffBuffer[0]) && ('m' == _ffBuffer[1]) && \
-						   ('a' == _ffBuffer[2]) && ('i' == _ffBuffer[3]) && ('l' == _ffBuffer[4]) && (':' == _ffBuffer[5]))
-						{PROFILE.data[_urlNbrIdx].dataNameCode[_urlDataNbrIdx] = 0U;}
-						else if((5U == _idx) && ('u' == _ffBuffer[0]) && ('s' == _ffBuffer[1]) && \
-								('e' == _ffBuffer[2]) && ('r' == _ffBuffer[3]) && (':' == _ffBuffer[4]))
-						{PROFILE.data[_urlNbrIdx].dataNameCode[_urlDataNbrIdx] = 1U;}
-						else if((9U == _idx) && ('p' == _ffBuffer[0]) && ('a' == _ffBuffer[1]) && \
-								('s' == _ffBuffer[2]) && ('s' == _ffBuffer[3]) && ('w' == _ffBuffer[4]) && \
-								('o' == _ffBuffer[5]) && ('r' == _ffBuffer[6]) && ('d' == _ffBuffer[7]) && (':' == _ffBuffer[8]))
-						{PROFILE.data[_urlNbrIdx].dataNameCode[_urlDataNbrIdx] = 2U;}
-						else{BSP_Error_Handler();}
-
-						_idx = 0U;
-						do{
-							_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-							if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
-							else{_idx++;}
-						}while('>' != _ffBuffer[_idx - 1U]);
-
-						PROFILE.data[_urlNbrIdx].dataSize[_urlDataNbrIdx] = _idx - 1U;
-						memcpy(&PROFILE.data[_urlNbrIdx].dataBuffer[_urlDataNbrIdx][0], &_ffBuffer[0], PROFILE.data[_urlNbrIdx].dataSize[_urlDataNbrIdx]);
-					}
-				}
+			case(FF_PROFILE_LOAD_MOUNT): FF_PROFILE_Mount(); break;
+			case(FF_PROFILE_LOAD_CHECK): FF_PROFILE_Check_Step(); break;
+			case(FF_PROFILE_LOAD_OFFSETS): FF_PROFILE_Offsets_Step(); break;
+			case(FF_PROFILE_LOAD_TABLES): FF_PROFILE_Tables_Step(); break;
+			case(FF_PROFILE_LOAD_RECORDS): FF_PROFILE_Records_Step(); break;
+			case(FF_PROFILE_LOAD_INDEX): FF_PROFILE_Finish_Image(); break;
+			default: BSP_Error_Handler(); break;
+		}
 
-				f_close(&PROFILE.dataFile);
-			}else{BSP_Error_Handler();}
-		}else{BSP_Error_Handler();}
-	}else{BSP_Error_Handler();}
+		/* A failed write skips the rest of the compile, the partial data.new is dropped */
+		if((FF_PROFILE_LOAD_OFFSETS <= PROFILE.load.state) && (FF_PROFILE_LOAD_RECORDS >= PROFILE.load.state) && (!PROFILE.load.writer.status))
+		{PROFILE.load.state = FF_PROFILE_LOAD_INDEX;}
+
+		_stepTime = (DWT->CYCCNT - _cycles) / (SystemCoreClock / 1000000U);
+		PROFILE.load.busyTime += _stepTime;
+		PROFILE.stats.loadStepNbr++;
+		if(_stepTime > PROFILE.stats.loadStepMax){PROFILE.stats.loadStepMax = _stepTime;}
+
+		if(FF_PROFILE_LOAD_DONE == PROFILE.load.state)
+		{
+			PROFILE.stats.loadTime = PROFILE.load.busyTime / 1000U;
+			PROFILE.stats.dataNbr = PROFILE.dataNbr;
+			PROFILE.stats.sourceNbr = PROFILE.sourceNbr;
+			PROFILE.stats.poolNbr = PROFILE.poolNbr;
+			PROFILE.stats.poolSize = PROFILE.poolLen;
+			PROFILE.stats.dictNbr = PROFILE.dictNbr;
+			PROFILE.stats.stackPeak = FF_PROFILE_Get_Stack_Peak();
+		}
+
+		if((HAL_GetTick() - _tickStart) >= FF_PROFILE_LOAD_SLICE){break;}
+	}
+
+	return (FF_PROFILE_LOAD_DONE == PROFILE.load.state);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile get the load step to run next
+  * @param None
+  * @retval Load state (profile_load_state_te)
+  ***************************************************************************************************************************************
+  */
+profile_load_state_te FF_PROFILE_Get_Load_State(void)
+{
+	return PROFILE.load.state;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FAT file system profile reload after the vault was edited over USB, only the changed sources are parsed again
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void FF_PROFILE_Reload(void)
+{
+	/* The host may have rewritten any sector, drop the open image and the cached FAT state */
+	f_close(&PROFILE.imageFile);
+	if(FR_OK != f_mount(NULL, PROFILE.ffPath, 0U)){BSP_Error_Handler();}
+
+	PROFILE.load.state = FF_PROFILE_LOAD_MOUNT;
+	while(!FF_PROFILE_Load_Task()){}
 }
 
 /**
   ***************************************************************************************************************************************
-  * @brief FAT file system profile initialization
+  * @brief FF profile PIN failure counter check, kept in the reserved flash block behind the FAT volume.
+  *        A wrong PIN appends a failure entry, a correct PIN appends a clear entry only when failures are pending.
+  *        It runs as soon as the load has mounted the volume, before the rest of the load.
+  *        A correct PIN also provisions the QSPI read mode pattern in the last subsector of the block.
   * @param Status (uint8_t)
   * @retval None
   ***************************************************************************************************************************************
   */
 void FF_PROFILE_Check_Error_Log(uint8_t _status)
 {
-	FRESULT _res;
-	uint8_t _ffBuffer[128];
-	__IO uint8_t _idx = 0U;
-	__IO uint32_t _bytesRead;
+	profile_pin_log_ts _log;
+	uint8_t _errorNbr = 0U;
 
-	if(FR_OK == f_open(&PROFILE.errLogFile, FF_PROFILE_ERROR_LOG_FNAME, (FA_READ | FA_WRITE)))
-	{
-		/* Find the first '<' symbol */
-		do{
-			_res = f_read(&PROFILE.errLogFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-			if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
-			else{_idx++;}
-		}while('<' != _ffBuffer[_idx - 1U]);
+	/* The oversized volume is not mounted, so no vault is open behind the PIN. Its error.txt cannot be read and the reserved
+	   block is its data, nothing is written before the user confirms the format. */
+	if(FF_FTL_Get_Stats()->oversizeFlag){return;}
 
-		/* Find the '>' symbol */
-		_idx = 0U;
-		do{
-			_res = f_read(&PROFILE.errLogFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
-			if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
-			else{_idx++;}
-		}while('>' != _ffBuffer[_idx - 1U]);
+	/* Volumes formatted over the whole flash still cover the reserved block, they keep error.txt until reformatted */
+	if(!FF_PROFILE_Reserved_Block_Free())
+	{
+		FF_PROFILE_Check_Error_File(_status);
+		return;
+	}
 
-		uint8_t _errorNbr = _ffBuffer[0] - 48U;
-		f_close(&PROFILE.errLogFile);
+	if(!FF_PROFILE_Pin_Log_Open(&_log))
+	{
+		/* First boot with the flash record, the counter is carried over from error.txt */
+		if(!FF_PROFILE_Read_Error_File(&_errorNbr)){_errorNbr = 0U;}
+		FF_PROFILE_Pin_Log_Format(&_log, 0U, 0U, _errorNbr);
+	}
+	/* A log written before the usage log took the upper half of the block moves down before the usage log erases it */
+	else if(_log.slot >= FF_PROFILE_PIN_LOG_SLOTS){FF_PROFILE_Pin_Log_Format(&_log, 0U, (_log.sequence + 1U), _log.failNbr);}
 
-		if(FR_OK == f_open(&PROFILE.errLogFile, FF_PROFILE_ERROR_LOG_FNAME, (FA_READ | FA_WRITE)))
-		{
-			if((0U == _status) || (_errorNbr >= 3U))
-			{
-				if((_errorNbr + 1U) >= 3U)
-				{
-					f_write(&PROFILE.errLogFile,"<3>", 3U, (void*)&_bytesRead);
-					f_close(&PROFILE.errLogFile);
-					BSP_Error_Handler();
-				}
-				else
-				{
-					_ffBuffer[0] = ((_errorNbr + 1U) + 48U);
-					f_write(&PROFILE.errLogFile, "<", 1U, (void*)&_bytesRead);
-					f_write(&PROFILE.errLogFile, &_ffBuffer[0], 1U, (void*)&_bytesRead);
-					f_write(&PROFILE.errLogFile, ">", 1U, (void*)&_bytesRead);
-				}
-			}else{f_write(&PROFILE.errLogFile, "<0>", 3U, (void*)&_bytesRead);}
+	if((0U == _status) || (_log.failNbr >= FF_PROFILE_PIN_FAIL_MAX))
+	{
+		if(_log.failNbr < FF_PROFILE_PIN_FAIL_MAX){FF_PROFILE_Pin_Log_Append(&_log, FF_PROFILE_PIN_FAIL);}
+		if(_log.failNbr >= FF_PROFILE_PIN_FAIL_MAX){BSP_Error_Handler();}
+	}
+	else if(_log.failNbr){FF_PROFILE_Pin_Log_Append(&_log, FF_PROFILE_PIN_CLEAR);}
 
-			f_close(&PROFILE.errLogFile);
-		}else{BSP_Error_Handler();}
-	}else{BSP_Error_Handler();}
+	if(_status && (QSPI_OK != BSP_QSPI_Write_Bench_Pattern())){BSP_Error_Handler();}
 }
 
 /**
   ***************************************************************************************************************************************
   * @brief FF profile get data number
   * @param None
-  * @retval Data number (uint8_t)
+  * @retval Data number (uint16_t)
   ***************************************************************************************************************************************
   */
-uint8_t FF_PROFILE_Get_Data_Number(void)
+uint16_t FF_PROFILE_Get_Data_Number(void)
 {
 	return PROFILE.dataNbr;
 }
 
 /**
   ***************************************************************************************************************************************
-  * @brief FF profile get data
+  * @brief FF profile get data, the entry is loaded from data.bin on a cache miss and a packed entry is unpacked into ffBuffer.
+  *        The view is valid until the next FF_PROFILE_Get_Data or FF_PROFILE_Prefetch call, or until the next QSPI indirect access
+  *        when the image is memory-mapped.
+  * @param Data index in the vault, URL or usage order, see FF_PROFILE_Set_Order (uint16_t)
+  * @retval Data view (const profile_view_ts*)
+  ***************************************************************************************************************************************
+  */
+const profile_view_ts* FF_PROFILE_Get_Data(uint16_t _dataIdx)
+{
+	profile_cache_ts* _cache;
+	const uint8_t* _record;
+	uint32_t _offset;
+	uint16_t _recordSize;
+
+	if(0U == PROFILE.dataNbr)
+	{
+		memset(&PROFILE.view, 0, sizeof(PROFILE.view));
+		PROFILE.view.url.buffer = (const uint8_t*)"";
+		return &PROFILE.view;
+	}
+
+	if(_dataIdx >= PROFILE.dataNbr){_dataIdx = 0U;}
+
+	/* The usage order changes as the entries are used, its positions are mapped to the entry before the cache */
+	if(FF_PROFILE_ORDER_RECENT == PROFILE.order){_dataIdx = FF_PROFILE_Recent_Entry(_dataIdx);}
+
+	/* Zero-copy, the view points straight into the memory-mapped QSPI window */
+	if(NULL != PROFILE.imageMap)
+	{
+		_offset = FF_PROFILE_Locate_Data(_dataIdx, &_recordSize);
+		if(!FF_PROFILE_Decode_Record(&PROFILE.imageMap[_offset], _recordSize, &PROFILE.view)){BSP_Error_Handler();}
+		return &PROFILE.view;
+	}
+
+	_cache = FF_PROFILE_Find_Cache(_dataIdx);
+	if(NULL == _cache){_cache = FF_PROFILE_Fetch_Cache(_dataIdx);}
+
+	_cache->useStamp = ++PROFILE.useStamp;
+
+	_record = &PROFILE.arena[_cache->arenaIdx];
+	_recordSize = _cache->arenaSize;
+
+	/* The main loop asks for the displayed entry on every pass, it is unpacked once while it stays in ffBuffer */
+	if(_cache->packFlag)
+	{
+		if(PROFILE.viewIdx == _dataIdx){return &PROFILE.view;}
+
+		_recordSize = FF_PROFILE_Unpack_Record(_record, _recordSize, PROFILE.ffBuffer);
+		_record = PROFILE.ffBuffer;
+	}
+
+	if(!FF_PROFILE_Decode_Record(_record, _recordSize, &PROFILE.view)){BSP_Error_Handler();}
+	PROFILE.viewIdx = (PROFILE.ffBuffer == _record) ? _dataIdx : FF_PROFILE_NO_DATA;
+
+	return &PROFILE.view;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile prefetch the neighbours of the displayed entry, at most one entry is loaded per call
+  * @param Displayed data index (uint16_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void FF_PROFILE_Prefetch(uint16_t _dataIdx)
+{
+	uint16_t _neighbourIdx[2];
+
+	/* Nothing to read ahead when the image is memory-mapped */
+	if((PROFILE.dataNbr < 2U) || (NULL != PROFILE.imageMap)){return;}
+
+	_neighbourIdx[0] = ((_dataIdx + 1U) < PROFILE.dataNbr) ? (_dataIdx + 1U) : 0U;
+	_neighbourIdx[1] = (_dataIdx > 0U) ? (_dataIdx - 1U) : (PROFILE.dataNbr - 1U);
+
+	for(uint8_t _idx = 0U; _idx < 2U; _idx++)
+	{
+		if(FF_PROFILE_ORDER_RECENT == PROFILE.order){_neighbourIdx[_idx] = FF_PROFILE_Recent_Entry(_neighbourIdx[_idx]);}
+
+		if(NULL == FF_PROFILE_Find_Cache(_neighbourIdx[_idx]))
+		{
+			FF_PROFILE_Fetch_Cache(_neighbourIdx[_idx])->useStamp = ++PROFILE.useStamp;
+			return;
+		}
+	}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile select the list order, the usage records are opened and matched to the loaded vault on the first call
+  * @param List order (profile_order_te)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void FF_PROFILE_Set_Order(profile_order_te _order)
+{
+	uint8_t _sortFlag = (FF_PROFILE_ORDER_URL == _order);
+
+	FF_PROFILE_Usage_Open();
+	PROFILE.order = _order;
+
+	if(PROFILE.sortFlag == _sortFlag){return;}
+
+	/* The cache is keyed by URL order position or by entry index */
+	PROFILE.sortFlag = _sortFlag;
+	PROFILE.arenaLen = 0U;
+	PROFILE.viewIdx = FF_PROFILE_NO_DATA;
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_CACHE_SIZE; _idx++){PROFILE.cache[_idx].dataIdx = FF_PROFILE_NO_DATA;}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile count a use of a list entry, only the RAM table changes, FF_PROFILE_Usage_Task programs the records later.
+  *        In the usage order the entry moves up the list.
   * @param Data index (uint16_t)
-  * @retval Data (profile_data_ts*)
+  * @retval Data index of the entry after the use (uint16_t)
+  ***************************************************************************************************************************************
+  */
+uint16_t FF_PROFILE_Record_Use(uint16_t _dataIdx)
+{
+	const profile_view_ts* _view;
+	profile_usage_record_ts* _record;
+	uint16_t _entryIdx;
+
+	if(_dataIdx >= PROFILE.dataNbr){return _dataIdx;}
+
+	FF_PROFILE_Usage_Open();
+	_entryIdx = FF_PROFILE_Get_Entry(_dataIdx);
+	PROFILE.usage.useTick = HAL_GetTick();
+
+	/* The URL and the password of one login are a single use */
+	if(_entryIdx == PROFILE.usage.lastIdx){return _dataIdx;}
+	PROFILE.usage.lastIdx = _entryIdx;
+
+	_record = FF_PROFILE_Usage_Find(_entryIdx);
+
+	if(NULL == _record)
+	{
+		_view = FF_PROFILE_Get_Data(_dataIdx);
+		_record = FF_PROFILE_Usage_Add(_entryIdx, FF_PROFILE_Url_Hash(_view->url.buffer, _view->url.size));
+	}
+
+	FF_PROFILE_Usage_Touch(_record);
+
+	return (FF_PROFILE_ORDER_RECENT == PROFILE.order) ? FF_PROFILE_Recent_Position(_entryIdx) : _dataIdx;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile usage task, the pending records are programmed once no entry was used for FF_PROFILE_USAGE_FLUSH_TMO ms
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void FF_PROFILE_Usage_Task(void)
+{
+	if((PROFILE.usage.pendingNbr) && ((HAL_GetTick() - PROFILE.usage.useTick) >= FF_PROFILE_USAGE_FLUSH_TMO)){FF_PROFILE_Usage_Flush();}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile program the pending usage records, appended to the current slot or copied with the live records to the next one.
+  *        Nothing is written while the FAT volume covers the reserved block.
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void FF_PROFILE_Usage_Flush(void)
+{
+	profile_usage_ts* _usage = &PROFILE.usage;
+	uint16_t _len = 0U;
+
+	if((0U == _usage->pendingNbr) || (!_usage->logFlag))
+	{
+		memset(_usage->pendingFlag, 0, sizeof(_usage->pendingFlag));
+		_usage->pendingNbr = 0U;
+		return;
+	}
+
+	if(_usage->clock >= FF_PROFILE_USAGE_CLOCK_MAX)
+	{
+		FF_PROFILE_Usage_Rebase();
+		FF_PROFILE_Usage_Log_Move();
+	}
+	else if((_usage->recordPos + (_usage->pendingNbr * sizeof(profile_usage_record_ts))) > DISKIO_BLK_SIZ){FF_PROFILE_Usage_Log_Move();}
+	else
+	{
+		/* The records are staged in ffBuffer and programmed in one go */
+		PROFILE.viewIdx = FF_PROFILE_NO_DATA;
+
+		for(uint8_t _idx = 0U; _idx < FF_PROFILE_USAGE_NBR; _idx++)
+		{
+			if(_usage->pendingFlag[_idx]){_len = FF_PROFILE_Usage_Stage(_len, &_usage->record[_idx]);}
+		}
+
+		if(QSPI_OK != BSP_QSPI_Write(PROFILE.ffBuffer, (FF_PROFILE_USAGE_ADDR(_usage->slot) + _usage->recordPos), _len)){BSP_Error_Handler();}
+
+		_usage->recordPos += _len;
+		PROFILE.stats.usageWrites += _usage->pendingNbr;
+	}
+
+	memset(_usage->pendingFlag, 0, sizeof(_usage->pendingFlag));
+	_usage->pendingNbr = 0U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile get the letter group of a sorted list position
+  * @param Sorted data index (uint16_t)
+  * @retval Group, 0 - '#', 1..26 - 'A'..'Z' (uint8_t)
+  ***************************************************************************************************************************************
+  */
+uint8_t FF_PROFILE_Get_Group(uint16_t _dataIdx)
+{
+	uint8_t _low = 0U;
+	uint8_t _high = FF_PROFILE_GROUP_NBR - 1U;
+	uint8_t _mid;
+
+	/* Last group starting at or before the position, empty groups share the start of the next one */
+	while(_low < _high)
+	{
+		_mid = (_low + _high + 1U) / 2U;
+		if(PROFILE.groupStart[_mid] <= _dataIdx){_low = _mid;}
+		else{_high = _mid - 1U;}
+	}
+
+	return _low;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile get the first sorted list position of a letter group
+  * @param Group (uint8_t), FF_PROFILE_GROUP_NBR gives the end of the list
+  * @retval Sorted data index (uint16_t)
+  ***************************************************************************************************************************************
+  */
+uint16_t FF_PROFILE_Get_Group_Start(uint8_t _group)
+{
+	if(_group > FF_PROFILE_GROUP_NBR){_group = FF_PROFILE_GROUP_NBR;}
+
+	return PROFILE.groupStart[_group];
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile jump to the first entry of the next or previous non-empty letter group
+  * @param Sorted data index (uint16_t), next group flag (uint8_t)
+  * @retval Sorted data index (uint16_t)
+  ***************************************************************************************************************************************
+  */
+uint16_t FF_PROFILE_Jump_Group(uint16_t _dataIdx, uint8_t _nextFlag)
+{
+	uint8_t _group = FF_PROFILE_Get_Group(_dataIdx);
+
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_GROUP_NBR; _idx++)
+	{
+		if(_nextFlag){_group = ((_group + 1U) < FF_PROFILE_GROUP_NBR) ? (_group + 1U) : 0U;}
+		else{_group = (_group > 0U) ? (_group - 1U) : (FF_PROFILE_GROUP_NBR - 1U);}
+
+		if(PROFILE.groupStart[_group] < PROFILE.groupStart[_group + 1U]){return PROFILE.groupStart[_group];}
+	}
+
+	return _dataIdx;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile get the load statistics
+  * @param None
+  * @retval Statistics (const profile_stats_ts*)
+  ***************************************************************************************************************************************
+  */
+const profile_stats_ts* FF_PROFILE_Get_Stats(void)
+{
+	return &PROFILE.stats;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile first load step, mounts the volume, lists the vault sources and checks the header of data.bin
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Mount(void)
+{
+	FRESULT _res;
+
+	memset(&PROFILE.stats, 0, sizeof(PROFILE.stats));
+	PROFILE.stats.staticSize = sizeof(PROFILE);
+	PROFILE.load.busyTime = 0U;
+	FF_PROFILE_Paint_Stack();
+
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_CACHE_SIZE; _idx++){PROFILE.cache[_idx].dataIdx = FF_PROFILE_NO_DATA;}
+	PROFILE.arenaLen = 0U;
+	PROFILE.viewIdx = FF_PROFILE_NO_DATA;
+	PROFILE.dataNbr = 0U;
+	PROFILE.imageMap = NULL;
+	PROFILE.sortFlag = 0U;
+	PROFILE.order = FF_PROFILE_ORDER_VAULT;
+	PROFILE.usage.resolveFlag = 0U;
+
+	/* The volume is checked right away, a blank memory is reported and only formatted once the user asks for it after the PIN */
+	_res = f_mount(&PROFILE.ffFs, PROFILE.ffPath, 1U);
+	if(FR_NO_FILESYSTEM == _res)
+	{
+		PROFILE.stats.blankFlag = 1U;
+		PROFILE.sourceNbr = 0U;
+		PROFILE.load.state = FF_PROFILE_LOAD_DONE;
+		return;
+	}
+	else if(FR_OK != _res){BSP_Error_Handler();}
+
+	FF_PROFILE_Scan_Sources();
+	if(0U == PROFILE.sourceNbr){BSP_Error_Handler();}
+
+	/* Parse the text vault only when it does not match the binary image */
+	if(FF_PROFILE_Check_Image()){PROFILE.load.state = FF_PROFILE_LOAD_CHECK;}
+	else{FF_PROFILE_Compile_Start();}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile format the volume, confirmed by the user after the PIN and only when the load found no volume. The FTL writes
+  *        every sector out of place, so the layout only has to suit FatFs: a cluster is one sector and the data area starts on the
+  *        erase block reported by GET_BLOCK_SIZE. An empty vault is created, FF_PROFILE_Reload loads it. The QSPI read mode
+  *        pattern is provisioned in the reserved block the format leaves free.
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void FF_PROFILE_Format(void)
+{
+	FIL* _file = &PROFILE.dataFile;
+
+	if(!PROFILE.stats.blankFlag){return;}
+
+	if(FR_OK != f_mkfs(PROFILE.ffPath, FF_PROFILE_FORMAT_OPT, FF_PROFILE_FORMAT_AU, PROFILE.ffBuffer, sizeof(PROFILE.ffBuffer))){BSP_Error_Handler();}
+	if(QSPI_OK != BSP_QSPI_Write_Bench_Pattern()){BSP_Error_Handler();}
+	if(FR_OK != f_mount(&PROFILE.ffFs, PROFILE.ffPath, 1U)){BSP_Error_Handler();}
+	if(FR_OK != f_mkdir(FF_PROFILE_VAULT_DIR)){BSP_Error_Handler();}
+	if(FR_OK != f_open(_file, FF_PROFILE_DATA_FNAME, (FA_CREATE_NEW | FA_WRITE))){BSP_Error_Handler();}
+	if(FR_OK != f_close(_file)){BSP_Error_Handler();}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile open data.bin and check its header, the following load steps stream the image through the CRC unit
+  * @param None
+  * @retval Header valid (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Check_Image(void)
+{
+	profile_image_header_ts* _header = &PROFILE.load.header;
+	profile_reader_ts* _reader = &PROFILE.load.reader;
+	UINT _bytesRead;
+
+	for(uint8_t _idx = 0U; _idx < PROFILE.sourceNbr; _idx++){PROFILE.source[_idx].imageIdx = FF_PROFILE_NO_DATA;}
+	PROFILE.poolNbr = 0U;
+	PROFILE.poolLen = 0U;
+	PROFILE.dictNbr = 0U;
+
+	if(FR_OK != f_open(&PROFILE.imageFile, FF_PROFILE_IMAGE_FNAME, FA_READ)){return 0U;}
+
+	if((FR_OK == FF_PROFILE_Read_File(&PROFILE.imageFile, _header, sizeof(profile_image_header_ts), &_bytesRead)) && \
+	   (sizeof(profile_image_header_ts) == _bytesRead) && (FF_PROFILE_IMAGE_MAGIC == _header->magic) && (FF_PROFILE_IMAGE_VERSION == _header->version) && \
+	   (_header->dataNbr <= FF_PROFILE_MAX_DATA) && (_header->sourceNbr <= FF_PROFILE_SOURCE_NBR) && (_header->poolSize <= FF_PROFILE_POOL_SIZE) && \
+	   ((sizeof(profile_image_header_ts) + _header->imageSize) == f_size(&PROFILE.imageFile)) && \
+	   ((_header->indexOffset + (_header->dataNbr * sizeof(uint16_t)) + sizeof(PROFILE.groupStart) + _header->dictSize) == f_size(&PROFILE.imageFile)))
+	{
+		memset(_reader, 0, sizeof(profile_reader_ts));
+		_reader->file = &PROFILE.imageFile;
+		_reader->buffer = PROFILE.ffBuffer;
+		_reader->bufferSize = DISKIO_BLK_SIZ;
+		_reader->crcFlag = 1U;
+		__HAL_CRC_DR_RESET(&PROFILE.crc);
+
+		return 1U;
+	}
+
+	f_close(&PROFILE.imageFile);
+
+	return 0U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile load step streaming data.bin through the CRC unit, nothing is decoded before the whole image is checked
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Check_Step(void)
+{
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_STEP_SECTORS; _idx++)
+	{
+		if(FF_PROFILE_Fill_Buffer(&PROFILE.load.reader))
+		{
+			PROFILE.load.reader.bufferIdx = PROFILE.load.reader.bufferLen;
+			continue;
+		}
+
+		if(FF_PROFILE_Open_Image()){PROFILE.load.state = FF_PROFILE_LOAD_DONE;}
+		/* A freshly compiled image has to match */
+		else if(PROFILE.stats.compileFlag){BSP_Error_Handler();}
+		else{FF_PROFILE_Compile_Start();}
+
+		return;
+	}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile list the vault sources, data.txt first and then the text files of the vault folder in directory order
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Scan_Sources(void)
+{
+	DIR _dir;
+	FILINFO _fileInfo;
+	FRESULT _res;
+
+	PROFILE.sourceNbr = 0U;
+
+	if(FR_OK == f_stat(FF_PROFILE_DATA_FNAME, &_fileInfo)){FF_PROFILE_Add_Source("", &_fileInfo);}
+
+	for(_res = f_findfirst(&_dir, &_fileInfo, FF_PROFILE_VAULT_DIR, FF_PROFILE_VAULT_PATTERN); (FR_OK == _res) && (_fileInfo.fname[0]); \
+		_res = f_findnext(&_dir, &_fileInfo))
+	{
+		/* Skip folders, hidden files and the "._" companions some hosts leave behind */
+		if((0U == (_fileInfo.fattrib & (AM_DIR | AM_HID | AM_SYS))) && ('.' != _fileInfo.fname[0])){FF_PROFILE_Add_Source(FF_PROFILE_VAULT_DIR "/", &_fileInfo);}
+	}
+
+	f_closedir(&_dir);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile add a vault source, the short name keeps the path within the source table entry
+  * @param Folder prefix (const char*), file information (const FILINFO*)
+  * @retval None
   ***************************************************************************************************************************************
   */
-profile_data_ts* FF_PROFILE_Get_Data(uint16_t _dataIdx)
+static void FF_PROFILE_Add_Source(const char* _dir, const FILINFO* _fileInfo)
 {
-	return (profile_data_ts*)&PROFILE.data[_dataIdx];
+	profile_source_ts* _source;
+
+	if(PROFILE.sourceNbr >= FF_PROFILE_SOURCE_NBR){BSP_Error_Handler();}
+
+	_source = &PROFILE.source[PROFILE.sourceNbr++];
+	memset(_source, 0, sizeof(profile_source_ts));
+	strcpy(_source->path, _dir);
+	strcat(_source->path, _fileInfo->altname);
+	_source->size = _fileInfo->fsize;
+	_source->time = FF_PROFILE_IMAGE_TIME(_fileInfo);
+	_source->imageIdx = FF_PROFILE_NO_DATA;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile paint the free part of the reserved stack below the current frame, the peak usage is found by the first
+  *        overwritten word. The heap under the reserved stack is left alone.
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Paint_Stack(void)
+{
+	uint32_t* _word = (uint32_t*)((uintptr_t)&_estack - (uintptr_t)&_Min_Stack_Size);
+	uint32_t* _top = (uint32_t*)(uintptr_t)(__get_MSP() - FF_PROFILE_STACK_GUARD);
+
+	while(_word < _top){*_word++ = FF_PROFILE_STACK_PAINT;}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile get the stack peak since the last FF_PROFILE_Paint_Stack call, a peak past the reserved stack reads as its size
+  * @param None
+  * @retval Stack peak in bytes (uint32_t)
+  ***************************************************************************************************************************************
+  */
+static uint32_t FF_PROFILE_Get_Stack_Peak(void)
+{
+	uint32_t* _word = (uint32_t*)((uintptr_t)&_estack - (uintptr_t)&_Min_Stack_Size);
+
+	while((_word < &_estack) && (FF_PROFILE_STACK_PAINT == *_word)){_word++;}
+
+	return (uint32_t)((uint8_t*)&_estack - (uint8_t*)_word);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile counted f_read
+  * @param File (FIL*), destination (void*), length (UINT), bytes read (UINT*)
+  * @retval FatFs result (FRESULT)
+  ***************************************************************************************************************************************
+  */
+static FRESULT FF_PROFILE_Read_File(FIL* _file, void* _dst, UINT _len, UINT* _bytesRead)
+{
+	FRESULT _res = f_read(_file, _dst, _len, _bytesRead);
+
+	PROFILE.stats.readCalls++;
+	PROFILE.stats.readBytes += *_bytesRead;
+
+	return _res;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile read the PIN failure number from error.txt
+  * @param Failure number (uint8_t*)
+  * @retval Status (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Read_Error_File(uint8_t* _errorNbr)
+{
+	FRESULT _res;
+	uint8_t _ffBuffer[128];
+	__IO uint8_t _idx = 0U;
+	__IO uint32_t _bytesRead;
+
+	if(FR_OK != f_open(&PROFILE.dataFile, FF_PROFILE_ERROR_LOG_FNAME, FA_READ)){return 0U;}
+
+	/* Find the first '<' symbol */
+	do{
+		_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
+		if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
+		else{_idx++;}
+	}while('<' != _ffBuffer[_idx - 1U]);
+
+	/* Find the '>' symbol */
+	_idx = 0U;
+	do{
+		_res = f_read(&PROFILE.dataFile, &_ffBuffer[_idx], 1U, (UINT*)&_bytesRead);
+		if((0U == _bytesRead) || (FR_OK != _res)){BSP_Error_Handler();}
+		else{_idx++;}
+	}while('>' != _ffBuffer[_idx - 1U]);
+
+	*_errorNbr = _ffBuffer[0] - 48U;
+	f_close(&PROFILE.dataFile);
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile PIN failure counter check in error.txt, used while the FAT volume covers the reserved flash block
+  * @param Status (uint8_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Check_Error_File(uint8_t _status)
+{
+	uint8_t _errorNbr;
+	uint8_t _digit;
+	__IO uint32_t _bytesWritten;
+
+	if(!FF_PROFILE_Read_Error_File(&_errorNbr)){BSP_Error_Handler();}
+
+	if(FR_OK == f_open(&PROFILE.dataFile, FF_PROFILE_ERROR_LOG_FNAME, (FA_READ | FA_WRITE)))
+	{
+		if((0U == _status) || (_errorNbr >= FF_PROFILE_PIN_FAIL_MAX))
+		{
+			if((_errorNbr + 1U) >= FF_PROFILE_PIN_FAIL_MAX)
+			{
+				f_write(&PROFILE.dataFile,"<3>", 3U, (void*)&_bytesWritten);
+				f_close(&PROFILE.dataFile);
+				BSP_Error_Handler();
+			}
+			else
+			{
+				_digit = ((_errorNbr + 1U) + 48U);
+				f_write(&PROFILE.dataFile, "<", 1U, (void*)&_bytesWritten);
+				f_write(&PROFILE.dataFile, &_digit, 1U, (void*)&_bytesWritten);
+				f_write(&PROFILE.dataFile, ">", 1U, (void*)&_bytesWritten);
+			}
+		}else{f_write(&PROFILE.dataFile, "<0>", 3U, (void*)&_bytesWritten);}
+
+		f_close(&PROFILE.dataFile);
+	}else{BSP_Error_Handler();}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile open the PIN log, the valid slot with the newest sequence holds the entries
+  * @param PIN log handle (profile_pin_log_ts*)
+  * @retval Status (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Pin_Log_Open(profile_pin_log_ts* _log)
+{
+	profile_pin_log_header_ts _header;
+	uint8_t _validFlag = 0U;
+
+	/* The slot is scanned in ffBuffer */
+	PROFILE.viewIdx = FF_PROFILE_NO_DATA;
+
+	/* The whole reserved block is scanned, a log left in the upper half by an older firmware is still found */
+	for(uint8_t _slot = 0U; _slot < DISKIO_RSV_BLK_NBR; _slot++)
+	{
+		if(QSPI_OK != BSP_QSPI_Read((uint8_t*)&_header, FF_PROFILE_PIN_LOG_ADDR(_slot), sizeof(_header))){BSP_Error_Handler();}
+
+		if((FF_PROFILE_PIN_LOG_MAGIC == _header.magic) && ((!_validFlag) || ((int16_t)(_header.sequence - _log->sequence) > 0)))
+		{
+			_validFlag = 1U;
+			_log->slot = _slot;
+			_log->sequence = _header.sequence;
+		}
+	}
+
+	if(!_validFlag){return 0U;}
+
+	/* Failures count up to the last clear entry, the first erased byte ends the log */
+	if(QSPI_OK != BSP_QSPI_Read(PROFILE.ffBuffer, FF_PROFILE_PIN_LOG_ADDR(_log->slot), DISKIO_BLK_SIZ)){BSP_Error_Handler();}
+
+	_log->failNbr = 0U;
+
+	for(_log->entryIdx = sizeof(_header); (_log->entryIdx < DISKIO_BLK_SIZ) && (0xFFU != PROFILE.ffBuffer[_log->entryIdx]); _log->entryIdx++)
+	{
+		if(FF_PROFILE_PIN_CLEAR == PROFILE.ffBuffer[_log->entryIdx]){_log->failNbr = 0U;}
+		else if(_log->failNbr < FF_PROFILE_PIN_FAIL_MAX){_log->failNbr++;}
+	}
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile start a PIN log slot, the pending failures are written before the header validates the slot
+  * @param PIN log handle (profile_pin_log_ts*), slot (uint8_t), sequence (uint16_t), failure number (uint8_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Pin_Log_Format(profile_pin_log_ts* _log, uint8_t _slot, uint16_t _sequence, uint8_t _failNbr)
+{
+	profile_pin_log_header_ts _header = {FF_PROFILE_PIN_LOG_MAGIC, _sequence};
+	uint8_t _entries[FF_PROFILE_PIN_FAIL_MAX];
+
+	if(_failNbr > FF_PROFILE_PIN_FAIL_MAX){_failNbr = FF_PROFILE_PIN_FAIL_MAX;}
+	memset(_entries, FF_PROFILE_PIN_FAIL, sizeof(_entries));
+
+	if((QSPI_OK != BSP_QSPI_Erase_Block(FF_PROFILE_PIN_LOG_ADDR(_slot))) || \
+	   ((_failNbr) && (QSPI_OK != BSP_QSPI_Write(_entries, (FF_PROFILE_PIN_LOG_ADDR(_slot) + sizeof(_header)), _failNbr))) || \
+	   (QSPI_OK != BSP_QSPI_Write((uint8_t*)&_header, FF_PROFILE_PIN_LOG_ADDR(_slot), sizeof(_header)))){BSP_Error_Handler();}
+
+	_log->slot = _slot;
+	_log->sequence = _sequence;
+	_log->entryIdx = sizeof(_header) + _failNbr;
+	_log->failNbr = _failNbr;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile append a PIN log entry, only erased bits are programmed, a full slot moves on to the next one
+  * @param PIN log handle (profile_pin_log_ts*), entry (uint8_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Pin_Log_Append(profile_pin_log_ts* _log, uint8_t _entry)
+{
+	if(_log->entryIdx >= DISKIO_BLK_SIZ)
+	{
+		FF_PROFILE_Pin_Log_Format(_log, ((_log->slot + 1U) % FF_PROFILE_PIN_LOG_SLOTS), (_log->sequence + 1U), _log->failNbr);
+	}
+
+	if(QSPI_OK != BSP_QSPI_Write(&_entry, (FF_PROFILE_PIN_LOG_ADDR(_log->slot) + _log->entryIdx), 1U)){BSP_Error_Handler();}
+
+	_log->entryIdx++;
+
+	if(FF_PROFILE_PIN_CLEAR == _entry){_log->failNbr = 0U;}
+	else if(_log->failNbr < FF_PROFILE_PIN_FAIL_MAX){_log->failNbr++;}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile check that the FAT volume ends before the reserved flash block, a blank memory has no volume over it.
+  *        The oversized volume of an older firmware still covers the block until the user formats the memory.
+  * @param None
+  * @retval Reserved block free (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Reserved_Block_Free(void)
+{
+	if(PROFILE.stats.blankFlag){return (!FF_FTL_Get_Stats()->oversizeFlag);}
+
+	return ((PROFILE.ffFs.database + ((PROFILE.ffFs.n_fatent - 2U) * PROFILE.ffFs.csize)) <= DISKIO_BLK_NBR);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile open the usage log once per power-on and match the usage records to the entries of the loaded vault
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Usage_Open(void)
+{
+	profile_usage_ts* _usage = &PROFILE.usage;
+
+	if(_usage->resolveFlag){return;}
+
+	if(!_usage->openFlag)
+	{
+		_usage->openFlag = 1U;
+		_usage->logFlag = FF_PROFILE_Reserved_Block_Free();
+
+		/* Without a valid slot the first flush starts the log in slot 0 */
+		if((!_usage->logFlag) || (!FF_PROFILE_Usage_Log_Read()))
+		{
+			memset(_usage->record, 0, sizeof(_usage->record));
+			_usage->slot = FF_PROFILE_USAGE_SLOTS - 1U;
+			_usage->sequence = 0xFFFFU;
+			_usage->recordPos = DISKIO_BLK_SIZ;
+			_usage->clock = 0U;
+		}
+	}
+
+	FF_PROFILE_Usage_Resolve();
+	_usage->lastIdx = FF_PROFILE_NO_DATA;
+	_usage->resolveFlag = 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile read the usage log, the valid slot with the newest sequence is replayed into the usage table
+  * @param None
+  * @retval Status (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Usage_Log_Read(void)
+{
+	profile_usage_ts* _usage = &PROFILE.usage;
+	profile_usage_header_ts _header;
+	profile_usage_record_ts _record;
+	uint8_t _validFlag = 0U;
+	uint8_t _check;
+
+	for(uint8_t _slot = 0U; _slot < FF_PROFILE_USAGE_SLOTS; _slot++)
+	{
+		if(QSPI_OK != BSP_QSPI_Read((uint8_t*)&_header, FF_PROFILE_USAGE_ADDR(_slot), sizeof(_header))){BSP_Error_Handler();}
+
+		if((FF_PROFILE_USAGE_MAGIC == _header.magic) && ((!_validFlag) || ((int16_t)(_header.sequence - _usage->sequence) > 0)))
+		{
+			_validFlag = 1U;
+			_usage->slot = _slot;
+			_usage->sequence = _header.sequence;
+		}
+	}
+
+	if(!_validFlag){return 0U;}
+
+	/* The slot is replayed from ffBuffer, the first fully erased record ends the log */
+	PROFILE.viewIdx = FF_PROFILE_NO_DATA;
+	if(QSPI_OK != BSP_QSPI_Read(PROFILE.ffBuffer, FF_PROFILE_USAGE_ADDR(_usage->slot), DISKIO_BLK_SIZ)){BSP_Error_Handler();}
+
+	memset(_usage->record, 0, sizeof(_usage->record));
+	_usage->clock = 0U;
+
+	for(_usage->recordPos = sizeof(_header); (_usage->recordPos + sizeof(_record)) <= DISKIO_BLK_SIZ; _usage->recordPos += sizeof(_record))
+	{
+		memcpy(&_record, &PROFILE.ffBuffer[_usage->recordPos], sizeof(_record));
+
+		_check = 0xFFU;
+		for(uint8_t _idx = 0U; _idx < sizeof(_record); _idx++){_check &= PROFILE.ffBuffer[_usage->recordPos + _idx];}
+		if(0xFFU == _check){break;}
+
+		_check = _record.check;
+		_record.check = FF_PROFILE_USAGE_CHECK;
+		for(uint8_t _idx = 0U; _idx < sizeof(_record); _idx++){_record.check ^= (_idx == 1U) ? 0U : PROFILE.ffBuffer[_usage->recordPos + _idx];}
+
+		/* A record torn by a power loss is skipped */
+		if((_check != _record.check) || (_record.recordIdx >= FF_PROFILE_USAGE_NBR)){continue;}
+
+		_usage->record[_record.recordIdx] = _record;
+		if((_record.count) && (_record.stamp > _usage->clock)){_usage->clock = _record.stamp;}
+	}
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile copy the live usage records to the next slot, the header is written last so the previous slot stays valid until then
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Usage_Log_Move(void)
+{
+	profile_usage_ts* _usage = &PROFILE.usage;
+	uint8_t _slot = (_usage->slot + 1U) % FF_PROFILE_USAGE_SLOTS;
+	profile_usage_header_ts _header = {FF_PROFILE_USAGE_MAGIC, (_usage->sequence + 1U)};
+	uint16_t _len = 0U;
+
+	PROFILE.viewIdx = FF_PROFILE_NO_DATA;
+
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_USAGE_NBR; _idx++)
+	{
+		if(_usage->record[_idx].count){_len = FF_PROFILE_Usage_Stage(_len, &_usage->record[_idx]);}
+	}
+
+	if((QSPI_OK != BSP_QSPI_Erase_Block(FF_PROFILE_USAGE_ADDR(_slot))) || \
+	   ((_len) && (QSPI_OK != BSP_QSPI_Write(PROFILE.ffBuffer, (FF_PROFILE_USAGE_ADDR(_slot) + sizeof(_header)), _len))) || \
+	   (QSPI_OK != BSP_QSPI_Write((uint8_t*)&_header, FF_PROFILE_USAGE_ADDR(_slot), sizeof(_header)))){BSP_Error_Handler();}
+
+	_usage->slot = _slot;
+	_usage->sequence = _header.sequence;
+	_usage->recordPos = sizeof(_header) + _len;
+	PROFILE.stats.usageWrites += _len / sizeof(profile_usage_record_ts);
+	PROFILE.stats.usageMoves++;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile stage a usage record in ffBuffer with its check byte
+  * @param Staged length (uint16_t), usage record (profile_usage_record_ts*)
+  * @retval Staged length (uint16_t)
+  ***************************************************************************************************************************************
+  */
+static uint16_t FF_PROFILE_Usage_Stage(uint16_t _len, profile_usage_record_ts* _record)
+{
+	const uint8_t* _byte = (const uint8_t*)_record;
+
+	_record->check = FF_PROFILE_USAGE_CHECK;
+	for(uint8_t _idx = 0U; _idx < sizeof(profile_usage_record_ts); _idx++){_record->check ^= (_idx == 1U) ? 0U : _byte[_idx];}
+
+	memcpy(&PROFILE.ffBuffer[_len], _record, sizeof(profile_usage_record_ts));
+
+	return (_len + sizeof(profile_usage_record_ts));
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile match the usage records to the loaded vault. A record is checked against the URL hash of its entry index,
+  *        the records an edit moved are looked up in one pass over the vault and the ones not found are freed.
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Usage_Resolve(void)
+{
+	profile_usage_ts* _usage = &PROFILE.usage;
+	profile_usage_record_ts* _record;
+	uint8_t _missNbr = 0U;
+	uint32_t _hash;
+
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_USAGE_NBR; _idx++)
+	{
+		_record = &_usage->record[_idx];
+		_record->recordIdx = _idx;
+
+		if((_record->count) && ((_record->dataIdx >= PROFILE.dataNbr) || (_record->urlHash != FF_PROFILE_Entry_Hash(_record->dataIdx))))
+		{
+			_record->dataIdx = FF_PROFILE_NO_DATA;
+			_missNbr++;
+		}
+	}
+
+	for(uint16_t _entryIdx = 0U; (_entryIdx < PROFILE.dataNbr) && (_missNbr); _entryIdx++)
+	{
+		_hash = FF_PROFILE_Entry_Hash(_entryIdx);
+
+		for(uint8_t _idx = 0U; _idx < FF_PROFILE_USAGE_NBR; _idx++)
+		{
+			_record = &_usage->record[_idx];
+
+			if((_record->count) && (FF_PROFILE_NO_DATA == _record->dataIdx) && (_hash == _record->urlHash) && (NULL == FF_PROFILE_Usage_Find(_entryIdx)))
+			{
+				_record->dataIdx = _entryIdx;
+				_usage->pendingFlag[_idx] = 1U;
+				_missNbr--;
+				break;
+			}
+		}
+	}
+
+	for(uint8_t _idx = 0U; (_idx < FF_PROFILE_USAGE_NBR) && (_missNbr); _idx++)
+	{
+		_record = &_usage->record[_idx];
+
+		if((_record->count) && (FF_PROFILE_NO_DATA == _record->dataIdx))
+		{
+			_record->count = 0U;
+			_usage->pendingFlag[_idx] = 1U;
+			_missNbr--;
+		}
+	}
+
+	_usage->pendingNbr = 0U;
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_USAGE_NBR; _idx++){_usage->pendingNbr += _usage->pendingFlag[_idx];}
+
+	FF_PROFILE_Usage_Build();
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile renumber the usage stamps in their order before the use clock wraps, the counts are halved so old uses weigh less
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Usage_Rebase(void)
+{
+	profile_usage_ts* _usage = &PROFILE.usage;
+	profile_usage_record_ts* _oldest;
+	uint16_t _stamp = 0U;
+	uint16_t _lastStamp = 0U;
+
+	/* The stamps are unique, the n-th oldest is at least n so a renumbered record is never picked again */
+	do{
+		_oldest = NULL;
+
+		for(uint8_t _idx = 0U; _idx < FF_PROFILE_USAGE_NBR; _idx++)
+		{
+			if((_usage->record[_idx].count) && (_usage->record[_idx].stamp > _lastStamp) && \
+			   ((NULL == _oldest) || (_usage->record[_idx].stamp < _oldest->stamp))){_oldest = &_usage->record[_idx];}
+		}
+
+		if(NULL != _oldest)
+		{
+			_lastStamp = _oldest->stamp;
+			_oldest->stamp = ++_stamp;
+			_oldest->count = (_oldest->count + 1U) / 2U;
+		}
+	}while(NULL != _oldest);
+
+	_usage->clock = _stamp;
+	FF_PROFILE_Usage_Build();
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile rebuild the usage list orders from the usage table
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Usage_Build(void)
+{
+	profile_usage_ts* _usage = &PROFILE.usage;
+	uint8_t _recentIdx;
+
+	_usage->rankNbr = 0U;
+	_usage->recentNbr = 0U;
+
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_USAGE_NBR; _idx++)
+	{
+		if(0U == _usage->record[_idx].count){continue;}
+
+		_usage->rank[_usage->rankNbr] = _idx;
+		_usage->entry[_usage->rankNbr] = _idx;
+		_usage->rankNbr++;
+
+		/* Newest stamps first */
+		for(_recentIdx = _usage->recentNbr; (_recentIdx > 0U) && (_usage->record[_usage->recent[_recentIdx - 1U]].stamp < _usage->record[_idx].stamp); _recentIdx--)
+		{
+			if(_recentIdx < FF_PROFILE_USAGE_RECENT){_usage->recent[_recentIdx] = _usage->recent[_recentIdx - 1U];}
+		}
+
+		if(_recentIdx < FF_PROFILE_USAGE_RECENT)
+		{
+			_usage->recent[_recentIdx] = _idx;
+			if(_usage->recentNbr < FF_PROFILE_USAGE_RECENT){_usage->recentNbr++;}
+		}
+	}
+
+	FF_PROFILE_Usage_Sort(_usage->rank, _usage->rankNbr, 1U);
+	FF_PROFILE_Usage_Sort(_usage->entry, _usage->rankNbr, 0U);
+	PROFILE.stats.usageNbr = _usage->rankNbr;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile insertion sort of a usage list order, linear when a single record changed since the last sort
+  * @param Record indexes (uint8_t*), record number (uint8_t), rank order flag (uint8_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Usage_Sort(uint8_t* _order, uint8_t _nbr, uint8_t _rankFlag)
+{
+	const profile_usage_record_ts* _record = PROFILE.usage.record;
+	uint8_t _recordIdx;
+	uint8_t _pos;
+
+	for(uint8_t _idx = 1U; _idx < _nbr; _idx++)
+	{
+		_recordIdx = _order[_idx];
+
+		for(_pos = _idx; (_pos > 0U) && (FF_PROFILE_Usage_Before(&_record[_recordIdx], &_record[_order[_pos - 1U]], _rankFlag)); _pos--)
+		{_order[_pos] = _order[_pos - 1U];}
+
+		_order[_pos] = _recordIdx;
+	}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile usage record order, by use count and last use in the rank order and by vault entry index otherwise
+  * @param Usage records (const profile_usage_record_ts*), rank order flag (uint8_t)
+  * @retval Record A goes first (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Usage_Before(const profile_usage_record_ts* _recordA, const profile_usage_record_ts* _recordB, uint8_t _rankFlag)
+{
+	if(!_rankFlag){return (_recordA->dataIdx < _recordB->dataIdx);}
+	if(_recordA->count != _recordB->count){return (_recordA->count > _recordB->count);}
+
+	return (_recordA->stamp > _recordB->stamp);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile find the usage record of a vault entry
+  * @param Entry index (uint16_t)
+  * @retval Usage record (profile_usage_record_ts*, NULL when the entry was not used)
+  ***************************************************************************************************************************************
+  */
+static profile_usage_record_ts* FF_PROFILE_Usage_Find(uint16_t _entryIdx)
+{
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_USAGE_NBR; _idx++)
+	{
+		if((PROFILE.usage.record[_idx].count) && (_entryIdx == PROFILE.usage.record[_idx].dataIdx)){return &PROFILE.usage.record[_idx];}
+	}
+
+	return NULL;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile add a usage record, a full table reuses the lowest ranked record outside of the last uses
+  * @param Entry index (uint16_t), URL hash (uint32_t)
+  * @retval Usage record (profile_usage_record_ts*)
+  ***************************************************************************************************************************************
+  */
+static profile_usage_record_ts* FF_PROFILE_Usage_Add(uint16_t _entryIdx, uint32_t _urlHash)
+{
+	profile_usage_ts* _usage = &PROFILE.usage;
+	profile_usage_record_ts* _record = NULL;
+	uint8_t _pos;
+
+	if(_usage->rankNbr < FF_PROFILE_USAGE_NBR)
+	{
+		for(uint8_t _idx = 0U; (_idx < FF_PROFILE_USAGE_NBR) && (NULL == _record); _idx++)
+		{
+			if(0U == _usage->record[_idx].count){_record = &_usage->record[_idx];}
+		}
+
+		_usage->rank[_usage->rankNbr] = _record->recordIdx;
+		_usage->entry[_usage->rankNbr] = _record->recordIdx;
+		_usage->rankNbr++;
+	}
+	else
+	{
+		for(_pos = _usage->rankNbr; FF_PROFILE_Usage_Is_Recent(_usage->rank[_pos - 1U]); _pos--){}
+		_record = &_usage->record[_usage->rank[_pos - 1U]];
+	}
+
+	_record->dataIdx = _entryIdx;
+	_record->urlHash = _urlHash;
+	_record->count = 0U;
+	_record->stamp = 0U;
+
+	/* The reused record keeps its place in the lists, the sort moves it */
+	FF_PROFILE_Usage_Sort(_usage->entry, _usage->rankNbr, 0U);
+	PROFILE.stats.usageNbr = _usage->rankNbr;
+
+	return _record;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile count a use of a usage record and move it up the usage lists
+  * @param Usage record (profile_usage_record_ts*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Usage_Touch(profile_usage_record_ts* _record)
+{
+	profile_usage_ts* _usage = &PROFILE.usage;
+	uint8_t _pos;
+
+	if(_record->count < 0xFFFFU){_record->count++;}
+	_record->stamp = ++_usage->clock;
+
+	if(!_usage->pendingFlag[_record->recordIdx])
+	{
+		_usage->pendingFlag[_record->recordIdx] = 1U;
+		_usage->pendingNbr++;
+	}
+
+	for(_pos = 0U; (_pos < _usage->recentNbr) && (_record->recordIdx != _usage->recent[_pos]); _pos++){}
+
+	if(_pos == _usage->recentNbr)
+	{
+		if(_usage->recentNbr < FF_PROFILE_USAGE_RECENT){_usage->recentNbr++;}
+		_pos = _usage->recentNbr - 1U;
+	}
+
+	for(; _pos > 0U; _pos--){_usage->recent[_pos] = _usage->recent[_pos - 1U];}
+	_usage->recent[0] = _record->recordIdx;
+
+	FF_PROFILE_Usage_Sort(_usage->rank, _usage->rankNbr, 1U);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile check if a usage record is one of the last uses
+  * @param Record index (uint8_t)
+  * @retval Recent flag (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Usage_Is_Recent(uint8_t _recordIdx)
+{
+	for(uint8_t _idx = 0U; _idx < PROFILE.usage.recentNbr; _idx++){if(_recordIdx == PROFILE.usage.recent[_idx]){return 1U;}}
+
+	return 0U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile map a usage order position to the vault entry. The last uses come first, then the other used entries by
+  *        use count and the unused entries in vault order.
+  * @param Usage order data index (uint16_t)
+  * @retval Entry index (uint16_t)
+  ***************************************************************************************************************************************
+  */
+static uint16_t FF_PROFILE_Recent_Entry(uint16_t _dataIdx)
+{
+	const profile_usage_ts* _usage = &PROFILE.usage;
+
+	if(_dataIdx < _usage->recentNbr){return _usage->record[_usage->recent[_dataIdx]].dataIdx;}
+	_dataIdx -= _usage->recentNbr;
+
+	if(_dataIdx < (_usage->rankNbr - _usage->recentNbr))
+	{
+		for(uint8_t _idx = 0U; _idx < _usage->rankNbr; _idx++)
+		{
+			if(FF_PROFILE_Usage_Is_Recent(_usage->rank[_idx])){continue;}
+			if(0U == _dataIdx){return _usage->record[_usage->rank[_idx]].dataIdx;}
+			_dataIdx--;
+		}
+	}
+
+	/* Skip the used entries at or below the position */
+	_dataIdx -= (_usage->rankNbr - _usage->recentNbr);
+	for(uint8_t _idx = 0U; (_idx < _usage->rankNbr) && (_usage->record[_usage->entry[_idx]].dataIdx <= _dataIdx); _idx++){_dataIdx++;}
+
+	return _dataIdx;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile find the usage order position of a vault entry
+  * @param Entry index (uint16_t)
+  * @retval Usage order data index (uint16_t)
+  ***************************************************************************************************************************************
+  */
+static uint16_t FF_PROFILE_Recent_Position(uint16_t _entryIdx)
+{
+	const profile_usage_ts* _usage = &PROFILE.usage;
+	const profile_usage_record_ts* _record = FF_PROFILE_Usage_Find(_entryIdx);
+	uint16_t _dataIdx = _usage->recentNbr;
+
+	if(NULL != _record)
+	{
+		for(uint8_t _idx = 0U; _idx < _usage->recentNbr; _idx++){if(_record->recordIdx == _usage->recent[_idx]){return _idx;}}
+
+		for(uint8_t _idx = 0U; _usage->rank[_idx] != _record->recordIdx; _idx++)
+		{
+			if(!FF_PROFILE_Usage_Is_Recent(_usage->rank[_idx])){_dataIdx++;}
+		}
+
+		return _dataIdx;
+	}
+
+	_dataIdx = _usage->rankNbr + _entryIdx;
+	for(uint8_t _idx = 0U; (_idx < _usage->rankNbr) && (_usage->record[_usage->entry[_idx]].dataIdx < _entryIdx); _idx++){_dataIdx--;}
+
+	return _dataIdx;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile map a list position of the selected order to the vault entry
+  * @param Data index (uint16_t)
+  * @retval Entry index (uint16_t)
+  ***************************************************************************************************************************************
+  */
+static uint16_t FF_PROFILE_Get_Entry(uint16_t _dataIdx)
+{
+	switch(PROFILE.order)
+	{
+		case(FF_PROFILE_ORDER_URL): return FF_PROFILE_Sorted_Entry(_dataIdx);
+		case(FF_PROFILE_ORDER_RECENT): return FF_PROFILE_Recent_Entry(_dataIdx);
+		default: return _dataIdx;
+	}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile hash the URL of a vault entry
+  * @param Entry index (uint16_t)
+  * @retval URL hash (uint32_t)
+  ***************************************************************************************************************************************
+  */
+static uint32_t FF_PROFILE_Entry_Hash(uint16_t _entryIdx)
+{
+	uint8_t _url[FF_PROFILE_URL_SIZE + 1U];
+	uint16_t _recordSize;
+	uint32_t _offset = FF_PROFILE_Locate_Entry(_entryIdx, &_recordSize);
+
+	/* urlSize, url */
+	if(_recordSize > sizeof(_url)){_recordSize = sizeof(_url);}
+	FF_PROFILE_Read_Image(_offset, _url, _recordSize);
+	if(_url[0] >= _recordSize){BSP_Error_Handler();}
+
+	return FF_PROFILE_Url_Hash(&_url[1], _url[0]);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile URL hash, FNV-1a
+  * @param URL (const uint8_t*), URL size (uint8_t)
+  * @retval URL hash (uint32_t)
+  ***************************************************************************************************************************************
+  */
+static uint32_t FF_PROFILE_Url_Hash(const uint8_t* _url, uint8_t _size)
+{
+	uint32_t _hash = 2166136261UL;
+
+	for(uint8_t _idx = 0U; _idx < _size; _idx++){_hash = (_hash ^ _url[_idx]) * 16777619UL;}
+
+	return _hash;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile hardware CRC unit initialization
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_CRC_Init(void)
+{
+	__HAL_RCC_CRC_CLK_ENABLE();
+
+	PROFILE.crc.Instance = CRC;
+	PROFILE.crc.Init.DefaultPolynomialUse = DEFAULT_POLYNOMIAL_ENABLE;
+	PROFILE.crc.Init.DefaultInitValueUse = DEFAULT_INIT_VALUE_ENABLE;
+	PROFILE.crc.Init.InputDataInversionMode = CRC_INPUTDATA_INVERSION_BYTE;
+	PROFILE.crc.Init.OutputDataInversionMode = CRC_OUTPUTDATA_INVERSION_ENABLE;
+	PROFILE.crc.InputDataFormat = CRC_INPUTDATA_FORMAT_BYTES;
+
+	if(HAL_OK != HAL_CRC_Init(&PROFILE.crc)){BSP_Error_Handler();}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile open data.bin once its CRC is checked, the source table tells which sources are still up to date
+  * @param None
+  * @retval Image up to date (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Open_Image(void)
+{
+	const profile_image_header_ts* _header = &PROFILE.load.header;
+	profile_source_ts _source;
+	uint8_t _matchNbr = 0U;
+	UINT _bytesRead;
+
+	if((_header->crc == PROFILE.load.reader.crc) && (FF_PROFILE_Load_Pool(_header)) && (FR_OK == f_lseek(&PROFILE.imageFile, sizeof(profile_image_header_ts))))
+	{
+		/* The image is valid only for the sources it was compiled from, in the same order */
+		for(uint16_t _idx = 0U; _idx < _header->sourceNbr; _idx++)
+		{
+			if((FR_OK != FF_PROFILE_Read_File(&PROFILE.imageFile, &_source, sizeof(_source), &_bytesRead)) || (sizeof(_source) != _bytesRead) || \
+			   ((_source.imageIdx + _source.dataNbr) > _header->dataNbr)){break;}
+
+			for(uint8_t _sourceIdx = 0U; _sourceIdx < PROFILE.sourceNbr; _sourceIdx++)
+			{
+				if((0 == strncmp(_source.path, PROFILE.source[_sourceIdx].path, FF_PROFILE_PATH_SIZE)) && \
+				   (_source.size == PROFILE.source[_sourceIdx].size) && (_source.time == PROFILE.source[_sourceIdx].time))
+				{
+					PROFILE.source[_sourceIdx].dataNbr = _source.dataNbr;
+					PROFILE.source[_sourceIdx].imageIdx = _source.imageIdx;
+					if(_sourceIdx == _idx){_matchNbr++;}
+					break;
+				}
+			}
+		}
+
+		/* The compile copies the unchanged sources through the offset table of this image */
+		PROFILE.dataNbr = _header->dataNbr;
+		PROFILE.offsetTable = sizeof(profile_image_header_ts) + (_header->sourceNbr * sizeof(profile_source_ts)) + _header->poolSize;
+		PROFILE.indexOffset = _header->indexOffset;
+
+		if((PROFILE.sourceNbr == _header->sourceNbr) && (PROFILE.sourceNbr == _matchNbr) && \
+		   (FR_OK == f_lseek(&PROFILE.imageFile, (_header->indexOffset + (_header->dataNbr * sizeof(uint16_t))))) && \
+		   (FR_OK == FF_PROFILE_Read_File(&PROFILE.imageFile, PROFILE.groupStart, sizeof(PROFILE.groupStart), &_bytesRead)) && \
+		   (sizeof(PROFILE.groupStart) == _bytesRead) && (FF_PROFILE_Load_Dict(_header)))
+		{
+			/* Cluster link map for O(1) seeks, a fragmented image just falls back to the FAT chain */
+			PROFILE.imageMap = NULL;
+			PROFILE.imageClmt[0] = FF_PROFILE_CLMT_SIZE;
+			PROFILE.imageFile.cltbl = PROFILE.imageClmt;
+			if(FR_OK != f_lseek(&PROFILE.imageFile, CREATE_LINKMAP)){PROFILE.imageFile.cltbl = NULL;}
+			/* A single fragment {size, clusters, first cluster, 0} is read through the memory-mapped QSPI window
+			   when the FTL kept its sectors contiguous as well */
+			else if(4U == PROFILE.imageClmt[0])
+			{
+				PROFILE.imageMap = DISKIO_Map_Sectors((PROFILE.ffFs.database + ((PROFILE.imageClmt[2] - 2U) * PROFILE.ffFs.csize)), \
+													  (PROFILE.imageClmt[1] * PROFILE.ffFs.csize));
+			}
+
+			return 1U;
+		}
+
+		/* Outdated image, it stays open for the compile */
+		return 0U;
+	}
+
+	PROFILE.dataNbr = 0U;
+	PROFILE.poolNbr = 0U;
+	PROFILE.poolLen = 0U;
+	f_close(&PROFILE.imageFile);
+
+	return 0U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile load the string pool of data.bin into RAM and index its entries
+  * @param Image header (const profile_image_header_ts*)
+  * @retval Status (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Load_Pool(const profile_image_header_ts* _header)
+{
+	uint16_t _idx = 0U;
+	UINT _bytesRead;
+
+	if((FR_OK != f_lseek(&PROFILE.imageFile, (sizeof(profile_image_header_ts) + (_header->sourceNbr * sizeof(profile_source_ts))))) || \
+	   (FR_OK != FF_PROFILE_Read_File(&PROFILE.imageFile, PROFILE.pool, _header->poolSize, &_bytesRead)) || (_header->poolSize != _bytesRead))
+	{return 0U;}
+
+	/* size, data, 0 */
+	for(PROFILE.poolNbr = 0U; _idx < _header->poolSize; PROFILE.poolNbr++)
+	{
+		if((PROFILE.poolNbr >= FF_PROFILE_POOL_NBR) || (PROFILE.pool[_idx] >= FF_PROFILE_FIELD_SIZE) || \
+		   ((_idx + PROFILE.pool[_idx] + 2U) > _header->poolSize) || (0U != PROFILE.pool[_idx + PROFILE.pool[_idx] + 1U])){return 0U;}
+
+		PROFILE.poolOffset[PROFILE.poolNbr] = _idx;
+		_idx += PROFILE.pool[_idx] + 2U;
+	}
+
+	PROFILE.poolLen = _header->poolSize;
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile load the dictionary of data.bin into RAM and index its words, the image is positioned behind the group table
+  * @param Image header (const profile_image_header_ts*)
+  * @retval Status (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Load_Dict(const profile_image_header_ts* _header)
+{
+	uint16_t _idx = 0U;
+	UINT _bytesRead;
+
+	if((_header->dictSize > FF_PROFILE_DICT_SIZE) || (_header->dictNbr > FF_PROFILE_DICT_NBR) || \
+	   (FR_OK != FF_PROFILE_Read_File(&PROFILE.imageFile, PROFILE.dict, _header->dictSize, &_bytesRead)) || (_header->dictSize != _bytesRead))
+	{return 0U;}
+
+	/* size, word */
+	while(_idx < _header->dictSize)
+	{
+		if((PROFILE.dictNbr >= _header->dictNbr) || (PROFILE.dict[_idx] < FF_PROFILE_DICT_MIN) || (PROFILE.dict[_idx] > FF_PROFILE_DICT_WORD_SIZE) || \
+		   ((_idx + PROFILE.dict[_idx] + 1U) > _header->dictSize))
+		{
+			PROFILE.dictNbr = 0U;
+			return 0U;
+		}
+
+		PROFILE.dictOffset[PROFILE.dictNbr++] = _idx;
+		_idx += PROFILE.dict[_idx] + 1U;
+	}
+
+	if(PROFILE.dictNbr != _header->dictNbr)
+	{
+		PROFILE.dictNbr = 0U;
+		return 0U;
+	}
+
+	PROFILE.stats.dictSize = _header->dictSize;
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile restart the string pool for a compile pass, both passes have to make the same pooling decisions
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Reset_Pool(void)
+{
+	PROFILE.poolNbr = PROFILE.poolBaseNbr;
+	PROFILE.poolLen = PROFILE.poolBaseLen;
+	PROFILE.poolCandidateIdx = 0U;
+	memset(PROFILE.poolCandidate, 0, sizeof(PROFILE.poolCandidate));
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile look up a field value in the string pool, a value seen for the second time is added while the pool has room
+  * @param Name code (uint8_t), value (const uint8_t*), value size (uint8_t)
+  * @retval Pool index or FF_PROFILE_NO_POOL for an inline value (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Intern_Value(uint8_t _code, const uint8_t* _value, uint8_t _size)
+{
+	uint32_t _hash = 2166136261UL ^ _code;
+	uint8_t _idx;
+
+	if((0U == (FF_PROFILE_POOL_FIELDS & (1U << _code))) || (0U == _size)){return FF_PROFILE_NO_POOL;}
+
+	for(_idx = 0U; _idx < PROFILE.poolNbr; _idx++)
+	{
+		if((_size == PROFILE.pool[PROFILE.poolOffset[_idx]]) && (0 == memcmp(&PROFILE.pool[PROFILE.poolOffset[_idx] + 1U], _value, _size))){return _idx;}
+	}
+
+	if((PROFILE.poolNbr >= FF_PROFILE_POOL_NBR) || ((PROFILE.poolLen + _size + 2U) > FF_PROFILE_POOL_SIZE)){return FF_PROFILE_NO_POOL;}
+
+	/* FNV-1a, a collision only pools a value that occurs once */
+	for(_idx = 0U; _idx < _size; _idx++){_hash = (_hash ^ _value[_idx]) * 16777619UL;}
+	if(0U == _hash){_hash = 1U;}
+
+	for(_idx = 0U; _idx < FF_PROFILE_POOL_CANDIDATES; _idx++){if(_hash == PROFILE.poolCandidate[_idx]){break;}}
+
+	if(FF_PROFILE_POOL_CANDIDATES == _idx)
+	{
+		PROFILE.poolCandidate[PROFILE.poolCandidateIdx] = _hash;
+		PROFILE.poolCandidateIdx = (PROFILE.poolCandidateIdx + 1U) % FF_PROFILE_POOL_CANDIDATES;
+		return FF_PROFILE_NO_POOL;
+	}
+
+	PROFILE.poolOffset[PROFILE.poolNbr] = PROFILE.poolLen;
+	PROFILE.pool[PROFILE.poolLen] = _size;
+	memcpy(&PROFILE.pool[PROFILE.poolLen + 1U], _value, _size);
+	PROFILE.pool[PROFILE.poolLen + _size + 1U] = 0U;
+	PROFILE.poolLen += _size + 2U;
+
+	return PROFILE.poolNbr++;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile start the compile of the vault sources into a new data.bin, unchanged sources are copied from the previous image
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Compile_Start(void)
+{
+	profile_load_ts* _load = &PROFILE.load;
+
+	if(FR_OK != f_open(&PROFILE.buildFile, FF_PROFILE_BUILD_FNAME, (FA_CREATE_ALWAYS | FA_WRITE))){BSP_Error_Handler();}
+
+	memset(&_load->header, 0, sizeof(_load->header));
+	memset(&_load->writer, 0, sizeof(_load->writer));
+	memset(_load->dict, 0, sizeof(_load->dict));
+	_load->writer.file = &PROFILE.buildFile;
+	_load->writer.status = (FR_OK == f_open(&PROFILE.sortFile, FF_PROFILE_SORT_FNAME, (FA_CREATE_ALWAYS | FA_READ | FA_WRITE)));
+	_load->recordsLen = 0U;
+	_load->dataIdx = 0U;
+	_load->recordIdx = 0U;
+	_load->sourceIdx = 0U;
+	_load->sourceOpenFlag = 0U;
+	PROFILE.stats.compileFlag = 1U;
+
+	/* The copied records keep their pool indexes, the pool of the previous image is only extended then */
+	PROFILE.poolBaseNbr = 0U;
+	PROFILE.poolBaseLen = 0U;
+
+	for(uint8_t _idx = 0U; _idx < PROFILE.sourceNbr; _idx++)
+	{
+		if(FF_PROFILE_NO_DATA != PROFILE.source[_idx].imageIdx)
+		{
+			PROFILE.poolBaseNbr = PROFILE.poolNbr;
+			PROFILE.poolBaseLen = PROFILE.poolLen;
+			break;
+		}
+	}
+
+	FF_PROFILE_Reset_Pool();
+
+	/* The first pass parks the record offsets in sort.tmp, relative to the first record */
+	_load->state = FF_PROFILE_LOAD_OFFSETS;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile compile step of the offset pass, the header placeholder, the source table and the pool follow the last source
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Offsets_Step(void)
+{
+	profile_load_ts* _load = &PROFILE.load;
+	profile_image_header_ts* _header = &_load->header;
+	profile_source_ts* _source = &PROFILE.source[_load->sourceIdx];
+	uint16_t _dataIdx = 0U;
+	UINT _bytes;
+
+	if(!FF_PROFILE_Source_Step(0U)){return;}
+
+	if((_header->dataNbr + _source->dataNbr) > FF_PROFILE_MAX_DATA){BSP_Error_Handler();}
+	_header->dataNbr += _source->dataNbr;
+	_load->recordIdx = 0U;
+	if(++_load->sourceIdx < PROFILE.sourceNbr){return;}
+
+	_header->sourceNbr = PROFILE.sourceNbr;
+	_header->poolSize = PROFILE.poolLen;
+	_load->recordsStart = sizeof(profile_image_header_ts) + (PROFILE.sourceNbr * sizeof(profile_source_ts)) + _header->poolSize + (_header->dataNbr * sizeof(uint32_t));
+	_header->indexOffset = _load->recordsStart + _load->recordsLen;
+
+	/* Contiguous clusters let the open mode read the image through the memory-mapped QSPI window,
+	   a fragmented image is still read through FatFs. The dictionary is learned while the records are written,
+	   its largest size is allocated and the rest is truncated at the end. */
+	f_expand(&PROFILE.buildFile, (_header->indexOffset + (_header->dataNbr * sizeof(uint16_t)) + sizeof(PROFILE.groupStart) + FF_PROFILE_DICT_SIZE), 1U);
+
+	/* Header placeholder, it is completed once the CRC is known */
+	if((FR_OK != f_write(&PROFILE.buildFile, _header, sizeof(profile_image_header_ts), &_bytes)) || (sizeof(profile_image_header_ts) != _bytes))
+	{_load->writer.status = 0U;}
+	__HAL_CRC_DR_RESET(&PROFILE.crc);
+
+	/* Source table, the first entry of each source in the new image */
+	for(uint8_t _idx = 0U; _idx < PROFILE.sourceNbr; _idx++)
+	{
+		_source = &PROFILE.source[_idx];
+		memcpy(PROFILE.arena, _source, sizeof(profile_source_ts));
+		((profile_source_ts*)PROFILE.arena)->imageIdx = _dataIdx;
+		FF_PROFILE_Write_Bytes(&_load->writer, PROFILE.arena, sizeof(profile_source_ts));
+		_dataIdx += _source->dataNbr;
+	}
+
+	FF_PROFILE_Write_Bytes(&_load->writer, PROFILE.pool, _header->poolSize);
+
+	/* Offset table, the arena is free until the records pass */
+	if(FR_OK != f_lseek(&PROFILE.sortFile, 0U)){_load->writer.status = 0U;}
+	_load->tableLen = _header->dataNbr * sizeof(uint32_t);
+	_load->state = FF_PROFILE_LOAD_TABLES;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile compile step copying one arena of staged offsets from sort.tmp to the offset table
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Tables_Step(void)
+{
+	profile_load_ts* _load = &PROFILE.load;
+	UINT _bytes;
+
+	if(_load->tableLen)
+	{
+		if((FR_OK != FF_PROFILE_Read_File(&PROFILE.sortFile, PROFILE.arena, ((_load->tableLen < FF_PROFILE_ARENA_SIZE) ? _load->tableLen : FF_PROFILE_ARENA_SIZE), &_bytes)) || \
+		   (0U == _bytes))
+		{
+			_load->writer.status = 0U;
+			return;
+		}
+
+		for(uint32_t _idx = 0U; _idx < _bytes; _idx += sizeof(uint32_t)){*(uint32_t*)&PROFILE.arena[_idx] += _load->recordsStart;}
+		FF_PROFILE_Write_Bytes(&_load->writer, PROFILE.arena, _bytes);
+		_load->tableLen -= _bytes;
+		return;
+	}
+
+	/* The second pass writes the records, the sort keys take the place of the offsets in sort.tmp */
+	if(FR_OK != f_lseek(&PROFILE.sortFile, 0U)){_load->writer.status = 0U;}
+	FF_PROFILE_Reset_Pool();
+	_load->dataIdx = 0U;
+	_load->recordIdx = 0U;
+	_load->sourceIdx = 0U;
+	_load->state = FF_PROFILE_LOAD_RECORDS;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile compile step of the records pass
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Records_Step(void)
+{
+	profile_load_ts* _load = &PROFILE.load;
+
+	if(!FF_PROFILE_Source_Step(1U)){return;}
+
+	_load->dataIdx += PROFILE.source[_load->sourceIdx].dataNbr;
+	_load->recordIdx = 0U;
+	if(++_load->sourceIdx >= PROFILE.sourceNbr){_load->state = FF_PROFILE_LOAD_INDEX;}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile compile up to FF_PROFILE_STEP_RECORDS records of the current source in the offset or the records pass.
+  *        Unchanged sources are copied from the previous image, the others are parsed.
+  * @param Records pass flag (uint8_t)
+  * @retval Source done (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Source_Step(uint8_t _recordsFlag)
+{
+	profile_load_ts* _load = &PROFILE.load;
+	profile_source_ts* _source = &PROFILE.source[_load->sourceIdx];
+	uint8_t _token[FF_PROFILE_TOKEN_SIZE];
+	uint16_t _tokenLen;
+	uint16_t _recordSize;
+	uint32_t _offset;
+
+	if(FF_PROFILE_NO_DATA != _source->imageIdx)
+	{
+		for(uint8_t _idx = 0U; (_idx < FF_PROFILE_STEP_RECORDS) && (_load->recordIdx < _source->dataNbr); _idx++, _load->recordIdx++)
+		{
+			_offset = FF_PROFILE_Locate_Data((_source->imageIdx + _load->recordIdx), &_recordSize);
+			if(_recordsFlag){FF_PROFILE_Read_Image(_offset, PROFILE.arena, _recordSize);}
+			FF_PROFILE_Emit_Record(_recordsFlag, (_load->dataIdx + _load->recordIdx), _recordSize);
+		}
+
+		return (_load->recordIdx >= _source->dataNbr);
+	}
+
+	if(!_load->sourceOpenFlag)
+	{
+		if(FR_OK != f_open(&PROFILE.dataFile, _source->path, FA_READ)){BSP_Error_Handler();}
+
+		memset(&_load->reader, 0, sizeof(_load->reader));
+		memset(&_load->parser, 0, sizeof(_load->parser));
+		_load->reader.file = &PROFILE.dataFile;
+		_load->reader.buffer = PROFILE.ffBuffer;
+		_load->reader.bufferSize = DISKIO_BLK_SIZ;
+		_load->parser.state = FF_PROFILE_PARSE_COUNT;
+		_load->sourceOpenFlag = 1U;
+	}
+
+	/* One sector per f_read, the empty arena is only a scratch buffer while compiling */
+	for(uint8_t _idx = 0U; (_idx < FF_PROFILE_STEP_RECORDS) && (FF_PROFILE_PARSE_DONE != _load->parser.state);)
+	{
+		if(!FF_PROFILE_Read_Token(&_load->reader, _token, sizeof(_token), &_tokenLen))
+		{
+			/* A source without the count token, like the empty data.txt of a format, holds no entries */
+			if(FF_PROFILE_PARSE_COUNT != _load->parser.state){BSP_Error_Handler();}
+			_load->parser.state = FF_PROFILE_PARSE_DONE;
+			break;
+		}
+
+		if(FF_PROFILE_Parse_Token(&_load->parser, PROFILE.arena, _token, _tokenLen))
+		{
+			FF_PROFILE_Emit_Record(_recordsFlag, (_load->dataIdx + _load->parser.dataIdx - 1U), _load->parser.recordLen);
+			_idx++;
+		}
+	}
+
+	if(FF_PROFILE_PARSE_DONE != _load->parser.state){return 0U;}
+
+	f_close(&PROFILE.dataFile);
+	_load->sourceOpenFlag = 0U;
+
+	if(_recordsFlag)
+	{
+		if(_source->dataNbr != _load->parser.dataNbr){_load->writer.status = 0U;}
+		PROFILE.stats.poolRefNbr += _load->parser.poolRefNbr;
+		PROFILE.stats.poolSaved += _load->parser.poolSaved;
+	}
+	else
+	{
+		_source->dataNbr = _load->parser.dataNbr;
+		PROFILE.stats.parseNbr++;
+	}
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile emit the record held in the arena, the offset pass stages its offset in sort.tmp and the records pass writes it
+  *        with its sort key
+  * @param Records pass flag (uint8_t), data index (uint16_t), record size (uint16_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Emit_Record(uint8_t _recordsFlag, uint16_t _dataIdx, uint16_t _recordSize)
+{
+	profile_load_ts* _load = &PROFILE.load;
+	profile_sort_key_ts _key;
+	UINT _bytesWritten;
+
+	if(_recordsFlag)
+	{
+		FF_PROFILE_Write_Bytes(&_load->writer, PROFILE.arena, _recordSize);
+
+		/* Sort key of the entry, the keys are sorted once all records are written */
+		FF_PROFILE_Sort_Key(PROFILE.arena, _dataIdx, &_key);
+		if((FR_OK != f_write(&PROFILE.sortFile, &_key, sizeof(_key), &_bytesWritten)) || (sizeof(_key) != _bytesWritten)){_load->writer.status = 0U;}
+		FF_PROFILE_Learn_Url(_load->dict, PROFILE.arena);
+	}
+	else
+	{
+		if((FR_OK != f_write(&PROFILE.sortFile, &_load->recordsLen, sizeof(uint32_t), &_bytesWritten)) || (sizeof(uint32_t) != _bytesWritten))
+		{_load->writer.status = 0U;}
+		_load->recordsLen += _recordSize;
+	}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile last compile step, sorts the index and replaces data.bin by the complete build, the new image is checked next.
+  *        The sort is the only step not bounded by FF_PROFILE_STEP_RECORDS.
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Finish_Image(void)
+{
+	profile_load_ts* _load = &PROFILE.load;
+	profile_image_header_ts* _header = &_load->header;
+	UINT _bytes;
+
+	if(_load->sourceOpenFlag)
+	{
+		f_close(&PROFILE.dataFile);
+		_load->sourceOpenFlag = 0U;
+	}
+
+	if((_header->indexOffset != f_tell(&PROFILE.buildFile)) || (_header->poolSize != PROFILE.poolLen)){_load->writer.status = 0U;}
+
+	FF_PROFILE_Sort_Index(&_load->writer, _header->dataNbr);
+	FF_PROFILE_Write_Dict(&_load->writer, _header);
+
+	f_close(&PROFILE.sortFile);
+	f_unlink(FF_PROFILE_SORT_FNAME);
+	f_close(&PROFILE.imageFile);
+
+	_header->magic = FF_PROFILE_IMAGE_MAGIC;
+	_header->version = FF_PROFILE_IMAGE_VERSION;
+	_header->imageSize = f_tell(&PROFILE.buildFile) - sizeof(profile_image_header_ts);
+	_header->crc = _load->writer.crc;
+
+	if((_load->writer.status) && (FR_OK == f_truncate(&PROFILE.buildFile)) && (FR_OK == f_lseek(&PROFILE.buildFile, 0U)))
+	{
+		_load->writer.status = ((FR_OK == f_write(&PROFILE.buildFile, _header, sizeof(profile_image_header_ts), &_bytes)) && \
+								(sizeof(profile_image_header_ts) == _bytes));
+	}else{_load->writer.status = 0U;}
+
+	f_close(&PROFILE.buildFile);
+
+	/* The previous image is replaced only by a complete one, a broken build is parsed again on the next boot */
+	if(_load->writer.status){f_unlink(FF_PROFILE_IMAGE_FNAME);}
+
+	if((_load->writer.status) && (FR_OK == f_rename(FF_PROFILE_BUILD_FNAME, FF_PROFILE_IMAGE_FNAME))){f_chmod(FF_PROFILE_IMAGE_FNAME, AM_HID, AM_HID);}
+	else{f_unlink(FF_PROFILE_BUILD_FNAME);}
+
+	if(FF_PROFILE_Check_Image()){_load->state = FF_PROFILE_LOAD_CHECK;}
+	else{BSP_Error_Handler();}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile count the dictionary candidates of a record URL: the scheme with "www.", the domain labels and the path segments
+  * @param Dictionary candidates (profile_dict_word_ts*), record (const uint8_t*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Learn_Url(profile_dict_word_ts* _dict, const uint8_t* _record)
+{
+	const uint8_t* _url = &_record[1];
+	uint8_t _urlSize = _record[0];
+	uint8_t _start = 0U;
+	uint8_t _idx;
+
+	for(_idx = 0U; (_idx + 3U) <= _urlSize; _idx++){if(0 == memcmp(&_url[_idx], "://", 3U)){break;}}
+
+	if((_idx + 3U) <= _urlSize)
+	{
+		_start = _idx + 3U;
+		if(((_start + 4U) <= _urlSize) && (0 == memcmp(&_url[_start], "www.", 4U))){_start += 4U;}
+		FF_PROFILE_Learn_Word(_dict, _url, _start);
+	}
+
+	/* Each word keeps its leading separator */
+	for(_idx = (_start + 1U); _idx <= _urlSize; _idx++)
+	{
+		if((_idx == _urlSize) || ('.' == _url[_idx]) || ('/' == _url[_idx]) || ('?' == _url[_idx]) || (':' == _url[_idx]))
+		{
+			FF_PROFILE_Learn_Word(_dict, &_url[_start], (_idx - _start));
+			_start = _idx;
+		}
+	}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile count a dictionary candidate, all counts drop by one when the word is new and no slot is free
+  * @param Dictionary candidates (profile_dict_word_ts*), word (const uint8_t*), word size (uint8_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Learn_Word(profile_dict_word_ts* _dict, const uint8_t* _word, uint8_t _size)
+{
+	profile_dict_word_ts* _free = NULL;
+
+	if((_size < FF_PROFILE_DICT_MIN) || (_size > FF_PROFILE_DICT_WORD_SIZE)){return;}
+
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_DICT_NBR; _idx++)
+	{
+		if((_dict[_idx].count) && (_size == _dict[_idx].size) && (0 == memcmp(_dict[_idx].word, _word, _size)))
+		{
+			if(_dict[_idx].count < 0xFFFFU){_dict[_idx].count++;}
+			return;
+		}
+
+		if((0U == _dict[_idx].count) && (NULL == _free)){_free = &_dict[_idx];}
+	}
+
+	if(NULL != _free)
+	{
+		memcpy(_free->word, _word, _size);
+		_free->size = _size;
+		_free->count = 1U;
+	}
+	else{for(uint8_t _idx = 0U; _idx < FF_PROFILE_DICT_NBR; _idx++){_dict[_idx].count--;}}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile write the dictionary behind the group table, a word seen once would not save anything
+  * @param Writer handle (profile_writer_ts*), image header (profile_image_header_ts*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Write_Dict(profile_writer_ts* _writer, profile_image_header_ts* _header)
+{
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_DICT_NBR; _idx++)
+	{
+		if(PROFILE.load.dict[_idx].count < 2U){continue;}
+
+		FF_PROFILE_Write_Bytes(_writer, &PROFILE.load.dict[_idx].size, 1U);
+		FF_PROFILE_Write_Bytes(_writer, PROFILE.load.dict[_idx].word, PROFILE.load.dict[_idx].size);
+		_header->dictSize += PROFILE.load.dict[_idx].size + 1U;
+		_header->dictNbr++;
+	}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile build the sort key of a packed record
+  * @param Record (const uint8_t*), data index (uint16_t), sort key (profile_sort_key_ts*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Sort_Key(const uint8_t* _record, uint16_t _dataIdx, profile_sort_key_ts* _key)
+{
+	const uint8_t* _url = &_record[1];
+	uint8_t _urlSize = _record[0];
+
+	/* Scheme and "www." do not count for the ordering */
+	for(uint8_t _idx = 0U; _idx < (sizeof(FF_PROFILE_SORT_SKIP) / sizeof(FF_PROFILE_SORT_SKIP[0])); _idx++)
+	{
+		uint8_t _skipLen = (uint8_t)strlen(FF_PROFILE_SORT_SKIP[_idx]);
+		uint8_t _charIdx = 0U;
+
+		while((_charIdx < _skipLen) && (_charIdx < _urlSize) && (tolower(_url[_charIdx]) == FF_PROFILE_SORT_SKIP[_idx][_charIdx])){_charIdx++;}
+		if((_skipLen == _charIdx) && (_urlSize > _skipLen)){_url += _skipLen; _urlSize -= _skipLen;}
+	}
+
+	memset(_key, 0, sizeof(profile_sort_key_ts));
+	_key->dataIdx = _dataIdx;
+
+	for(uint8_t _idx = 0U; (_idx < _urlSize) && (_idx < (FF_PROFILE_SORT_KEY_SIZE - 1U)); _idx++)
+	{
+		_key->key[_idx + 1U] = (uint8_t)tolower(_url[_idx]);
+	}
+
+	if((_key->key[1] >= 'a') && (_key->key[1] <= 'z')){_key->key[0] = _key->key[1] - 'a' + 1U;}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile sort key compare, equal keys keep the vault order
+  * @param Sort keys (const void*)
+  * @retval Compare result (int)
+  ***************************************************************************************************************************************
+  */
+static int FF_PROFILE_Sort_Compare(const void* _keyA, const void* _keyB)
+{
+	const profile_sort_key_ts* _a = (const profile_sort_key_ts*)_keyA;
+	const profile_sort_key_ts* _b = (const profile_sort_key_ts*)_keyB;
+	int _res = memcmp(_a->key, _b->key, FF_PROFILE_SORT_KEY_SIZE);
+
+	if(0 == _res){_res = (int)_a->dataIdx - (int)_b->dataIdx;}
+
+	return _res;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile read or write sort keys of sort.tmp
+  * @param Key position (uint32_t), keys (profile_sort_key_ts*), key number (uint16_t), write flag (uint8_t)
+  * @retval Status (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Sort_Access(uint32_t _keyPos, profile_sort_key_ts* _keys, uint16_t _keyNbr, uint8_t _writeFlag)
+{
+	UINT _bytes;
+	FRESULT _res = f_lseek(&PROFILE.sortFile, (_keyPos * sizeof(profile_sort_key_ts)));
+
+	if(FR_OK == _res)
+	{
+		if(_writeFlag){_res = f_write(&PROFILE.sortFile, _keys, (_keyNbr * sizeof(profile_sort_key_ts)), &_bytes);}
+		else{_res = FF_PROFILE_Read_File(&PROFILE.sortFile, _keys, (_keyNbr * sizeof(profile_sort_key_ts)), &_bytes);}
+	}
+
+	return ((FR_OK == _res) && ((_keyNbr * sizeof(profile_sort_key_ts)) == _bytes));
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile get the current key of a sorted run, the run buffer is refilled on demand
+  * @param Sorted run (profile_sort_run_ts*)
+  * @retval Sort key (profile_sort_key_ts*, NULL at the end of the run)
+  ***************************************************************************************************************************************
+  */
+static profile_sort_key_ts* FF_PROFILE_Sort_Run_Key(profile_sort_run_ts* _run)
+{
+	if(_run->bufferIdx == _run->bufferLen)
+	{
+		if(_run->pos == _run->end){return NULL;}
+
+		_run->bufferLen = ((_run->end - _run->pos) < _run->bufferSize) ? (uint16_t)(_run->end - _run->pos) : _run->bufferSize;
+		_run->bufferIdx = 0U;
+		if(!FF_PROFILE_Sort_Access(_run->pos, _run->buffer, _run->bufferLen, 0U)){BSP_Error_Handler();}
+		_run->pos += _run->bufferLen;
+	}
+
+	return &_run->buffer[_run->bufferIdx];
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile merge two sorted runs of sort.tmp, the work buffer is split between the inputs and the output
+  * @param Run A start (uint32_t), run B start (uint32_t), run B end (uint32_t), output start (uint32_t)
+  * @retval Status (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Sort_Merge(uint32_t _startA, uint32_t _startB, uint32_t _endB, uint32_t _dst)
+{
+	const uint16_t _quarter = (DISKIO_BLK_SIZ / sizeof(profile_sort_key_ts)) / 4U;
+	profile_sort_key_ts* _out = &((profile_sort_key_ts*)PROFILE.ffBuffer)[2U * _quarter];
+	profile_sort_run_ts _runA = { _startA, _startB, (profile_sort_key_ts*)PROFILE.ffBuffer, _quarter, 0U, 0U };
+	profile_sort_run_ts _runB = { _startB, _endB, &((profile_sort_key_ts*)PROFILE.ffBuffer)[_quarter], _quarter, 0U, 0U };
+	profile_sort_key_ts* _keyA = FF_PROFILE_Sort_Run_Key(&_runA);
+	profile_sort_key_ts* _keyB = FF_PROFILE_Sort_Run_Key(&_runB);
+	uint16_t _outLen = 0U;
+
+	while((NULL != _keyA) || (NULL != _keyB))
+	{
+		if((NULL == _keyB) || ((NULL != _keyA) && (FF_PROFILE_Sort_Compare(_keyA, _keyB) <= 0)))
+		{
+			_out[_outLen++] = *_keyA;
+			_runA.bufferIdx++;
+			_keyA = FF_PROFILE_Sort_Run_Key(&_runA);
+		}
+		else
+		{
+			_out[_outLen++] = *_keyB;
+			_runB.bufferIdx++;
+			_keyB = FF_PROFILE_Sort_Run_Key(&_runB);
+		}
+
+		if(((2U * _quarter) == _outLen) || ((NULL == _keyA) && (NULL == _keyB)))
+		{
+			if(!FF_PROFILE_Sort_Access(_dst, _out, _outLen, 1U)){return 0U;}
+			_dst += _outLen;
+			_outLen = 0U;
+		}
+	}
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile sort the keys of sort.tmp and append the sorted index and the letter group table to the image
+  * @param Writer handle (profile_writer_ts*), data number (uint16_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Sort_Index(profile_writer_ts* _writer, uint16_t _dataNbr)
+{
+	profile_sort_key_ts* _keys = (profile_sort_key_ts*)PROFILE.arena;
+	const uint16_t _runSize = FF_PROFILE_ARENA_SIZE / sizeof(profile_sort_key_ts);
+	uint16_t _groupStart[FF_PROFILE_GROUP_NBR + 1U];
+	uint32_t _src = 0U;
+	uint32_t _dst = _dataNbr;
+	uint32_t _tmp;
+	uint16_t _len;
+	uint8_t _group = 0U;
+
+	if(!_writer->status){return;}
+
+	/* Sorted runs of one arena each */
+	for(uint32_t _pos = 0U; _pos < _dataNbr; _pos += _len)
+	{
+		_len = ((_dataNbr - _pos) < _runSize) ? (uint16_t)(_dataNbr - _pos) : _runSize;
+		if(!FF_PROFILE_Sort_Access(_pos, _keys, _len, 0U)){_writer->status = 0U; return;}
+		qsort(_keys, _len, sizeof(profile_sort_key_ts), FF_PROFILE_Sort_Compare);
+		if(!FF_PROFILE_Sort_Access(_pos, _keys, _len, 1U)){_writer->status = 0U; return;}
+	}
+
+	/* Merge passes between the two halves of sort.tmp */
+	for(uint32_t _width = _runSize; _width < _dataNbr; _width *= 2U)
+	{
+		for(uint32_t _low = 0U; _low < _dataNbr; _low += (2U * _width))
+		{
+			uint32_t _mid = ((_low + _width) < _dataNbr) ? (_low + _width) : _dataNbr;
+			uint32_t _high = ((_low + (2U * _width)) < _dataNbr) ? (_low + (2U * _width)) : _dataNbr;
+			if(!FF_PROFILE_Sort_Merge((_src + _low), (_src + _mid), (_src + _high), (_dst + _low))){_writer->status = 0U; return;}
+		}
+
+		_tmp = _src;
+		_src = _dst;
+		_dst = _tmp;
+	}
+
+	/* Entry index per sorted position, the group starts fall out of the key order */
+	for(uint32_t _pos = 0U; _pos < _dataNbr; _pos += _len)
+	{
+		_len = ((_dataNbr - _pos) < _runSize) ? (uint16_t)(_dataNbr - _pos) : _runSize;
+		if(!FF_PROFILE_Sort_Access((_src + _pos), _keys, _len, 0U)){_writer->status = 0U; return;}
+
+		for(uint16_t _idx = 0U; _idx < _len; _idx++)
+		{
+			while(_group <= _keys[_idx].key[0]){_groupStart[_group++] = (uint16_t)(_pos + _idx);}
+			FF_PROFILE_Write_Bytes(_writer, (const uint8_t*)&_keys[_idx].dataIdx, sizeof(uint16_t));
+		}
+	}
+
+	while(_group <= FF_PROFILE_GROUP_NBR){_groupStart[_group++] = _dataNbr;}
+	FF_PROFILE_Write_Bytes(_writer, (const uint8_t*)_groupStart, sizeof(_groupStart));
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile read from data.bin, through the memory-mapped QSPI window when the image is contiguous
+  * @param Image offset (uint32_t), destination (void*), length (uint32_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Read_Image(uint32_t _offset, void* _dst, uint32_t _len)
+{
+	UINT _bytesRead;
+
+	if(NULL != PROFILE.imageMap)
+	{
+		/* FatFs accesses leave the memory-mapped mode, it is entered again on demand */
+		if(QSPI_OK != BSP_QSPI_EnableMemoryMappedMode()){BSP_Error_Handler();}
+		memcpy(_dst, &PROFILE.imageMap[_offset], _len);
+	}
+	else if((FR_OK != f_lseek(&PROFILE.imageFile, _offset)) || (FR_OK != FF_PROFILE_Read_File(&PROFILE.imageFile, _dst, _len, &_bytesRead)) || (_len != _bytesRead))
+	{BSP_Error_Handler();}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile locate a record in data.bin
+  * @param List position (uint16_t), record size (uint16_t*)
+  * @retval Record offset (uint32_t)
+  ***************************************************************************************************************************************
+  */
+static uint32_t FF_PROFILE_Locate_Data(uint16_t _dataIdx, uint16_t* _recordSize)
+{
+	/* Sorted list positions map to the entry index through the sorted index */
+	if(PROFILE.sortFlag){_dataIdx = FF_PROFILE_Sorted_Entry(_dataIdx);}
+
+	return FF_PROFILE_Locate_Entry(_dataIdx, _recordSize);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile read the entry index of a sorted list position
+  * @param Sorted data index (uint16_t)
+  * @retval Entry index (uint16_t)
+  ***************************************************************************************************************************************
+  */
+static uint16_t FF_PROFILE_Sorted_Entry(uint16_t _dataIdx)
+{
+	FF_PROFILE_Read_Image((PROFILE.indexOffset + (_dataIdx * sizeof(uint16_t))), &_dataIdx, sizeof(_dataIdx));
+	if(_dataIdx >= PROFILE.dataNbr){BSP_Error_Handler();}
+
+	return _dataIdx;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile locate the record of a vault entry in data.bin
+  * @param Entry index (uint16_t), record size (uint16_t*)
+  * @retval Record offset (uint32_t)
+  ***************************************************************************************************************************************
+  */
+static uint32_t FF_PROFILE_Locate_Entry(uint16_t _entryIdx, uint16_t* _recordSize)
+{
+	uint32_t _offset[2];
+
+	/* The record size is given by the next offset, the last record ends with the sorted index */
+	_offset[1] = PROFILE.indexOffset;
+	FF_PROFILE_Read_Image((PROFILE.offsetTable + (_entryIdx * sizeof(uint32_t))), _offset, (((_entryIdx + 1U) < PROFILE.dataNbr) ? 8U : 4U));
+
+	if((_offset[1] <= _offset[0]) || ((_offset[1] - _offset[0]) > FF_PROFILE_RECORD_SIZE)){BSP_Error_Handler();}
+
+	*_recordSize = (uint16_t)(_offset[1] - _offset[0]);
+
+	return _offset[0];
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile load a single record from data.bin to the end of the arena
+  * @param List position (uint16_t), cache slot (profile_cache_ts*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Load_Data(uint16_t _dataIdx, profile_cache_ts* _cache)
+{
+	uint32_t _offset = FF_PROFILE_Locate_Data(_dataIdx, &_cache->arenaSize);
+#if (1U == FF_PROFILE_COMPRESS)
+	uint16_t _packSize;
+#endif
+
+	/* Drop the least recently used records until the new one fits */
+	while((FF_PROFILE_ARENA_SIZE - PROFILE.arenaLen) < _cache->arenaSize){FF_PROFILE_Evict_Cache();}
+
+	_cache->arenaIdx = PROFILE.arenaLen;
+	_cache->packFlag = 0U;
+
+#if (1U == FF_PROFILE_COMPRESS)
+	/* The record is staged in ffBuffer, it stays raw when packing does not make it smaller */
+	PROFILE.viewIdx = FF_PROFILE_NO_DATA;
+	FF_PROFILE_Read_Image(_offset, PROFILE.ffBuffer, _cache->arenaSize);
+	_packSize = FF_PROFILE_Pack_Record(PROFILE.ffBuffer, _cache->arenaSize, &PROFILE.arena[_cache->arenaIdx]);
+
+	if(_packSize)
+	{
+		PROFILE.stats.packNbr++;
+		PROFILE.stats.packRawBytes += _cache->arenaSize;
+		PROFILE.stats.packBytes += _packSize;
+		_cache->arenaSize = _packSize;
+		_cache->packFlag = 1U;
+	}
+	else{memcpy(&PROFILE.arena[_cache->arenaIdx], PROFILE.ffBuffer, _cache->arenaSize);}
+#else
+	FF_PROFILE_Read_Image(_offset, &PROFILE.arena[_cache->arenaIdx], _cache->arenaSize);
+#endif
+
+	PROFILE.arenaLen += _cache->arenaSize;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile find a cached entry
+  * @param Data index (uint16_t)
+  * @retval Cache slot (profile_cache_ts*, NULL on a miss)
+  ***************************************************************************************************************************************
+  */
+static profile_cache_ts* FF_PROFILE_Find_Cache(uint16_t _dataIdx)
+{
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_CACHE_SIZE; _idx++)
+	{
+		if(_dataIdx == PROFILE.cache[_idx].dataIdx){return &PROFILE.cache[_idx];}
+	}
+
+	return NULL;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile load an entry into a free cache slot, the least recently used one is dropped when none is free
+  * @param Data index (uint16_t)
+  * @retval Cache slot (profile_cache_ts*)
+  ***************************************************************************************************************************************
+  */
+static profile_cache_ts* FF_PROFILE_Fetch_Cache(uint16_t _dataIdx)
+{
+	profile_cache_ts* _cache = FF_PROFILE_Find_Cache(FF_PROFILE_NO_DATA);
+
+	if(NULL == _cache)
+	{
+		FF_PROFILE_Evict_Cache();
+		_cache = FF_PROFILE_Find_Cache(FF_PROFILE_NO_DATA);
+	}
+
+	FF_PROFILE_Load_Data(_dataIdx, _cache);
+	_cache->dataIdx = _dataIdx;
+
+	return _cache;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile drop the least recently used record and close the gap in the arena
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Evict_Cache(void)
+{
+	profile_cache_ts* _cache = NULL;
+	uint16_t _arenaEnd;
+
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_CACHE_SIZE; _idx++)
+	{
+		if((FF_PROFILE_NO_DATA != PROFILE.cache[_idx].dataIdx) && ((NULL == _cache) || (PROFILE.cache[_idx].useStamp < _cache->useStamp)))
+		{_cache = &PROFILE.cache[_idx];}
+	}
+
+	if(NULL == _cache){BSP_Error_Handler();}
+
+	_arenaEnd = _cache->arenaIdx + _cache->arenaSize;
+	memmove(&PROFILE.arena[_cache->arenaIdx], &PROFILE.arena[_arenaEnd], (PROFILE.arenaLen - _arenaEnd));
+	PROFILE.arenaLen -= _cache->arenaSize;
+
+	for(uint8_t _idx = 0U; _idx < FF_PROFILE_CACHE_SIZE; _idx++)
+	{
+		if((FF_PROFILE_NO_DATA != PROFILE.cache[_idx].dataIdx) && (PROFILE.cache[_idx].arenaIdx > _cache->arenaIdx))
+		{PROFILE.cache[_idx].arenaIdx -= _cache->arenaSize;}
+	}
+
+	_cache->dataIdx = FF_PROFILE_NO_DATA;
+}
+
+#if (1U == FF_PROFILE_COMPRESS)
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile pack a record against the dictionary, greedy longest match. Bytes below 0x80 are literals,
+  *        FF_PROFILE_DICT_TOKEN + n is the dictionary word n and FF_PROFILE_DICT_ESCAPE is followed by a literal byte.
+  * @param Record (const uint8_t*), record size (uint16_t), packed record (uint8_t*, record size bytes)
+  * @retval Packed size, 0 when packing does not make the record smaller (uint16_t)
+  ***************************************************************************************************************************************
+  */
+static uint16_t FF_PROFILE_Pack_Record(const uint8_t* _src, uint16_t _srcSize, uint8_t* _dst)
+{
+	const uint8_t* _word;
+	uint16_t _dstSize = 0U;
+	uint16_t _idx = 0U;
+	uint8_t _bestIdx = 0U;
+	uint8_t _bestSize;
+
+	if(0U == PROFILE.dictNbr){return 0U;}
+
+	while(_idx < _srcSize)
+	{
+		_bestSize = 0U;
+
+		for(uint8_t _wordIdx = 0U; _wordIdx < PROFILE.dictNbr; _wordIdx++)
+		{
+			_word = &PROFILE.dict[PROFILE.dictOffset[_wordIdx]];
+			if((_word[0] > _bestSize) && (_word[0] <= (_srcSize - _idx)) && (_word[1] == _src[_idx]) && (0 == memcmp(&_word[1], &_src[_idx], _word[0])))
+			{
+				_bestIdx = _wordIdx;
+				_bestSize = _word[0];
+			}
+		}
+
+		if((_dstSize + ((_bestSize || (_src[_idx] < FF_PROFILE_DICT_TOKEN)) ? 1U : 2U)) >= _srcSize){return 0U;}
+
+		if(_bestSize)
+		{
+			_dst[_dstSize++] = FF_PROFILE_DICT_TOKEN + _bestIdx;
+			_idx += _bestSize;
+		}
+		else if(_src[_idx] < FF_PROFILE_DICT_TOKEN){_dst[_dstSize++] = _src[_idx++];}
+		else
+		{
+			_dst[_dstSize++] = FF_PROFILE_DICT_ESCAPE;
+			_dst[_dstSize++] = _src[_idx++];
+		}
+	}
+
+	return _dstSize;
+}
+#endif
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile unpack a record packed by FF_PROFILE_Pack_Record, the DWT cycle counter measures the cost per record
+  * @param Packed record (const uint8_t*), packed size (uint16_t), record (uint8_t*, FF_PROFILE_RECORD_SIZE bytes)
+  * @retval Record size (uint16_t)
+  ***************************************************************************************************************************************
+  */
+static uint16_t FF_PROFILE_Unpack_Record(const uint8_t* _src, uint16_t _srcSize, uint8_t* _dst)
+{
+	uint32_t _cycles = DWT->CYCCNT;
+	const uint8_t* _word;
+	uint16_t _dstSize = 0U;
+	uint16_t _idx = 0U;
+
+	while(_idx < _srcSize)
+	{
+		if(_src[_idx] < FF_PROFILE_DICT_TOKEN)
+		{
+			if(_dstSize >= FF_PROFILE_RECORD_SIZE){BSP_Error_Handler();}
+			_dst[_dstSize++] = _src[_idx++];
+		}
+		else if(FF_PROFILE_DICT_ESCAPE == _src[_idx])
+		{
+			if(((_idx + 1U) >= _srcSize) || (_dstSize >= FF_PROFILE_RECORD_SIZE)){BSP_Error_Handler();}
+			_dst[_dstSize++] = _src[_idx + 1U];
+			_idx += 2U;
+		}
+		else
+		{
+			if((_src[_idx] - FF_PROFILE_DICT_TOKEN) >= PROFILE.dictNbr){BSP_Error_Handler();}
+			_word = &PROFILE.dict[PROFILE.dictOffset[_src[_idx] - FF_PROFILE_DICT_TOKEN]];
+			if((_dstSize + _word[0]) > FF_PROFILE_RECORD_SIZE){BSP_Error_Handler();}
+			memcpy(&_dst[_dstSize], &_word[1], _word[0]);
+			_dstSize += _word[0];
+			_idx++;
+		}
+	}
+
+	_cycles = DWT->CYCCNT - _cycles;
+	PROFILE.stats.unpackNbr++;
+	PROFILE.stats.unpackCycles += _cycles;
+	if(_cycles > PROFILE.stats.unpackMax){PROFILE.stats.unpackMax = _cycles;}
+
+	return _dstSize;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile decode a packed record into a view
+  * @param Record (const uint8_t*), record size (uint16_t), data view (profile_view_ts*)
+  * @retval Status (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Decode_Record(const uint8_t* _record, uint16_t _recordSize, profile_view_ts* _view)
+{
+	uint16_t _idx;
+
+	/* urlSize, url, 0, dataNbr */
+	if((_recordSize < 3U) || ((_record[0] + 3U) > _recordSize) || (0U != _record[_record[0] + 1U])){return 0U;}
+
+	_view->url.size = _record[0];
+	_view->url.buffer = &_record[1];
+	_idx = _view->url.size + 2U;
+
+	_view->dataNbr = _record[_idx++];
+	if(_view->dataNbr > FF_PROFILE_MAX_FIELDS){return 0U;}
+
+	/* nameCode, size, data, 0 or nameCode, FF_PROFILE_POOL_REF, poolIdx */
+	for(uint8_t _fieldIdx = 0U; _fieldIdx < _view->dataNbr; _fieldIdx++)
+	{
+		if(((_idx + 3U) > _recordSize) || (_record[_idx] >= FF_PROFILE_FIELD_TYPES)){return 0U;}
+
+		_view->dataNameCode[_fieldIdx] = _record[_idx];
+
+		if(FF_PROFILE_POOL_REF == _record[_idx + 1U])
+		{
+			if(_record[_idx + 2U] >= PROFILE.poolNbr){return 0U;}
+
+			_view->data[_fieldIdx].size = PROFILE.pool[PROFILE.poolOffset[_record[_idx + 2U]]];
+			_view->data[_fieldIdx].buffer = &PROFILE.pool[PROFILE.poolOffset[_record[_idx + 2U]] + 1U];
+			_idx += 3U;
+		}
+		else
+		{
+			if(((_idx + _record[_idx + 1U] + 3U) > _recordSize) || (0U != _record[_idx + _record[_idx + 1U] + 2U])){return 0U;}
+
+			_view->data[_fieldIdx].size = _record[_idx + 1U];
+			_view->data[_fieldIdx].buffer = &_record[_idx + 2U];
+			_idx += _view->data[_fieldIdx].size + 3U;
+		}
+	}
+
+	return (_idx == _recordSize);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile fill the reader buffer from the current file position
+  * @param Reader handle (profile_reader_ts*)
+  * @retval Data available (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Fill_Buffer(profile_reader_ts* _reader)
+{
+	UINT _bytesRead;
+
+	if(_reader->bufferIdx < _reader->bufferLen){return 1U;}
+
+	_reader->readNbr++;
+	if(FR_OK != FF_PROFILE_Read_File(_reader->file, _reader->buffer, _reader->bufferSize, &_bytesRead)){BSP_Error_Handler();}
+
+	_reader->bufferIdx = 0U;
+	_reader->bufferLen = _bytesRead;
+
+	if((_reader->crcFlag) && (_bytesRead)){_reader->crc = HAL_CRC_Accumulate(&PROFILE.crc, (uint32_t*)_reader->buffer, _bytesRead);}
+
+	return (0U != _bytesRead);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile write bytes into the image file
+  * @param Writer handle (profile_writer_ts*), source (const uint8_t*), length (uint32_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Write_Bytes(profile_writer_ts* _writer, const uint8_t* _src, uint32_t _len)
+{
+	UINT _bytesWritten;
+
+	if((!_writer->status) || (!_len)){return;}
+
+	_writer->crc = HAL_CRC_Accumulate(&PROFILE.crc, (uint32_t*)_src, _len);
+
+	if((FR_OK != f_write(_writer->file, _src, _len, &_bytesWritten)) || (_len != _bytesWritten)){_writer->status = 0U;}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile read the next "<...>" token
+  * @param Reader handle (profile_reader_ts*), token buffer (uint8_t*), token buffer size (uint16_t), token length (uint16_t*)
+  * @retval Token found (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Read_Token(profile_reader_ts* _reader, uint8_t* _token, uint16_t _tokenSize, uint16_t* _tokenLen)
+{
+	const uint8_t* _ptr;
+	uint32_t _len;
+
+	/* Find the '<' symbol */
+	do{
+		if(!FF_PROFILE_Fill_Buffer(_reader)){return 0U;}
+
+		_ptr = memchr(&_reader->buffer[_reader->bufferIdx], '<', (_reader->bufferLen - _reader->bufferIdx));
+		if(NULL == _ptr){_reader->bufferIdx = _reader->bufferLen;}
+		else{_reader->bufferIdx = (uint32_t)(_ptr - _reader->buffer) + 1U;}
+	}while(NULL == _ptr);
+
+	/* Copy everything up to the '>' symbol */
+	*_tokenLen = 0U;
+	do{
+		if(!FF_PROFILE_Fill_Buffer(_reader)){BSP_Error_Handler();}
+
+		_ptr = memchr(&_reader->buffer[_reader->bufferIdx], '>', (_reader->bufferLen - _reader->bufferIdx));
+		if(NULL == _ptr){_len = _reader->bufferLen - _reader->bufferIdx;}
+		else{_len = (uint32_t)(_ptr - &_reader->buffer[_reader->bufferIdx]);}
+
+		if((*_tokenLen + _len) > _tokenSize){BSP_Error_Handler();}
+
+		memcpy(&_token[*_tokenLen], &_reader->buffer[_reader->bufferIdx], _len);
+		*_tokenLen += _len;
+		_reader->bufferIdx += _len;
+	}while(NULL == _ptr);
+
+	/* Skip the '>' symbol */
+	_reader->bufferIdx++;
+
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile parse a decimal number token
+  * @param Token (const uint8_t*), token length (uint16_t), value (uint16_t*)
+  * @retval Status (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Parse_Number(const uint8_t* _token, uint16_t _tokenLen, uint16_t* _value)
+{
+	uint32_t _number = 0U;
+
+	if((0U == _tokenLen) || (_tokenLen > 5U)){return 0U;}
+
+	for(uint16_t _idx = 0U; _idx < _tokenLen; _idx++)
+	{
+		if((_token[_idx] < '0') || (_token[_idx] > '9')){return 0U;}
+		_number = (_number * 10U) + (_token[_idx] - '0');
+	}
+
+	if(_number > 0xFFFFU){return 0U;}
+
+	*_value = (uint16_t)_number;
+	return 1U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile parse a single token into the packed record
+  * @param Parser handle (profile_parser_ts*), record (uint8_t*), token (const uint8_t*), token length (uint16_t)
+  * @retval Record complete (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t FF_PROFILE_Parse_Token(profile_parser_ts* _parser, uint8_t* _record, const uint8_t* _token, uint16_t _tokenLen)
+{
+	uint8_t _recordDone = 0U;
+	const uint8_t* _ptr;
+	uint16_t _value;
+	uint16_t _nameLen;
+	uint8_t _valueSize;
+	uint8_t _poolIdx;
+	uint8_t _code;
+
+	switch(_parser->state)
+	{
+		/* "<n>" - number of the profile entries */
+		case(FF_PROFILE_PARSE_COUNT):
+			if((!FF_PROFILE_Parse_Number(_token, _tokenLen, &_value)) || (_value > FF_PROFILE_MAX_DATA)){BSP_Error_Handler();}
+
+			_parser->dataNbr = _value;
+			_parser->dataIdx = 0U;
+			_parser->state = (0U == _value) ? FF_PROFILE_PARSE_DONE : FF_PROFILE_PARSE_URL;
+		break;
+
+		/* "<url:...>" */
+		case(FF_PROFILE_PARSE_URL):
+			if((_tokenLen < 4U) || (0 != memcmp(_token, "url:", 4U)) || ((_tokenLen - 4U) >= FF_PROFILE_URL_SIZE)){BSP_Error_Handler();}
+
+			_record[0] = (uint8_t)(_tokenLen - 4U);
+			memcpy(&_record[1], &_token[4], _record[0]);
+			_record[_record[0] + 1U] = 0U;
+			_parser->recordLen = _record[0] + 2U;
+			_parser->state = FF_PROFILE_PARSE_FIELD_NBR;
+		break;
+
+		/* "<n>" - number of the entry fields */
+		case(FF_PROFILE_PARSE_FIELD_NBR):
+			if((!FF_PROFILE_Parse_Number(_token, _tokenLen, &_value)) || (_value > FF_PROFILE_MAX_FIELDS)){BSP_Error_Handler();}
+
+			_record[_parser->recordLen++] = (uint8_t)_value;
+			_parser->fieldNbr = (uint8_t)_value;
+			_parser->fieldIdx = 0U;
+
+			if(0U == _value){FF_PROFILE_Next_Data(_parser); _recordDone = 1U;}
+			else{_parser->state = FF_PROFILE_PARSE_FIELD;}
+		break;
+
+		/* "<email:...>", "<user:...>", "<password:...>", "<notes:...>" or "<otp:...>" */
+		case(FF_PROFILE_PARSE_FIELD):
+			_ptr = memchr(_token, ':', _tokenLen);
+			if(NULL == _ptr){BSP_Error_Handler();}
+
+			_nameLen = (uint16_t)(_ptr - _token);
+			for(_code = 0U; _code < FF_PROFILE_FIELD_TYPES; _code++)
+			{
+				if((strlen(FF_PROFILE_FIELD_NAMES[_code]) == _nameLen) && (0 == memcmp(_token, FF_PROFILE_FIELD_NAMES[_code], _nameLen))){break;}
+			}
+
+			if((FF_PROFILE_FIELD_TYPES == _code) || ((_tokenLen - _nameLen - 1U) >= FF_PROFILE_FIELD_SIZE)){BSP_Error_Handler();}
+
+			_valueSize = (uint8_t)(_tokenLen - _nameLen - 1U);
+			_poolIdx = FF_PROFILE_Intern_Value(_code, (_ptr + 1U), _valueSize);
+			_record[_parser->recordLen++] = _code;
+
+			if(FF_PROFILE_NO_POOL != _poolIdx)
+			{
+				_record[_parser->recordLen++] = FF_PROFILE_POOL_REF;
+				_record[_parser->recordLen++] = _poolIdx;
+				_parser->poolRefNbr++;
+				_parser->poolSaved += _valueSize;
+			}
+			else
+			{
+				_record[_parser->recordLen++] = _valueSize;
+				memcpy(&_record[_parser->recordLen], (_ptr + 1U), _valueSize);
+				_parser->recordLen += _valueSize;
+				_record[_parser->recordLen++] = 0U;
+			}
+
+			_parser->fieldIdx++;
+
+			if(_parser->fieldIdx >= _parser->fieldNbr){FF_PROFILE_Next_Data(_parser); _recordDone = 1U;}
+		break;
+
+		default: BSP_Error_Handler(); break;
+	}
+
+	return _recordDone;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief FF profile switch the parser to the next profile entry
+  * @param Parser handle (profile_parser_ts*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void FF_PROFILE_Next_Data(profile_parser_ts* _parser)
+{
+	_parser->dataIdx++;
+
+	if(_parser->dataIdx < _parser->dataNbr){_parser->state = FF_PROFILE_PARSE_URL;}
+	else{_parser->state = FF_PROFILE_PARSE_DONE;}
 }
@@ -14,6 +14,7 @@
   ***************************************************************************************************************************************
   */
 
+#include <stdio.h>
 #include "system.h"
 #include "bsp.h"
 #include "tsl_msp.h"
@@ -24,6 +25,7 @@
 #include "led.h"
 #include "bat.h"
 #include "ff_profile.h"
+#include "ff_ftl.h"
 #include "display.h"
 
 static system_ts SYSTEM;
@@ -37,7 +39,12 @@ static const uint8_t SYSTEM_PASSWORD[SYSTEM_PASSWORD_NBR] = {
 
 static void SYSTEM_Start_Scheduler(system_ts* _system);
 static int SYSTEM_SWO_Write(int _length, char *_buffer);
+static int SYSTEM_SWO_Length(int _length, size_t _size);
 static void SYSTEM_Scan_Buttons(system_ts* _system);
+static uint8_t SYSTEM_Confirm(system_ts* _system, uint8_t* _ledHandlerParam);
+static void SYSTEM_Report_Profile_Stats(void);
+static void SYSTEM_Report_Cache_Stats(void);
+static void SYSTEM_BT_Config(HCI_DriverInformation_t* _hciDriverInformation);
 
 /**
   ***************************************************************************************************************************************
@@ -51,6 +58,7 @@ int main(void)
 	uint8_t _idx;
 	uint8_t _addPinFlag = 0U;
 	uint8_t _ledHandlerParam = 0U;
+	HCI_DriverInformation_t _hciDriverInformation;
 
 	/* Reset of all peripherals, Initializes the Flash interface and the Systick. */
 	HAL_Init();
@@ -62,6 +70,9 @@ int main(void)
 	I2C_Driver_Init();
 	TSL_Driver_Init();
 	FF_PROFILE_Init();
+	/* The Bluetooth controller is brought up and patched while the PIN is entered */
+	SYSTEM_BT_Config(&_hciDriverInformation);
+	BT_HOGP_Warm_Up_Start(&_hciDriverInformation);
 	LED_On();
 	HAL_Delay(20U);
 	SSD1306_Driver_Init();
@@ -111,9 +122,15 @@ int main(void)
 			LED_Handler(&_ledHandlerParam);
 		}
 
+		/* The vault is loaded in slices between the button scans */
+		FF_PROFILE_Load_Task();
+		BT_HOGP_Warm_Up_Task();
+
 		if(!SYSTEM.offTmo){BSP_System_off();}
 	}
 
+	/* The PIN log lives behind the volume the load mounts, only the mount step has to be done before the check */
+	while(FF_PROFILE_LOAD_MOUNT == FF_PROFILE_Get_Load_State()){FF_PROFILE_Load_Task();}
 	SYSTEM.offTmo = SYSTEM_OFF_TMO;
 
 	/* Check password */
@@ -128,9 +145,14 @@ int main(void)
 	}
 
 	FF_PROFILE_Check_Error_Log(1U);
+
+	/* The rest of the load runs in one go once the PIN is correct */
+	while(!FF_PROFILE_Load_Task()){BT_HOGP_Warm_Up_Task();}
+	SYSTEM_Report_Profile_Stats();
 	SYSTEM.display.context = 1U;
 
-	while(!SYSTEM.button[SYSTEM_BUTTON_OK].statusFlag)
+	/* A blank memory has nothing to open, OK is only taken on the EDIT item that formats it */
+	while((!SYSTEM.button[SYSTEM_BUTTON_OK].statusFlag) || ((FF_PROFILE_Get_Stats()->blankFlag) && (1U != SYSTEM.display.verticalListIdx)))
 	{
 		SYSTEM_Scan_Buttons(&SYSTEM);
 
@@ -140,7 +162,7 @@ int main(void)
 			SYSTEM.horizontalListIdxTmo = SYSTEM_KEY_TMO;
 			SYSTEM.display.verticalListIdx--;
 		}
-		else if((SYSTEM.button[SYSTEM_BUTTON_DOWN].statusFlag) && (SYSTEM.display.verticalListIdx < 1U) && (!SYSTEM.horizontalListIdxTmo))
+		else if((SYSTEM.button[SYSTEM_BUTTON_DOWN].statusFlag) && (SYSTEM.display.verticalListIdx < 3U) && (!SYSTEM.horizontalListIdxTmo))
 		{
 			SYSTEM.offTmo = SYSTEM_OFF_TMO;
 			SYSTEM.horizontalListIdxTmo = SYSTEM_KEY_TMO;
@@ -151,6 +173,7 @@ int main(void)
 
 		BAT_Handler();
 		DISPLAY_Prepare_Context(&SYSTEM.display);
+		BT_HOGP_Warm_Up_Task();
 
 		if(!SYSTEM.ledHandlerTmo)
 		{
@@ -168,13 +191,34 @@ int main(void)
 		/* Edit mode */
 		SYSTEM.display.verticalListIdx = 0U;
 		SYSTEM.display.context = 3U;
+
+		/* A blank memory is formatted by the device only once the user confirms it, the edit then fills the new vault */
+		if(FF_PROFILE_Get_Stats()->blankFlag)
+		{
+			SYSTEM.display.usbStatus = DISPLAY_USB_FORMAT;
+			if(!SYSTEM_Confirm(&SYSTEM, &_ledHandlerParam)){BSP_System_off();}
+
+			SYSTEM.display.usbStatus = DISPLAY_USB_RELOAD;
+			SYSTEM.display.updateTmo = 0U;
+			DISPLAY_Prepare_Context(&SYSTEM.display);
+			FF_PROFILE_Format();
+		}
+
+		SYSTEM.display.usbStatus = DISPLAY_USB_WAIT;
+		FF_FTL_Set_Host_Flag(1U);
 		USB_Device_Init();
 
-		while(1U)
+		/* The edit ends when the host ejects the medium or the cable is unplugged after it was attached */
+		while(!USB_Device_Get_Eject_Flag())
 		{
 			SYSTEM_Scan_Buttons(&SYSTEM);
 			BAT_Handler();
+
+			if(BSP_USB_Get_VBUS_Status()){SYSTEM.display.usbStatus = DISPLAY_USB_PLUGGED;}
+			else if(DISPLAY_USB_PLUGGED == SYSTEM.display.usbStatus){break;}
+
 			DISPLAY_Prepare_Context(&SYSTEM.display);
+			BT_HOGP_Warm_Up_Task();
 			SYSTEM.offTmo = SYSTEM_OFF_TMO;
 
 			if(!SYSTEM.ledHandlerTmo)
@@ -183,19 +227,32 @@ int main(void)
 				LED_Handler(&_ledHandlerParam);
 			}
 		}
-	}
-	else
-	{
-		/* Open mode */
-		SYSTEM.offTmo = SYSTEM_OFF_TMO;
-		SYSTEM.display.verticalListIdx = 0U;
-		SYSTEM.display.horizontalListIdx = 0U;
-		SYSTEM.display.context = 2U;
-		SYSTEM.display.xScroll = 10;
-		SYSTEM.display.xDirection = 0U;
 
-		SYSTEM_Start_Scheduler(&SYSTEM);
+		USB_Device_DeInit();
+		FF_FTL_Set_Host_Flag(0U);
+		/* Draw the loading screen right away, a changed vault is compiled again */
+		SYSTEM.display.usbStatus = DISPLAY_USB_RELOAD;
+		SYSTEM.display.updateTmo = 0U;
+		DISPLAY_Prepare_Context(&SYSTEM.display);
+		FF_PROFILE_Reload();
+		SYSTEM_Report_Profile_Stats();
 	}
+
+	/* Open mode, the A-Z item opens the vault in URL order and the RECENT item in usage order, the edit mode continues here with the vault order */
+	SYSTEM.offTmo = SYSTEM_OFF_TMO;
+	SYSTEM.display.sortFlag = (2U == SYSTEM.display.verticalListIdx);
+
+	if(SYSTEM.display.sortFlag){FF_PROFILE_Set_Order(FF_PROFILE_ORDER_URL);}
+	else if(3U == SYSTEM.display.verticalListIdx){FF_PROFILE_Set_Order(FF_PROFILE_ORDER_RECENT);}
+	else{FF_PROFILE_Set_Order(FF_PROFILE_ORDER_VAULT);}
+
+	SYSTEM.display.verticalListIdx = 0U;
+	SYSTEM.display.horizontalListIdx = 0U;
+	SYSTEM.display.context = 2U;
+	SYSTEM.display.xScroll = 10;
+	SYSTEM.display.xDirection = 0U;
+
+	SYSTEM_Start_Scheduler(&SYSTEM);
 }
 
 /**
@@ -207,18 +264,19 @@ int main(void)
   */
 static void SYSTEM_Start_Scheduler(system_ts* _system)
 {
-	const profile_data_ts* _profileData;
+	const profile_view_ts* _profileData;
+	uint16_t _listStart;
+	uint16_t _listEnd;
+	uint8_t _group;
 	BTPS_Initialization_t BTPS_Initialization;
 	HCI_DriverInformation_t HCI_DriverInformation;
 
-	/* Configure the UART Parameters */
 	_system->offTmo = SYSTEM_OFF_TMO;
-	HCI_DRIVER_SET_COMM_INFORMATION(&HCI_DriverInformation, 1U, 921600UL, cpUART_RTS_CTS);
-	HCI_DriverInformation.DriverInformation.COMMDriverInformation.InitializationDelay = 10U;
+	SYSTEM_BT_Config(&HCI_DriverInformation);
 	/* Set up the application callbacks */
 	BTPS_Initialization.MessageOutputCallback = SYSTEM_SWO_Write;
 
-	/* Initialize the application */
+	/* Initialize the application, the advertising starts here */
 	if(BT_HOGP_Application_Init(&HCI_DriverInformation, &BTPS_Initialization))
 	{
 		if(BTPS_AddFunctionToScheduler(LED_Handler, NULL, LED_HANDLER_TMO))
@@ -230,8 +288,21 @@ static void SYSTEM_Start_Scheduler(system_ts* _system)
 					BT_HOGP_Task_Handler();
 					SYSTEM_Scan_Buttons(_system);
 
+					/* The A-Z mode walks within the letter group of the displayed entry */
+					if(_system->display.sortFlag)
+					{
+						_group = FF_PROFILE_Get_Group(_system->display.horizontalListIdx);
+						_listStart = FF_PROFILE_Get_Group_Start(_group);
+						_listEnd = FF_PROFILE_Get_Group_Start(_group + 1U);
+					}
+					else
+					{
+						_listStart = 0U;
+						_listEnd = FF_PROFILE_Get_Data_Number();
+					}
+
 					/* Horizontal list control */
-					if((_system->button[SYSTEM_BUTTON_LEFT].statusFlag) && (_system->display.horizontalListIdx > 0U) && (!_system->horizontalListIdxTmo))
+					if((_system->button[SYSTEM_BUTTON_LEFT].statusFlag) && (_system->display.horizontalListIdx > _listStart) && (!_system->horizontalListIdxTmo))
 					{
 						_system->horizontalListIdxTmo = SYSTEM_KEY_TMO;
 						_system->display.horizontalListIdx--;
@@ -240,16 +311,16 @@ static void SYSTEM_Start_Scheduler(system_ts* _system)
 						_system->display.xDirection = 0U;
 						_system->offTmo = SYSTEM_OFF_TMO;
 					}
-					else if((_system->button[SYSTEM_BUTTON_LEFT].statusFlag) && (0U == _system->display.horizontalListIdx) && (!_system->horizontalListIdxTmo))
+					else if((_system->button[SYSTEM_BUTTON_LEFT].statusFlag) && (_listStart == _system->display.horizontalListIdx) && (!_system->horizontalListIdxTmo))
 					{
 						_system->horizontalListIdxTmo = SYSTEM_KEY_TMO;
-						_system->display.horizontalListIdx = (FF_PROFILE_Get_Data_Number() - 1U);
+						_system->display.horizontalListIdx = (_listEnd - 1U);
 						_system->display.verticalListIdx = 0U;
 						_system->display.xScroll = 10;
 						_system->display.xDirection = 0U;
 						_system->offTmo = SYSTEM_OFF_TMO;
 					}
-					else if((_system->button[SYSTEM_BUTTON_RIGHT].statusFlag) && (_system->display.horizontalListIdx < (FF_PROFILE_Get_Data_Number() - 1U)) && \
+					else if((_system->button[SYSTEM_BUTTON_RIGHT].statusFlag) && (_system->display.horizontalListIdx < (_listEnd - 1U)) && \
 							(!_system->horizontalListIdxTmo))
 					{
 						_system->horizontalListIdxTmo = SYSTEM_KEY_TMO;
@@ -259,11 +330,11 @@ static void SYSTEM_Start_Scheduler(system_ts* _system)
 						_system->display.xDirection = 0U;
 						_system->offTmo = SYSTEM_OFF_TMO;
 					}
-					else if((_system->button[SYSTEM_BUTTON_RIGHT].statusFlag) && (_system->display.horizontalListIdx == (FF_PROFILE_Get_Data_Number() - 1U)) && \
+					else if((_system->button[SYSTEM_BUTTON_RIGHT].statusFlag) && (_system->display.horizontalListIdx == (_listEnd - 1U)) && \
 							(!_system->horizontalListIdxTmo))
 					{
 						_system->horizontalListIdxTmo = SYSTEM_KEY_TMO;
-						_system->display.horizontalListIdx = 0U;
+						_system->display.horizontalListIdx = _listStart;
 						_system->display.verticalListIdx = 0U;
 						_system->display.xScroll = 10;
 						_system->display.xDirection = 0U;
@@ -272,8 +343,17 @@ static void SYSTEM_Start_Scheduler(system_ts* _system)
 
 					_profileData = FF_PROFILE_Get_Data(_system->display.horizontalListIdx);
 
-					/* Vertical list control */
-					if((_system->button[SYSTEM_BUTTON_UP].statusFlag) && (_system->display.verticalListIdx > 0U) && (!_system->verticalListIdxTmo))
+					/* Vertical list control, UP/DOWN on the header jump between the letter groups in the A-Z mode */
+					if((_system->display.sortFlag) && (0U == _system->display.verticalListIdx) && (!_system->verticalListIdxTmo) && \
+					   ((_system->button[SYSTEM_BUTTON_UP].statusFlag) || (_system->button[SYSTEM_BUTTON_DOWN].statusFlag)))
+					{
+						_system->verticalListIdxTmo = SYSTEM_KEY_TMO;
+						_system->display.horizontalListIdx = FF_PROFILE_Jump_Group(_system->display.horizontalListIdx, _system->button[SYSTEM_BUTTON_DOWN].statusFlag);
+						_system->display.xScroll = 10;
+						_system->display.xDirection = 0U;
+						_system->offTmo = SYSTEM_OFF_TMO;
+					}
+					else if((_system->button[SYSTEM_BUTTON_UP].statusFlag) && (_system->display.verticalListIdx > 0U) && (!_system->verticalListIdxTmo))
 					{
 						_system->verticalListIdxTmo = SYSTEM_KEY_TMO;
 						_system->display.verticalListIdx--;
@@ -311,9 +391,25 @@ static void SYSTEM_Start_Scheduler(system_ts* _system)
 					{
 						_system->dataTxTmo = SYSTEM_KEY_TMO;
 						_system->offTmo = SYSTEM_OFF_TMO;
-						if(0U == _system->display.verticalListIdx){BT_HOGP_Send_Data_Reports(_profileData->url, _profileData->urlSize);}
-						else{BT_HOGP_Send_Data_Reports(_profileData->dataBuffer[_system->display.verticalListIdx - 1U], \
-													   _profileData->dataSize[_system->display.verticalListIdx - 1U]);}
+						/* OK on the header enters the fields in the A-Z mode */
+						if((_system->display.sortFlag) && (0U == _system->display.verticalListIdx))
+						{
+							if(_profileData->dataNbr)
+							{
+								_system->display.verticalListIdx = 1U;
+								_system->display.xScroll = 10;
+								_system->display.xDirection = 0U;
+							}
+						}
+						else
+						{
+							if(0U == _system->display.verticalListIdx){BT_HOGP_Send_Data_Reports(_profileData->url.buffer, _profileData->url.size);}
+							else{BT_HOGP_Send_Data_Reports(_profileData->data[_system->display.verticalListIdx - 1U].buffer, \
+														   _profileData->data[_system->display.verticalListIdx - 1U].size);}
+
+							/* The entry moves up in the usage order, the selection follows it */
+							_system->display.horizontalListIdx = FF_PROFILE_Record_Use(_system->display.horizontalListIdx);
+						}
 					}
 
 					if((!_system->button[SYSTEM_BUTTON_LEFT].statusFlag) && (!_system->button[SYSTEM_BUTTON_RIGHT].statusFlag)){_system->horizontalListIdxTmo = 0U;}
@@ -323,13 +419,27 @@ static void SYSTEM_Start_Scheduler(system_ts* _system)
 					_system->display.btFlag = BT_HOGP_Get_Connection_Status();
 					DISPLAY_Prepare_Context(&_system->display);
 
+					/* Neighbouring entries are read ahead so the next LEFT/RIGHT press hits the cache */
+					FF_PROFILE_Prefetch(_system->display.horizontalListIdx);
+					/* The usage records are programmed while no key is used, never inside a key press */
+					FF_PROFILE_Usage_Task();
+					DISKIO_Cache_Task();
+					/* Stale subsectors are erased ahead of the next writes */
+					FF_FTL_Task();
+
 					if(!_system->batteryLevelTmo)
 					{
 						_system->batteryLevelTmo = 1000U;
 						BT_HOGP_Update_Battery_Level();
 					}
 
-					if(!_system->offTmo){BSP_System_off();}
+					if(!_system->offTmo)
+					{
+						FF_PROFILE_Usage_Flush();
+						if(RES_OK != DISKIO_Cache_Flush()){BSP_Error_Handler();}
+						SYSTEM_Report_Cache_Stats();
+						BSP_System_off();
+					}
 				}
 			}else{BSP_Error_Handler();}
 		}else{BSP_Error_Handler();}
@@ -350,6 +460,129 @@ static int SYSTEM_SWO_Write(int _length, char *_buffer)
 	return 1;
 }
 
+/**
+  ***************************************************************************************************************************************
+  * @brief SWO line length of a snprintf result, clamped to the text the buffer holds
+  * @param snprintf result (int), buffer size (size_t)
+  * @retval Length (int)
+  ***************************************************************************************************************************************
+  */
+static int SYSTEM_SWO_Length(int _length, size_t _size)
+{
+	if(_length < 0){return 0;}
+
+	return ((size_t)_length < _size) ? _length : (int)(_size - 1U);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief Report the vault load statistics over SWO, nothing is sent while the ITM is disabled
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void SYSTEM_Report_Profile_Stats(void)
+{
+	char _buffer[256];
+	const profile_stats_ts* _stats = FF_PROFILE_Get_Stats();
+	int _len = snprintf(_buffer, sizeof(_buffer), "vault: %u entries from %u files (%u parsed), %s in %lu ms over %u steps (longest %lu us), %lu f_read / %lu bytes, stack %lu bytes, static %lu bytes\r\n", \
+					   _stats->dataNbr, _stats->sourceNbr, _stats->parseNbr, (_stats->compileFlag ? "compiled" : "opened"), (unsigned long)_stats->loadTime, \
+					   _stats->loadStepNbr, (unsigned long)_stats->loadStepMax, \
+					   (unsigned long)_stats->readCalls, (unsigned long)_stats->readBytes, (unsigned long)_stats->stackPeak, \
+					   (unsigned long)_stats->staticSize);
+
+	SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+
+	const diskio_write_stats_ts* _writeStats = DISKIO_Get_Write_Stats();
+	_len = snprintf(_buffer, sizeof(_buffer), "disk writes: %lu sectors skipped, %lu programmed in place, %lu remapped, %lu pages programmed\r\n", \
+				   (unsigned long)_writeStats->skipNbr, (unsigned long)_writeStats->programNbr, (unsigned long)_writeStats->remapNbr, \
+				   (unsigned long)_writeStats->pageNbr);
+
+	SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+
+	const diskio_cache_stats_ts* _cacheStats = DISKIO_Get_Cache_Stats();
+	_len = snprintf(_buffer, sizeof(_buffer), "disk cache: %lu writes, %lu merged, %lu programmed, %lu read hits, %lu read misses, %lu read fills\r\n", \
+				   (unsigned long)_cacheStats->writeNbr, (unsigned long)_cacheStats->mergeNbr, (unsigned long)_cacheStats->flushNbr, \
+				   (unsigned long)_cacheStats->readHits, (unsigned long)_cacheStats->readMisses, (unsigned long)_cacheStats->readFills);
+
+	SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+
+	const ftl_stats_ts* _ftlStats = FF_FTL_Get_Stats();
+	_len = snprintf(_buffer, sizeof(_buffer), "ftl: generation %u, %lu remaps logged, %lu checkpoints, %lu idle / %lu write erases, %lu found blank, %u erased ahead\r\n", \
+				   _ftlStats->generation, (unsigned long)_ftlStats->recordNbr, (unsigned long)_ftlStats->checkpointNbr, (unsigned long)_ftlStats->gcEraseNbr, \
+				   (unsigned long)_ftlStats->syncEraseNbr, (unsigned long)_ftlStats->blankNbr, _ftlStats->erasedNbr);
+
+	SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+
+	_len = snprintf(_buffer, sizeof(_buffer), "ftl discards: %lu sectors unmapped, %lu 64 KB sectors erased, %u subsectors waiting\r\n", \
+				   (unsigned long)_ftlStats->trimNbr, (unsigned long)_ftlStats->sectorEraseNbr, _ftlStats->discardNbr);
+
+	SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+
+	static const char* const _readModes[QSPI_READ_MODE_NBR] = {"1-1-4", "1-4-4", "1-4-4 DTR"};
+	_len = snprintf(_buffer, sizeof(_buffer), "qspi reads: %s mode, %u / %u bytes in", _readModes[BSP_QSPI_Get_Read_Mode()], QSPI_BENCH_SMALL, QSPI_BENCH_SIZE);
+	/* The 1-1-4 mode reads the pattern whenever the init found it */
+	if(!BSP_QSPI_Get_Bench(QSPI_READ_MODE_1_1_4)->Valid)
+	{_len = snprintf(_buffer, sizeof(_buffer), "qspi reads: %s mode, no benchmark before the pattern is programmed", _readModes[BSP_QSPI_Get_Read_Mode()]);}
+	else
+	{
+		for(uint8_t _mode = 0U; _mode < QSPI_READ_MODE_NBR; _mode++)
+		{
+			const QSPI_BenchTypeDef* _bench = BSP_QSPI_Get_Bench(_mode);
+			_len = SYSTEM_SWO_Length(_len, sizeof(_buffer));
+			_len += snprintf(&_buffer[_len], (sizeof(_buffer) - _len), "%s %lu / %lu cycles (%s%s)", (_mode ? "," : ""), (unsigned long)_bench->SmallCycles, \
+							(unsigned long)_bench->BulkCycles, _readModes[_mode], (_bench->Valid ? "" : ", failed"));
+		}
+	}
+	_len = SYSTEM_SWO_Length(_len, sizeof(_buffer));
+	_len += snprintf(&_buffer[_len], (sizeof(_buffer) - _len), "\r\n");
+
+	SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+
+	const QSPI_SuspendStatsTypeDef* _suspendStats = BSP_QSPI_Get_Suspend_Stats();
+	_len = snprintf(_buffer, sizeof(_buffer), "qspi suspends: %lu programs / erases suspended (longest %lu us), %lu reads waited (longest %lu us)\r\n", \
+				   (unsigned long)_suspendStats->SuspendNbr, (unsigned long)_suspendStats->SuspendMax, (unsigned long)_suspendStats->WaitNbr, \
+				   (unsigned long)_suspendStats->WaitMax);
+
+	SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+
+	if(_stats->blankFlag)
+	{
+		_len = snprintf(_buffer, sizeof(_buffer), "vault: %s, the EDIT menu offers to format the memory\r\n", \
+					   (FF_FTL_Get_Stats()->oversizeFlag ? "the volume of an older firmware is larger than the disk, it is left untouched" : "no filesystem"));
+		SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+	}
+
+	_len = snprintf(_buffer, sizeof(_buffer), "vault pool: %u strings / %u bytes, %u references saved %lu bytes, dictionary %u words / %u bytes\r\n", \
+				   _stats->poolNbr, _stats->poolSize, _stats->poolRefNbr, (unsigned long)_stats->poolSaved, _stats->dictNbr, _stats->dictSize);
+
+	SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief Report the record cache and usage log statistics of the open mode over SWO, the unpack cost is given in core cycles per record
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void SYSTEM_Report_Cache_Stats(void)
+{
+	char _buffer[160];
+	const profile_stats_ts* _stats = FF_PROFILE_Get_Stats();
+	int _len = snprintf(_buffer, sizeof(_buffer), "vault cache: %lu records packed %lu -> %lu bytes, %lu unpacked in %lu cycles avg / %lu max\r\n", \
+					   (unsigned long)_stats->packNbr, (unsigned long)_stats->packRawBytes, (unsigned long)_stats->packBytes, \
+					   (unsigned long)_stats->unpackNbr, (unsigned long)(_stats->unpackNbr ? (_stats->unpackCycles / _stats->unpackNbr) : 0U), \
+					   (unsigned long)_stats->unpackMax);
+
+	SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+
+	_len = snprintf(_buffer, sizeof(_buffer), "vault usage: %u entries, %u records programmed, %u slot erases\r\n", \
+				   _stats->usageNbr, _stats->usageWrites, _stats->usageMoves);
+
+	SYSTEM_SWO_Write(SYSTEM_SWO_Length(_len, sizeof(_buffer)), _buffer);
+}
+
 /**
   ***************************************************************************************************************************************
   * @brief SWO write function
@@ -375,6 +608,45 @@ void SYSTEM_Update_TMO(void)
 	}
 }
 
+/**
+  ***************************************************************************************************************************************
+  * @brief Wait for a confirmation on the displayed context, the key that opened it has to be released first
+  * @param System handle (system_ts*), LED handler parameter (uint8_t*)
+  * @retval OK pressed (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t SYSTEM_Confirm(system_ts* _system, uint8_t* _ledHandlerParam)
+{
+	uint8_t _idx;
+	uint8_t _releaseFlag = 0U;
+
+	while(1U)
+	{
+		SYSTEM_Scan_Buttons(_system);
+
+		for(_idx = 0U; (_idx < SYSTEM_BUTTONS) && (!_system->button[_idx].statusFlag); _idx++){}
+
+		if(_idx >= SYSTEM_BUTTONS){_releaseFlag = 1U;}
+		else if(_releaseFlag){break;}
+
+		BAT_Handler();
+		DISPLAY_Prepare_Context(&_system->display);
+		BT_HOGP_Warm_Up_Task();
+
+		if(!_system->ledHandlerTmo)
+		{
+			_system->ledHandlerTmo = LED_HANDLER_TMO;
+			LED_Handler(_ledHandlerParam);
+		}
+
+		if(!_system->offTmo){BSP_System_off();}
+	}
+
+	_system->offTmo = SYSTEM_OFF_TMO;
+
+	return _system->button[SYSTEM_BUTTON_OK].statusFlag;
+}
+
 /**
   ***************************************************************************************************************************************
   * @brief Scan system buttons
@@ -407,3 +679,17 @@ static void SYSTEM_Scan_Buttons(system_ts* _system)
 		}
 	}
 }
+
+/**
+  ***************************************************************************************************************************************
+  * @brief Bluetooth HCI driver information, shared by the controller bring-up and the stack
+  * @param HCI driver information (HCI_DriverInformation_t*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void SYSTEM_BT_Config(HCI_DriverInformation_t* _hciDriverInformation)
+{
+	/* Configure the UART Parameters */
+	HCI_DRIVER_SET_COMM_INFORMATION(_hciDriverInformation, 1U, 921600UL, cpUART_RTS_CTS);
+	_hciDriverInformation->DriverInformation.COMMDriverInformation.InitializationDelay = 10U;
+}
@@ -21,6 +21,7 @@
 #include "usbd_conf.h"
 #include "system.h"
 #include "bat.h"
+#include "n25q512a_qspi.h"
 
 /**
   ***************************************************************************************************************************************
@@ -145,3 +146,27 @@ void USB_IRQHandler(void)
 {
 	USBD_Interupt_Handler();
 }
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  This function handles QUADSPI global interrupt, the asynchronous QSPI requests
+  * @param  None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void QUADSPI_IRQHandler(void)
+{
+	BSP_QSPI_IRQHandler();
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  This function handles DMA1 channel 5 interrupt, the QUADSPI transfers
+  * @param  None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void DMA1_Channel5_IRQHandler(void)
+{
+	BSP_QSPI_DMA_IRQHandler();
+}
@@ -5,7 +5,9 @@
 #include "stm32l4xx_hal.h"
 #include "usbd_def.h"
 
-/* USB Device initialization function */
+/* USB Device functions */
 void USB_Device_Init(void);
+void USB_Device_DeInit(void);
+uint8_t USB_Device_Get_Eject_Flag(void);
 
 #endif
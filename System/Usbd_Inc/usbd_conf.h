@@ -14,6 +14,7 @@
 #define USBD_LPM_ENABLED     			1U
 #define USBD_SELF_POWERED     			1U
 #define MSC_MEDIA_PACKET     			4096U
+#define USBD_IRQ_PRIORITY     			3U /* Below QSPI_IRQ_PRIORITY, the storage callbacks wait for the QSPI requests */
 
 /* Define for FS and HS identification */
 #define DEVICE_FS 						0
@@ -40,3 +40,30 @@ void USB_Device_Init(void)
 	if (USBD_OK != USBD_MSC_RegisterStorage(&hUsbDeviceFS, &USBD_Storage_Interface_fops_FS)){BSP_Error_Handler();}
 	if (USBD_OK != USBD_Start(&hUsbDeviceFS)){BSP_Error_Handler();}
 }
+
+/**
+  ***************************************************************************************************************************************
+  * Stop and deinit USB device Library, the host loses the mass storage
+  * @param None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void USB_Device_DeInit(void)
+{
+	if (USBD_OK != USBD_Stop(&hUsbDeviceFS)){BSP_Error_Handler();}
+	if (USBD_OK != USBD_DeInit(&hUsbDeviceFS)){BSP_Error_Handler();}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * Medium eject status, set by the SCSI START STOP UNIT command of the host
+  * @param None
+  * @retval Ejected flag (uint8_t)
+  ***************************************************************************************************************************************
+  */
+uint8_t USB_Device_Get_Eject_Flag(void)
+{
+	USBD_MSC_BOT_HandleTypeDef* _hmsc = (USBD_MSC_BOT_HandleTypeDef*)hUsbDeviceFS.pClassData;
+
+	return ((NULL != _hmsc) && (SCSI_MEDIUM_EJECTED == _hmsc->scsi_medium_state));
+}
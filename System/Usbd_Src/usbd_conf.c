@@ -54,7 +54,7 @@ void HAL_PCD_MspInit(PCD_HandleTypeDef* pcdHandle)
 		/* Peripheral clock enable */
 		__HAL_RCC_USB_CLK_ENABLE();
 		/* Peripheral interrupt init */
-		HAL_NVIC_SetPriority(USB_IRQn, 0U, 0U);
+		HAL_NVIC_SetPriority(USB_IRQn, USBD_IRQ_PRIORITY, 0U);
 		HAL_NVIC_EnableIRQ(USB_IRQn);
 	}
 }
@@ -16,10 +16,13 @@
 
 #include "usbd_storage_if.h"
 #include "n25q512a_qspi.h"
+#include "ff_gen_drv.h"
+#include "ff_diskio.h"
+#include "ff_ftl.h"
 
 #define STORAGE_LUN_NBR                  1
-#define STORAGE_BLK_NBR                  0x4000
-#define STORAGE_BLK_SIZ                  0x1000
+#define STORAGE_BLK_NBR                  DISKIO_BLK_NBR
+#define STORAGE_BLK_SIZ                  DISKIO_BLK_SIZ
 
 /* USB Mass storage Standard Inquiry Data */
 const int8_t STORAGE_Inquirydata_FS[]={
@@ -47,6 +50,7 @@ static int8_t STORAGE_IsWriteProtected_FS(uint8_t lun);
 static int8_t STORAGE_Read_FS(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
 static int8_t STORAGE_Write_FS(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
 static int8_t STORAGE_GetMaxLun_FS(void);
+static int8_t STORAGE_Unmap_FS(uint8_t lun, uint32_t blk_addr, uint32_t blk_len);
 
 USBD_StorageTypeDef USBD_Storage_Interface_fops_FS={
 	STORAGE_Init_FS,
@@ -56,7 +60,8 @@ USBD_StorageTypeDef USBD_Storage_Interface_fops_FS={
 	STORAGE_Read_FS,
 	STORAGE_Write_FS,
 	STORAGE_GetMaxLun_FS,
-	(int8_t *)STORAGE_Inquirydata_FS
+	(int8_t *)STORAGE_Inquirydata_FS,
+	STORAGE_Unmap_FS
 };
 
 /**
@@ -70,8 +75,12 @@ int8_t STORAGE_Init_FS(uint8_t lun)
 {
 	if(BSP_QSPI_Get_Lock_Flag()){return USBD_FAIL;}
 
-	if(BSP_QSPI_Get_Init_Flag()){return USBD_OK;}
-	else if(QSPI_OK != BSP_QSPI_Init()){return USBD_FAIL;}
+	/* The host reads and writes the volume around the FatFs write-back cache, it is emptied first */
+	if(RES_OK != DISKIO_Cache_Flush()){return USBD_FAIL;}
+	DISKIO_Cache_Invalidate();
+
+	if((!BSP_QSPI_Get_Init_Flag()) && (QSPI_OK != BSP_QSPI_Init())){return USBD_FAIL;}
+	if(RES_OK != FF_FTL_Mount()){return USBD_FAIL;}
 
 	return USBD_OK;
 }
@@ -133,12 +142,10 @@ int8_t STORAGE_IsWriteProtected_FS(uint8_t lun)
   */
 int8_t STORAGE_Read_FS(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
 {
-	uint32_t bufferSize = (STORAGE_BLK_SIZ * blk_len);
-	uint32_t address = (blk_addr * STORAGE_BLK_SIZ);
-
+	/* Only an interrupted blocking function fails the command, a queued erase is suspended by the read */
 	if(BSP_QSPI_Get_Lock_Flag()){return USBD_FAIL;}
 
-	if(QSPI_OK != BSP_QSPI_Read(buf,address,bufferSize)){return USBD_FAIL;}
+	if(RES_OK != DISKIO_Read_Sectors(buf, blk_addr, blk_len)){return USBD_FAIL;}
 
 	return USBD_OK;
 }
@@ -152,20 +159,11 @@ int8_t STORAGE_Read_FS(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t bl
   */
 int8_t STORAGE_Write_FS(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
 {
-	uint32_t subsectorAddr = (blk_addr * STORAGE_BLK_SIZ);
-	uint32_t bufferSize = (STORAGE_BLK_SIZ * blk_len);
-	uint32_t address = (blk_addr * STORAGE_BLK_SIZ);
-	uint32_t i;
-
+	/* Only an interrupted blocking function fails the command, the write waits for a queued erase */
 	if(BSP_QSPI_Get_Lock_Flag()){return USBD_FAIL;}
 
-	for(i=0;i<blk_len;i++)
-	{
-		if(QSPI_OK != BSP_QSPI_Erase_Block(subsectorAddr)){return USBD_FAIL;}
-		subsectorAddr += STORAGE_BLK_SIZ;
-	}
-
-	if(QSPI_OK != BSP_QSPI_Write(buf, address, bufferSize)){return USBD_FAIL;}
+	/* Sectors the host rewrites unchanged are skipped, see DISKIO_Write_Sectors */
+	if(RES_OK != DISKIO_Write_Sectors(buf, blk_addr, blk_len)){return USBD_FAIL;}
 
 	return USBD_OK;
 }
@@ -181,3 +179,19 @@ int8_t STORAGE_GetMaxLun_FS(void)
 {
 	return (STORAGE_LUN_NBR - 1U);
 }
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Storage unmap, the blocks the host discards are erased ahead of time by the FTL idle task
+  * @param  lun:
+  * @retval USBD_OK if all operations are OK else USBD_FAIL
+  ***************************************************************************************************************************************
+  */
+int8_t STORAGE_Unmap_FS(uint8_t lun, uint32_t blk_addr, uint32_t blk_len)
+{
+	if(BSP_QSPI_Get_Lock_Flag()){return USBD_FAIL;}
+
+	if(RES_OK != DISKIO_Trim_Sectors(blk_addr, blk_len)){return USBD_FAIL;}
+
+	return USBD_OK;
+}
@@ -0,0 +1,12 @@
+#ifndef __HOST_BSP_H
+#define __HOST_BSP_H
+
+#include "stm32l4xx_hal.h"
+
+/* Exit code of a run the firmware would have stopped in BSP_Error_Handler */
+#define HOST_EXIT_ERROR_HANDLER		2
+
+/* Global functions prototypes */
+void BSP_Error_Handler(void) __attribute__((noreturn)); /* The firmware one never returns either */
+
+#endif
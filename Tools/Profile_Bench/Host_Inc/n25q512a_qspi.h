@@ -0,0 +1,71 @@
+#ifndef __HOST_N25Q512A_QSPI_H
+#define __HOST_N25Q512A_QSPI_H
+
+/* Host stand-in for the QSPI driver: the memory is a file mapped into the process, a program clears bits and an erase sets
+   them like the NOR array does. The asynchronous requests run to their end inside BSP_QSPI_Submit. */
+#include "stm32l4xx_hal.h"
+#include "n25q512a.h"
+#include "bsp.h"
+
+/* QSPI Error codes */
+#define QSPI_OK            ((uint8_t)0x00)
+#define QSPI_ERROR         ((uint8_t)0x01)
+#define QSPI_BUSY          ((uint8_t)0x02)
+#define QSPI_NOT_SUPPORTED ((uint8_t)0x04)
+#define QSPI_SUSPENDED     ((uint8_t)0x08)
+
+/* Asynchronous request types */
+#define QSPI_REQUEST_READ				((uint8_t)0x00)
+#define QSPI_REQUEST_PROGRAM			((uint8_t)0x01)
+#define QSPI_REQUEST_ERASE_BLOCK		((uint8_t)0x02)
+#define QSPI_REQUEST_ERASE_SECTOR		((uint8_t)0x03)
+
+/* Read mode pattern in the last subsector of the memory */
+#define QSPI_BENCH_ADDR					(N25Q512A_FLASH_SIZE - N25Q512A_SUBSECTOR_SIZE)
+#define QSPI_BENCH_PATTERN(_idx)		((uint8_t)(((_idx) * 0x4DU) + 0x5AU))
+#define QSPI_BENCH_SIZE					256U
+
+/* The memory-mapped window is the mapped file */
+#define QSPI_BASE						((uintptr_t)HOST_QSPI_Memory)
+
+/* QSPI asynchronous request, owned by the caller until its status leaves QSPI_BUSY */
+typedef struct QSPI_Request QSPI_RequestTypeDef;
+struct QSPI_Request{
+	uint8_t Type;
+	__IO uint8_t Status;
+	uint8_t* pData;
+	uint32_t Address;
+	uint32_t Size;
+	void (*Callback)(QSPI_RequestTypeDef* pRequest);
+	void* pContext;
+	uint32_t Offset;
+};
+
+/* Host memory statistics, the reads through the memory-mapped window are not counted */
+typedef struct{
+	uint32_t ReadNbr;
+	uint32_t ReadBytes;
+	uint32_t ProgramBytes;
+	uint32_t EraseBlockNbr;
+	uint32_t EraseSectorNbr;
+}HOST_QSPI_StatsTypeDef;
+
+extern uint8_t* HOST_QSPI_Memory;
+
+uint8_t HOST_QSPI_Open(const char* pPath, uint8_t BlankFlag);
+void HOST_QSPI_Close(void);
+const HOST_QSPI_StatsTypeDef* HOST_QSPI_Get_Stats(void);
+uint8_t BSP_QSPI_Init(void);
+uint8_t BSP_QSPI_Get_Init_Flag(void);
+uint8_t BSP_QSPI_Get_Lock_Flag(void);
+uint8_t BSP_QSPI_Write_Bench_Pattern(void);
+uint8_t BSP_QSPI_Read(uint8_t* pData, uint32_t ReadAddr, uint32_t Size);
+uint8_t BSP_QSPI_Write(uint8_t* pData, uint32_t WriteAddr, uint32_t Size);
+uint8_t BSP_QSPI_Erase_Block(uint32_t BlockAddress);
+uint8_t BSP_QSPI_Erase_Sector(uint32_t SectorAddress);
+uint8_t BSP_QSPI_EnableMemoryMappedMode(void);
+uint8_t BSP_QSPI_Submit(QSPI_RequestTypeDef* pRequest);
+uint8_t BSP_QSPI_Wait(QSPI_RequestTypeDef* pRequest);
+uint8_t BSP_QSPI_Get_Busy_Flag(void);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef __HOST_STM32L4XX_HAL_H
+#define __HOST_STM32L4XX_HAL_H
+
+/* Host stand-in for the HAL and CMSIS parts the profile, the disk layer and the FTL use. The cycle counter follows the host
+   clock at SystemCoreClock, the CRC unit is computed in software with the configuration of FF_PROFILE_CRC_Init. */
+#include <stdint.h>
+#include <stddef.h>
+
+#define __IO						volatile
+#define __ALIGNED(_x)				__attribute__((aligned(_x)))
+#define __weak						__attribute__((weak))
+
+typedef enum {
+	HAL_OK = 0x00U,
+	HAL_ERROR = 0x01U,
+	HAL_BUSY = 0x02U,
+	HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/* Cycle counter, every access to DWT reads the host clock */
+typedef struct {
+	__IO uint32_t CTRL;
+	__IO uint32_t CYCCNT;
+} host_dwt_ts;
+
+typedef struct {
+	__IO uint32_t DEMCR;
+} host_core_debug_ts;
+
+#define DWT							(HOST_DWT())
+#define CoreDebug					(&HOST_CoreDebug)
+#define DWT_CTRL_CYCCNTENA_Msk		0x00000001UL
+#define CoreDebug_DEMCR_TRCENA_Msk	0x01000000UL
+
+/* CRC unit */
+#define CRC							((void*)0)
+#define DEFAULT_POLYNOMIAL_ENABLE	((uint8_t)0x00U)
+#define DEFAULT_INIT_VALUE_ENABLE	((uint8_t)0x00U)
+#define CRC_INPUTDATA_INVERSION_BYTE	0x00000020UL
+#define CRC_OUTPUTDATA_INVERSION_ENABLE	0x00000080UL
+#define CRC_INPUTDATA_FORMAT_BYTES	0x00000001UL
+
+typedef struct {
+	uint8_t DefaultPolynomialUse;
+	uint8_t DefaultInitValueUse;
+	uint32_t InputDataInversionMode;
+	uint32_t OutputDataInversionMode;
+} CRC_InitTypeDef;
+
+typedef struct {
+	void* Instance;
+	CRC_InitTypeDef Init;
+	uint32_t InputDataFormat;
+} CRC_HandleTypeDef;
+
+#define __HAL_RCC_CRC_CLK_ENABLE()	do{}while(0)
+#define __HAL_CRC_DR_RESET(_handle)	HOST_CRC_Reset(_handle)
+
+extern uint32_t SystemCoreClock;
+extern host_core_debug_ts HOST_CoreDebug;
+
+host_dwt_ts* HOST_DWT(void);
+void HOST_CRC_Reset(CRC_HandleTypeDef* _handle);
+uint32_t HAL_GetTick(void);
+HAL_StatusTypeDef HAL_CRC_Init(CRC_HandleTypeDef* _handle);
+uint32_t HAL_CRC_Accumulate(CRC_HandleTypeDef* _handle, uint32_t* _buffer, uint32_t _length);
+uint32_t __get_MSP(void);
+
+#endif
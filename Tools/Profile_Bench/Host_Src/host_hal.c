@@ -0,0 +1,155 @@
+/**
+  ***************************************************************************************************************************************
+  * @file     host_hal.c
+  * @owner    SimonBat
+  * @version  v0.0.1
+  * @date     2021.09.06
+  * @update   2021.09.06
+  * @brief    sentinel v1.0
+  ***************************************************************************************************************************************
+  * @attention
+  *
+  * Host stand-in for the HAL tick, the DWT cycle counter, the CRC unit and the board error handler of the profile bench.
+  *
+  ***************************************************************************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "stm32l4xx_hal.h"
+#include "bsp.h"
+
+#define HOST_CRC_INIT		0xFFFFFFFFUL
+#define HOST_CRC_POLY		0xEDB88320UL /* 0x04C11DB7 bit reversed, the input and the output of the unit are inverted */
+
+/* Global variables */
+uint32_t SystemCoreClock = 80000000UL;
+host_core_debug_ts HOST_CoreDebug;
+static host_dwt_ts HOST_Dwt;
+static uint32_t HOST_CrcTable[256];
+static uint32_t HOST_Crc;
+
+static uint64_t HOST_Get_Ns(void);
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Cycle counter, refreshed from the host clock on every access
+  * @param  None
+  * @retval Counter registers (host_dwt_ts*)
+  ***************************************************************************************************************************************
+  */
+host_dwt_ts* HOST_DWT(void)
+{
+	HOST_Dwt.CYCCNT = (uint32_t)((HOST_Get_Ns() * (SystemCoreClock / 1000000UL)) / 1000U);
+	return &HOST_Dwt;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Milliseconds of the host clock
+  * @param  None
+  * @retval Tick (uint32_t)
+  ***************************************************************************************************************************************
+  */
+uint32_t HAL_GetTick(void)
+{
+	return (uint32_t)(HOST_Get_Ns() / 1000000U);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  CRC unit initialization, the default polynomial and init value with the byte input and the output inverted
+  * @param  Handle (CRC_HandleTypeDef*)
+  * @retval HAL status
+  ***************************************************************************************************************************************
+  */
+HAL_StatusTypeDef HAL_CRC_Init(CRC_HandleTypeDef* _handle)
+{
+	uint32_t _crc;
+
+	if((DEFAULT_POLYNOMIAL_ENABLE != _handle->Init.DefaultPolynomialUse) || (DEFAULT_INIT_VALUE_ENABLE != _handle->Init.DefaultInitValueUse) || \
+	   (CRC_INPUTDATA_INVERSION_BYTE != _handle->Init.InputDataInversionMode) || \
+	   (CRC_OUTPUTDATA_INVERSION_ENABLE != _handle->Init.OutputDataInversionMode) || (CRC_INPUTDATA_FORMAT_BYTES != _handle->InputDataFormat))
+	{return HAL_ERROR;}
+
+	for(uint32_t _idx = 0U; _idx < 256U; _idx++)
+	{
+		_crc = _idx;
+		for(uint8_t _bit = 0U; _bit < 8U; _bit++){_crc = (_crc & 1U) ? ((_crc >> 1U) ^ HOST_CRC_POLY) : (_crc >> 1U);}
+		HOST_CrcTable[_idx] = _crc;
+	}
+
+	HOST_Crc = HOST_CRC_INIT;
+	return HAL_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  CRC unit data register reset
+  * @param  Handle (CRC_HandleTypeDef*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void HOST_CRC_Reset(CRC_HandleTypeDef* _handle)
+{
+	(void)_handle;
+	HOST_Crc = HOST_CRC_INIT;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  CRC unit accumulate, the buffer holds bytes
+  * @param  Handle (CRC_HandleTypeDef*), buffer (uint32_t*), length in bytes (uint32_t)
+  * @retval CRC (uint32_t)
+  ***************************************************************************************************************************************
+  */
+uint32_t HAL_CRC_Accumulate(CRC_HandleTypeDef* _handle, uint32_t* _buffer, uint32_t _length)
+{
+	const uint8_t* _byte = (const uint8_t*)_buffer;
+
+	(void)_handle;
+	for(uint32_t _idx = 0U; _idx < _length; _idx++){HOST_Crc = (HOST_Crc >> 8U) ^ HOST_CrcTable[(HOST_Crc ^ _byte[_idx]) & 0xFFU];}
+
+	return HOST_Crc;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Stack pointer, the bench runs the profile on a stack below 4 GB (see profile_bench.c)
+  * @param  None
+  * @retval Stack pointer (uint32_t)
+  ***************************************************************************************************************************************
+  */
+uint32_t __get_MSP(void)
+{
+	return (uint32_t)(uintptr_t)__builtin_frame_address(0);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  The firmware powers off here, the run ends with HOST_EXIT_ERROR_HANDLER
+  * @param  None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void BSP_Error_Handler(void)
+{
+	fprintf(stderr, "BSP_Error_Handler called from %p\n", __builtin_return_address(0));
+	exit(HOST_EXIT_ERROR_HANDLER);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Monotonic host clock
+  * @param  None
+  * @retval Nanoseconds (uint64_t)
+  ***************************************************************************************************************************************
+  */
+static uint64_t HOST_Get_Ns(void)
+{
+	struct timespec _time;
+
+	clock_gettime(CLOCK_MONOTONIC, &_time);
+	return ((uint64_t)_time.tv_sec * 1000000000ULL) + (uint64_t)_time.tv_nsec;
+}
@@ -0,0 +1,289 @@
+/**
+  ***************************************************************************************************************************************
+  * @file     host_qspi.c
+  * @owner    SimonBat
+  * @version  v0.0.1
+  * @date     2021.09.06
+  * @update   2021.09.06
+  * @brief    sentinel v1.0
+  ***************************************************************************************************************************************
+  * @attention
+  *
+  * Host stand-in for the N25Q512A QSPI driver. The memory is an image file mapped into the process, it keeps the volume, the
+  * FTL tables and the reserved block from one run to the next like the flash does across power cycles.
+  *
+  ***************************************************************************************************************************************
+  */
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "n25q512a_qspi.h"
+
+/* Global variables */
+uint8_t* HOST_QSPI_Memory = NULL;
+static int HOST_QSPI_File = -1;
+static uint8_t HOST_QSPI_InitFlag = 0U;
+static HOST_QSPI_StatsTypeDef HOST_QSPI_Stats;
+
+static uint8_t HOST_QSPI_Range(uint32_t _addr, uint32_t _size);
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Map the memory image, a blank image is created erased
+  * @param  Image path (const char*), blank flag (uint8_t)
+  * @retval QSPI memory status
+  ***************************************************************************************************************************************
+  */
+uint8_t HOST_QSPI_Open(const char* pPath, uint8_t BlankFlag)
+{
+	HOST_QSPI_File = open(pPath, (BlankFlag ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR), 0644);
+	if(HOST_QSPI_File < 0){return QSPI_ERROR;}
+
+	if((BlankFlag) && (0 != ftruncate(HOST_QSPI_File, N25Q512A_FLASH_SIZE))){return QSPI_ERROR;}
+	if(N25Q512A_FLASH_SIZE != lseek(HOST_QSPI_File, 0, SEEK_END)){return QSPI_ERROR;}
+
+	HOST_QSPI_Memory = mmap(NULL, N25Q512A_FLASH_SIZE, (PROT_READ | PROT_WRITE), MAP_SHARED, HOST_QSPI_File, 0);
+	if(MAP_FAILED == HOST_QSPI_Memory)
+	{
+		HOST_QSPI_Memory = NULL;
+		return QSPI_ERROR;
+	}
+
+	if(BlankFlag){memset(HOST_QSPI_Memory, 0xFF, N25Q512A_FLASH_SIZE);}
+
+	return QSPI_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Write the memory image back and unmap it
+  * @param  None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+void HOST_QSPI_Close(void)
+{
+	if(NULL != HOST_QSPI_Memory)
+	{
+		msync(HOST_QSPI_Memory, N25Q512A_FLASH_SIZE, MS_SYNC);
+		munmap(HOST_QSPI_Memory, N25Q512A_FLASH_SIZE);
+		HOST_QSPI_Memory = NULL;
+	}
+
+	if(HOST_QSPI_File >= 0){close(HOST_QSPI_File);}
+	HOST_QSPI_File = -1;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Get the memory access statistics
+  * @param  None
+  * @retval Statistics (const HOST_QSPI_StatsTypeDef*)
+  ***************************************************************************************************************************************
+  */
+const HOST_QSPI_StatsTypeDef* HOST_QSPI_Get_Stats(void)
+{
+	return &HOST_QSPI_Stats;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Initialize the memory, the image has to be mapped
+  * @param  None
+  * @retval QSPI memory status
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Init(void)
+{
+	if(NULL == HOST_QSPI_Memory){return QSPI_ERROR;}
+
+	HOST_QSPI_InitFlag = 1U;
+	return QSPI_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Get the init flag
+  * @param  None
+  * @retval Init flag (uint8_t)
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Get_Init_Flag(void)
+{
+	return HOST_QSPI_InitFlag;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Get the lock flag, never set as every access runs to its end at once
+  * @param  None
+  * @retval Lock flag (uint8_t)
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Get_Lock_Flag(void)
+{
+	return 0U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Get the busy flag, no request is ever queued
+  * @param  None
+  * @retval Busy flag (uint8_t)
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Get_Busy_Flag(void)
+{
+	return 0U;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Memory mapped mode, QSPI_BASE always maps the image
+  * @param  None
+  * @retval QSPI memory status
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_EnableMemoryMappedMode(void)
+{
+	return QSPI_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Program the read mode pattern once the subsector is free, like the driver it is left alone when it reads back
+  * @param  None
+  * @retval QSPI memory status
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Write_Bench_Pattern(void)
+{
+	uint8_t _pattern[QSPI_BENCH_SIZE];
+
+	for(uint32_t _idx = 0U; _idx < QSPI_BENCH_SIZE; _idx++){_pattern[_idx] = QSPI_BENCH_PATTERN(_idx);}
+	if(0 == memcmp(&HOST_QSPI_Memory[QSPI_BENCH_ADDR], _pattern, QSPI_BENCH_SIZE)){return QSPI_OK;}
+
+	if(QSPI_OK != BSP_QSPI_Erase_Block(QSPI_BENCH_ADDR)){return QSPI_ERROR;}
+	return BSP_QSPI_Write(_pattern, QSPI_BENCH_ADDR, QSPI_BENCH_SIZE);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Read
+  * @param  Data (uint8_t*), address (uint32_t), size (uint32_t)
+  * @retval QSPI memory status
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Read(uint8_t* pData, uint32_t ReadAddr, uint32_t Size)
+{
+	if(!HOST_QSPI_Range(ReadAddr, Size)){return QSPI_ERROR;}
+
+	memcpy(pData, &HOST_QSPI_Memory[ReadAddr], Size);
+	HOST_QSPI_Stats.ReadNbr++;
+	HOST_QSPI_Stats.ReadBytes += Size;
+	return QSPI_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Program, a bit is only cleared like in the NOR array
+  * @param  Data (uint8_t*), address (uint32_t), size (uint32_t)
+  * @retval QSPI memory status
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Write(uint8_t* pData, uint32_t WriteAddr, uint32_t Size)
+{
+	if(!HOST_QSPI_Range(WriteAddr, Size)){return QSPI_ERROR;}
+
+	for(uint32_t _idx = 0U; _idx < Size; _idx++){HOST_QSPI_Memory[WriteAddr + _idx] &= pData[_idx];}
+	HOST_QSPI_Stats.ProgramBytes += Size;
+	return QSPI_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Erase the subsector holding the address
+  * @param  Address (uint32_t)
+  * @retval QSPI memory status
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Erase_Block(uint32_t BlockAddress)
+{
+	BlockAddress &= ~(N25Q512A_SUBSECTOR_SIZE - 1U);
+	if(!HOST_QSPI_Range(BlockAddress, N25Q512A_SUBSECTOR_SIZE)){return QSPI_ERROR;}
+
+	memset(&HOST_QSPI_Memory[BlockAddress], 0xFF, N25Q512A_SUBSECTOR_SIZE);
+	HOST_QSPI_Stats.EraseBlockNbr++;
+	return QSPI_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Erase the sector holding the address
+  * @param  Address (uint32_t)
+  * @retval QSPI memory status
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Erase_Sector(uint32_t SectorAddress)
+{
+	SectorAddress &= ~(N25Q512A_SECTOR_SIZE - 1U);
+	if(!HOST_QSPI_Range(SectorAddress, N25Q512A_SECTOR_SIZE)){return QSPI_ERROR;}
+
+	memset(&HOST_QSPI_Memory[SectorAddress], 0xFF, N25Q512A_SECTOR_SIZE);
+	HOST_QSPI_Stats.EraseSectorNbr++;
+	return QSPI_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Run an asynchronous request to its end at once, the completion callback is called before the return
+  * @param  Request (QSPI_RequestTypeDef*)
+  * @retval QSPI memory status
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Submit(QSPI_RequestTypeDef* pRequest)
+{
+	uint8_t _status;
+
+	if((NULL == pRequest) || (pRequest->Type > QSPI_REQUEST_ERASE_SECTOR)){return QSPI_ERROR;}
+
+	switch(pRequest->Type)
+	{
+		case(QSPI_REQUEST_READ): _status = BSP_QSPI_Read(pRequest->pData, pRequest->Address, pRequest->Size); break;
+		case(QSPI_REQUEST_PROGRAM): _status = BSP_QSPI_Write(pRequest->pData, pRequest->Address, pRequest->Size); break;
+		case(QSPI_REQUEST_ERASE_BLOCK): _status = BSP_QSPI_Erase_Block(pRequest->Address); break;
+		default: _status = BSP_QSPI_Erase_Sector(pRequest->Address); break;
+	}
+
+	pRequest->Offset = pRequest->Size;
+	pRequest->Status = (QSPI_OK == _status) ? QSPI_OK : QSPI_ERROR;
+	if(NULL != pRequest->Callback){pRequest->Callback(pRequest);}
+
+	return QSPI_OK;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Wait for a request, it already ended in BSP_QSPI_Submit()
+  * @param  Request (QSPI_RequestTypeDef*)
+  * @retval Request status
+  ***************************************************************************************************************************************
+  */
+uint8_t BSP_QSPI_Wait(QSPI_RequestTypeDef* pRequest)
+{
+	return pRequest->Status;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Check an access stays inside the memory
+  * @param  Address (uint32_t), size (uint32_t)
+  * @retval Inside (uint8_t)
+  ***************************************************************************************************************************************
+  */
+static uint8_t HOST_QSPI_Range(uint32_t _addr, uint32_t _size)
+{
+	return ((NULL != HOST_QSPI_Memory) && (_addr <= N25Q512A_FLASH_SIZE) && (_size <= (N25Q512A_FLASH_SIZE - _addr)));
+}
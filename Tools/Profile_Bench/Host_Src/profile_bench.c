@@ -0,0 +1,252 @@
+/**
+  ***************************************************************************************************************************************
+  * @file     profile_bench.c
+  * @owner    SimonBat
+  * @version  v0.0.1
+  * @date     2021.09.06
+  * @update   2021.09.06
+  * @brief    sentinel v1.0
+  ***************************************************************************************************************************************
+  * @attention
+  *
+  * Host bench of the vault load. ff_profile.c, the disk layer, the FTL and FatFs are built unchanged for Linux, the QSPI memory
+  * is an image file (host_qspi.c). A run boots the image like a power-up and loads the vault, optionally after an edit: the
+  * files given with -p are copied into the volume and the vault is reloaded like after a USB edit. With -n the image starts
+  * erased and is formatted first, like the confirmed EDIT of a blank device. A run with -x only inverts a byte of data.bin.
+  *
+  * The load runs on a stack of its own below 4 GB, so that the stack paint of the profile measures it. The times are host
+  * times, the counters (f_read calls and bytes, steps, sizes) are the ones the firmware reports over SWO.
+  *
+  * Exit code: 0 when the vault loaded, HOST_EXIT_ERROR_HANDLER when the firmware would have stopped in BSP_Error_Handler,
+  * 1 on a usage or host error.
+  *
+  ***************************************************************************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include "ff_profile.h"
+#include "ff_diskio.h"
+#include "n25q512a_qspi.h"
+
+#define BENCH_FILE_NBR		(FF_PROFILE_SOURCE_NBR + 1U)
+#define BENCH_EXIT_HOST		1
+
+typedef struct {
+	const char* hostPath;
+	const char* volumePath;
+} bench_file_ts;
+
+typedef struct {
+	const char* imagePath;
+	bench_file_ts file[BENCH_FILE_NBR];
+	uint8_t fileNbr;
+	uint8_t blankFlag;
+	uint8_t flipFlag;
+	long flipOffset; /* Byte of data.bin to invert, from the end when negative */
+} bench_ts;
+
+/* Global variables */
+static bench_ts BENCH;
+static ucontext_t BENCH_MainContext;
+static ucontext_t BENCH_LoadContext;
+static FATFS BENCH_Fs;
+static FIL BENCH_File;
+static uint8_t BENCH_Buffer[DISKIO_BLK_SIZ];
+uint8_t HOST_Stack[HOST_STACK_SIZE] __attribute__((aligned(16))); /* _estack and _Min_Stack_Size are linked on it */
+
+static void BENCH_Run(void);
+static void BENCH_Load(const char* _name, uint8_t _reloadFlag);
+static void BENCH_Copy_File(const bench_file_ts* _file);
+static void BENCH_Flip_Image(long _offset);
+static void BENCH_Fail(const char* _what);
+static void BENCH_Usage(const char* _name);
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Bench entry point
+  * @param  Arguments
+  * @retval Exit code
+  ***************************************************************************************************************************************
+  */
+int main(int argc, char* argv[])
+{
+	char* _split;
+
+	for(int _idx = 1; _idx < argc; _idx++)
+	{
+		if((0 == strcmp(argv[_idx], "-i")) && ((_idx + 1) < argc)){BENCH.imagePath = argv[++_idx];}
+		else if(0 == strcmp(argv[_idx], "-n")){BENCH.blankFlag = 1U;}
+		else if((0 == strcmp(argv[_idx], "-x")) && ((_idx + 1) < argc)){BENCH.flipFlag = 1U; BENCH.flipOffset = strtol(argv[++_idx], NULL, 0);}
+		else if((0 == strcmp(argv[_idx], "-p")) && ((_idx + 1) < argc) && (BENCH.fileNbr < BENCH_FILE_NBR))
+		{
+			_split = strchr(argv[++_idx], '=');
+			if(NULL == _split){BENCH_Usage(argv[0]);}
+
+			*_split = '\0';
+			BENCH.file[BENCH.fileNbr].hostPath = argv[_idx];
+			BENCH.file[BENCH.fileNbr].volumePath = (_split + 1);
+			BENCH.fileNbr++;
+		}
+		else{BENCH_Usage(argv[0]);}
+	}
+
+	if(NULL == BENCH.imagePath){BENCH_Usage(argv[0]);}
+	if(QSPI_OK != HOST_QSPI_Open(BENCH.imagePath, BENCH.blankFlag)){BENCH_Fail("cannot map the memory image");}
+
+	/* The load runs on HOST_Stack */
+	if(0 != getcontext(&BENCH_LoadContext)){BENCH_Fail("getcontext");}
+	BENCH_LoadContext.uc_stack.ss_sp = HOST_Stack;
+	BENCH_LoadContext.uc_stack.ss_size = sizeof(HOST_Stack);
+	BENCH_LoadContext.uc_link = &BENCH_MainContext;
+	makecontext(&BENCH_LoadContext, BENCH_Run, 0);
+	if(0 != swapcontext(&BENCH_MainContext, &BENCH_LoadContext)){BENCH_Fail("swapcontext");}
+
+	HOST_QSPI_Close();
+	return 0;
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Power-up load, then the edit and the reload when files are given
+  * @param  None
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void BENCH_Run(void)
+{
+	FF_PROFILE_Init();
+
+	/* The corruption runs on its own, the load keeps data.bin open */
+	if(BENCH.flipFlag){BENCH_Flip_Image(BENCH.flipOffset);}
+	else
+	{
+		BENCH_Load("boot", 0U);
+
+		if(BENCH.blankFlag)
+		{
+			if(!FF_PROFILE_Get_Stats()->blankFlag){BENCH_Fail("the erased image holds a volume");}
+			FF_PROFILE_Format();
+		}
+
+		if(BENCH.fileNbr)
+		{
+			for(uint8_t _idx = 0U; _idx < BENCH.fileNbr; _idx++){BENCH_Copy_File(&BENCH.file[_idx]);}
+			BENCH_Load("reload", 1U);
+		}
+	}
+
+	/* The idle flush of the firmware, the image keeps the writes for the next run */
+	if(RES_OK != DISKIO_Cache_Flush()){BENCH_Fail("cache flush");}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Run a load to its end and report it on one line of name=value pairs
+  * @param  Load name (const char*), reload flag (uint8_t)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void BENCH_Load(const char* _name, uint8_t _reloadFlag)
+{
+	const profile_stats_ts* _stats = FF_PROFILE_Get_Stats();
+	const HOST_QSPI_StatsTypeDef* _qspiStats = HOST_QSPI_Get_Stats();
+	HOST_QSPI_StatsTypeDef _qspiStart = *_qspiStats;
+	uint32_t _cycles = DWT->CYCCNT;
+
+	if(_reloadFlag){FF_PROFILE_Reload();}
+	else{while(!FF_PROFILE_Load_Task()){}}
+
+	_cycles = (DWT->CYCCNT - _cycles) / (SystemCoreClock / 1000000U);
+
+	printf("%s: entries=%u sources=%u parsed=%u compiled=%u blank=%u load_us=%lu load_ms=%lu steps=%u step_max_us=%lu f_read=%lu f_read_bytes=%lu " \
+		   "stack=%lu static=%lu ram=%lu qspi_reads=%lu qspi_read_bytes=%lu program_bytes=%lu erases=%lu\n", \
+		   _name, _stats->dataNbr, _stats->sourceNbr, _stats->parseNbr, _stats->compileFlag, _stats->blankFlag, (unsigned long)_cycles, \
+		   (unsigned long)_stats->loadTime, _stats->loadStepNbr, (unsigned long)_stats->loadStepMax, (unsigned long)_stats->readCalls, \
+		   (unsigned long)_stats->readBytes, (unsigned long)_stats->stackPeak, (unsigned long)_stats->staticSize, \
+		   (unsigned long)(_stats->staticSize + _stats->stackPeak), (unsigned long)(_qspiStats->ReadNbr - _qspiStart.ReadNbr), \
+		   (unsigned long)(_qspiStats->ReadBytes - _qspiStart.ReadBytes), (unsigned long)(_qspiStats->ProgramBytes - _qspiStart.ProgramBytes), \
+		   (unsigned long)((_qspiStats->EraseBlockNbr - _qspiStart.EraseBlockNbr) + (_qspiStats->EraseSectorNbr - _qspiStart.EraseSectorNbr)));
+	fflush(stdout);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Copy a host file into the volume, like the host does over USB
+  * @param  File (const bench_file_ts*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void BENCH_Copy_File(const bench_file_ts* _file)
+{
+	FILE* _hostFile = fopen(_file->hostPath, "rb");
+	size_t _len;
+	UINT _bytesWritten;
+
+	if(NULL == _hostFile){BENCH_Fail(_file->hostPath);}
+	if(FR_OK != f_open(&BENCH_File, _file->volumePath, (FA_CREATE_ALWAYS | FA_WRITE))){BENCH_Fail(_file->volumePath);}
+
+	while(0U != (_len = fread(BENCH_Buffer, 1U, sizeof(BENCH_Buffer), _hostFile)))
+	{
+		if((FR_OK != f_write(&BENCH_File, BENCH_Buffer, (UINT)_len, &_bytesWritten)) || (_len != _bytesWritten)){BENCH_Fail(_file->volumePath);}
+	}
+
+	fclose(_hostFile);
+	if(FR_OK != f_close(&BENCH_File)){BENCH_Fail(_file->volumePath);}
+	if(RES_OK != DISKIO_Cache_Flush()){BENCH_Fail("cache flush");}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Invert a byte of data.bin without a load, the next boot has to find the image corrupt
+  * @param  Offset in the file, from its end when negative (long)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void BENCH_Flip_Image(long _offset)
+{
+	uint8_t _byte;
+	UINT _bytes;
+
+	if(FR_OK != f_mount(&BENCH_Fs, "", 1U)){BENCH_Fail("no volume");}
+	if(FR_OK != f_open(&BENCH_File, FF_PROFILE_IMAGE_FNAME, (FA_READ | FA_WRITE))){BENCH_Fail("no data.bin to corrupt");}
+	if(_offset < 0){_offset += (long)f_size(&BENCH_File);}
+	/* A seek beyond the end would extend the file */
+	if((_offset < 0) || (_offset >= (long)f_size(&BENCH_File))){BENCH_Fail("data.bin offset");}
+	if((FR_OK != f_lseek(&BENCH_File, (FSIZE_t)_offset)) || (FR_OK != f_read(&BENCH_File, &_byte, 1U, &_bytes)) || (1U != _bytes))
+	{BENCH_Fail("data.bin offset");}
+
+	_byte ^= 0xFFU;
+	if((FR_OK != f_lseek(&BENCH_File, (FSIZE_t)_offset)) || (FR_OK != f_write(&BENCH_File, &_byte, 1U, &_bytes)) || (1U != _bytes))
+	{BENCH_Fail("data.bin write");}
+	if(FR_OK != f_close(&BENCH_File)){BENCH_Fail("data.bin close");}
+	if(FR_OK != f_mount(NULL, "", 0U)){BENCH_Fail("unmount");}
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Stop on a host error
+  * @param  What failed (const char*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void BENCH_Fail(const char* _what)
+{
+	fprintf(stderr, "bench: %s\n", _what);
+	exit(BENCH_EXIT_HOST);
+}
+
+/**
+  ***************************************************************************************************************************************
+  * @brief  Stop on a wrong command line
+  * @param  Program name (const char*)
+  * @retval None
+  ***************************************************************************************************************************************
+  */
+static void BENCH_Usage(const char* _name)
+{
+	fprintf(stderr, "usage: %s -i image [-n] [-p host_file=volume_path]... [-x data.bin_offset]\n", _name);
+	exit(BENCH_EXIT_HOST);
+}
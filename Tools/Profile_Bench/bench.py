@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Vault load scaling on the host bench.
+
+For each vault size and field length distribution a blank image is formatted, the generated data.txt is copied in and
+compiled (the first load after an edit), then the image is booted again (the cached data.bin is opened).
+The times are host times, the f_read counts and sizes are the firmware counters.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+import gen_data
+
+CASES = [
+    ("short", (10, 100, 1000, 10000)),
+    ("typical", (10, 100, 1000, 10000)),
+    ("long", (10, 100, 1000)),  # 10000 long entries do not fit the volume twice (data.txt and data.bin)
+]
+
+
+def run(bench, args):
+    """Run the bench, the name=value pairs of each load line by load name."""
+    result = subprocess.run([bench] + args, capture_output=True, text=True, timeout=600)
+    if result.returncode != 0:
+        sys.exit("bench failed (%d): %s" % (result.returncode, result.stderr.strip()))
+
+    loads = {}
+    for line in result.stdout.splitlines():
+        name, _, pairs = line.partition(": ")
+        loads[name] = dict(pair.split("=") for pair in pairs.split())
+    return loads
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--bench", required=True, help="profile_bench binary")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    print("%-8s %6s %9s | %10s %8s %10s | %9s %7s | %6s %7s" % (
+        "dist", "entries", "data.txt", "compile ms", "f_read", "KB read", "cached ms", "f_read", "stack", "static"))
+
+    with tempfile.TemporaryDirectory() as tmp:
+        image = os.path.join(tmp, "qspi.img")
+        data = os.path.join(tmp, "data.txt")
+
+        for dist, sizes in CASES:
+            for entries in sizes:
+                with open(data, "w", newline="") as out:
+                    out.write(gen_data.vault(entries, dist, args.seed))
+
+                compiled = run(args.bench, ["-n", "-i", image, "-p", data + "=data.txt"])["reload"]
+                cached = run(args.bench, ["-i", image])["boot"]
+
+                if (int(compiled["entries"]) != entries) or (int(cached["entries"]) != entries) or (cached["compiled"] != "0"):
+                    sys.exit("%s %d: unexpected load %s / %s" % (dist, entries, compiled, cached))
+
+                print("%-8s %6d %8dK | %10.1f %8s %10d | %9.1f %7s | %6s %7s" % (
+                    dist, entries, os.path.getsize(data) // 1024,
+                    int(compiled["load_us"]) / 1000.0, compiled["f_read"], int(compiled["f_read_bytes"]) // 1024,
+                    int(cached["load_us"]) / 1000.0, cached["f_read"],
+                    max(int(compiled["stack"]), int(cached["stack"])), compiled["static"]))
+                sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Malformed input cases of the vault load, run on the host bench (best built with the sanitizers, see make check).
+
+Every case formats a blank image, copies its files in and reloads. A case expects either a load with a given number of
+entries or a stop in BSP_Error_Handler, where the firmware powers off. A crash, a sanitizer report or a hang fails it.
+The data.bin cases corrupt the compiled image and boot again, the load has to compile the vault again.
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+import gen_data
+
+LOADED = 0
+STOPPED = 2  # HOST_EXIT_ERROR_HANDLER
+
+VALID = gen_data.vault(50, "typical", seed=7)
+LAST_TOKEN = VALID.rindex("<")
+
+
+def record(url, fields):
+    return "<url:%s><%d>%s" % (url, len(fields), "".join("<%s>" % field for field in fields))
+
+
+def vault(*records, count=None):
+    return "<%d>\r\n%s\r\n" % (len(records) if count is None else count, "\r\n".join(records))
+
+
+def garbage(seed, size, delimiters):
+    rng = random.Random(seed)
+    alphabet = bytes(range(256)) if delimiters else bytes(c for c in range(256) if c not in b"<")
+    return bytes(rng.choice(alphabet) for _ in range(size))
+
+
+# (name, {volume path: content}, expected exit code, expected entries)
+CASES = [
+    # Valid input
+    ("valid", {"data.txt": VALID}, LOADED, 50),
+    ("empty file", {"data.txt": ""}, LOADED, 0),
+    ("zero entries", {"data.txt": "<0>"}, LOADED, 0),
+    ("limits", {"data.txt": vault(record("u" * 127, ["notes:" + "n" * 127] * 16))}, LOADED, 1),
+    ("count below the records", {"data.txt": vault(record("a.com", ["user:a"]), record("b.com", ["user:b"]), count=1)}, LOADED, 1),
+    ("vault folder", {"data.txt": VALID, "vault/extra.txt": gen_data.vault(20, "short", seed=3)}, LOADED, 70),
+    # Truncated input
+    ("truncated in the count", {"data.txt": "<5"}, STOPPED, None),
+    ("truncated in a record", {"data.txt": VALID[:len(VALID) // 2]}, STOPPED, None),
+    ("truncated after a '<'", {"data.txt": VALID[:LAST_TOKEN + 1]}, STOPPED, None),
+    ("truncated before the last '>'", {"data.txt": VALID[:VALID.rindex(">")]}, STOPPED, None),
+    ("count above the records", {"data.txt": vault(record("a.com", ["user:a"]), count=2)}, STOPPED, None),
+    # Oversized input
+    ("url too long", {"data.txt": vault(record("u" * 128, ["user:a"]))}, STOPPED, None),
+    ("value too long", {"data.txt": vault(record("a.com", ["password:" + "p" * 128]))}, STOPPED, None),
+    ("token beyond the buffer", {"data.txt": vault(record("a.com", ["notes:" + "n" * 4096]))}, STOPPED, None),
+    ("too many fields", {"data.txt": vault(record("a.com", ["user:a"] * 17))}, STOPPED, None),
+    ("count above the limit", {"data.txt": "<65535>"}, STOPPED, None),
+    ("count of six digits", {"data.txt": "<100000>"}, STOPPED, None),
+    ("too many sources", dict([("data.txt", VALID)] + [("vault/f%02d.txt" % idx, "<0>") for idx in range(16)]), STOPPED, None),
+    # Corrupt input
+    ("count not a number", {"data.txt": "<1x>" + record("a.com", ["user:a"])}, STOPPED, None),
+    ("field count not a number", {"data.txt": "<1><url:a.com><one><user:a>"}, STOPPED, None),
+    ("record without url", {"data.txt": "<1><user:a><1><user:a>"}, STOPPED, None),
+    ("unknown field", {"data.txt": vault(record("a.com", ["pin:1234"]))}, STOPPED, None),
+    ("field without name", {"data.txt": vault(record("a.com", ["1234"]))}, STOPPED, None),
+    ("fields missing", {"data.txt": "<2><url:a.com><3><user:a><url:b.com><0>"}, STOPPED, None),
+    ("binary without tokens", {"data.txt": garbage(1, 8192, delimiters=False)}, LOADED, 0),
+    ("binary with delimiters", {"data.txt": garbage(2, 8192, delimiters=True)}, None, None),
+    ("nul bytes in a value", {"data.txt": vault(record("a.com", ["notes:a\0b\0c"]))}, LOADED, 1),
+]
+
+# Offsets of data.bin inverted after the compile: header, records, last byte (dictionary)
+FLIP_OFFSETS = [0, 40, 2000, -1]
+
+
+def run(bench, args):
+    try:
+        result = subprocess.run([bench] + args, capture_output=True, timeout=120)
+    except subprocess.TimeoutExpired:
+        return None, {}, "timeout"
+
+    loads = {}
+    for line in result.stdout.decode(errors="replace").splitlines():
+        name, _, pairs = line.partition(": ")
+        loads[name] = dict(pair.split("=") for pair in pairs.split())
+    return result.returncode, loads, result.stderr.decode(errors="replace")
+
+
+def put_files(tmp, files):
+    args = []
+    for idx, (path, content) in enumerate(sorted(files.items())):
+        host = os.path.join(tmp, "file%02d" % idx)
+        with open(host, "wb") as out:
+            out.write(content.encode("latin-1") if isinstance(content, str) else content)
+        args += ["-p", host + "=" + path]
+    return args
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--bench", required=True, help="profile_bench binary")
+    args = parser.parse_args()
+    failures = 0
+
+    with tempfile.TemporaryDirectory() as tmp:
+        image = os.path.join(tmp, "qspi.img")
+
+        for name, files, expected, entries in CASES:
+            code, loads, errors = run(args.bench, ["-n", "-i", image] + put_files(tmp, files))
+            load = loads.get("reload", {})
+            ok = (code in (LOADED, STOPPED)) if expected is None else (code == expected)
+            if ok and (code == LOADED) and (entries is not None):
+                ok = int(load.get("entries", -1)) == entries
+
+            failures += not ok
+            print("%-4s %-32s exit %s%s" % ("ok" if ok else "FAIL", name, code, (", %s entries" % load["entries"]) if load else ""))
+            if not ok:
+                print(errors.strip())
+
+        # A corrupt data.bin is found by its CRC and compiled again
+        files = put_files(tmp, {"data.txt": VALID})
+        for offset in FLIP_OFFSETS:
+            code, loads, errors = run(args.bench, ["-n", "-i", image] + files)
+            code_flip, _, errors_flip = run(args.bench, ["-i", image, "-x", str(offset)])
+            code_boot, loads, errors_boot = run(args.bench, ["-i", image])
+            boot = loads.get("boot", {})
+            ok = (code == LOADED) and (code_flip == 0) and (code_boot == LOADED) and \
+                 (boot.get("compiled") == "1") and (int(boot.get("entries", -1)) == 50)
+
+            failures += not ok
+            print("%-4s %-32s exit %s, compiled %s" % ("ok" if ok else "FAIL", "data.bin byte %d" % offset, code_boot, boot.get("compiled")))
+            if not ok:
+                print("\n".join(text.strip() for text in (errors, errors_flip, errors_boot) if text.strip()))
+
+    print("%d failed" % failures)
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
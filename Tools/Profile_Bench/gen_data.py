@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Synthetic data.txt generator for the profile bench.
+
+    gen_data.py --entries 1000 --dist typical --seed 1 -o data.txt
+
+The vault format is the one FF_PROFILE parses: the entry count, then per entry the URL, the field count and the fields.
+
+    <2>
+    <url:example.com><2><email:a@b.c><password:secret>
+    ...
+
+The field length distributions:
+    short    short URLs, 1 to 3 fields of 4 to 12 characters
+    typical  URLs of 10 to 40 characters, email/user/password and some notes of 8 to 32 characters, a few shared emails
+    long     URLs and values near the parser limits, 8 to 16 fields
+"""
+
+import argparse
+import random
+import sys
+
+URL_SIZE = 128    # FF_PROFILE_URL_SIZE, the longest URL is one less
+FIELD_SIZE = 128  # FF_PROFILE_FIELD_SIZE
+MAX_FIELDS = 16   # FF_PROFILE_MAX_FIELDS
+MAX_DATA = 65534  # FF_PROFILE_MAX_DATA
+FIELD_NAMES = ("email", "user", "password", "notes", "otp")
+
+# Any printable character but the token delimiters
+CHARSET = "".join(chr(c) for c in range(0x20, 0x7F) if chr(c) not in "<>")
+URL_CHARSET = "abcdefghijklmnopqrstuvwxyz0123456789-./"
+
+DISTS = {
+    # url length, field count, value length
+    "short": ((6, 16), (1, 3), (4, 12)),
+    "typical": ((10, 40), (2, 4), (8, 32)),
+    "long": ((80, URL_SIZE - 1), (8, MAX_FIELDS), (64, FIELD_SIZE - 1)),
+}
+
+
+def _text(rng, charset, length):
+    return "".join(rng.choice(charset) for _ in range(length))
+
+
+def entry(rng, dist, emails):
+    """One entry as a list of tokens without the delimiters."""
+    url_len, field_nbr, value_len = DISTS[dist]
+    url = _text(rng, URL_CHARSET, rng.randint(*url_len))
+    fields = []
+
+    for idx in range(rng.randint(*field_nbr)):
+        name = FIELD_NAMES[idx] if (dist != "long") and (idx < 3) else rng.choice(FIELD_NAMES)
+        if (name == "email") and emails and (rng.random() < 0.5):
+            value = rng.choice(emails)
+        else:
+            value = _text(rng, CHARSET, rng.randint(*value_len))
+        fields.append(name + ":" + value)
+
+    return ["url:" + url, str(len(fields))] + fields
+
+
+def vault(entries, dist="typical", seed=0):
+    """The data.txt text of a generated vault."""
+    rng = random.Random(seed)
+    emails = [_text(rng, URL_CHARSET, 12) + "@mail.com" for _ in range(8)] if dist == "typical" else []
+    lines = ["<%d>" % entries]
+
+    for _ in range(entries):
+        lines.append("".join("<" + token + ">" for token in entry(rng, dist, emails)))
+
+    return "\r\n".join(lines) + "\r\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--entries", type=int, required=True)
+    parser.add_argument("--dist", choices=sorted(DISTS), default="typical")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("-o", "--output", default="-")
+    args = parser.parse_args()
+
+    if not 0 <= args.entries <= MAX_DATA:
+        parser.error("--entries must be within 0 and %d" % MAX_DATA)
+
+    text = vault(args.entries, args.dist, args.seed)
+    if args.output == "-":
+        sys.stdout.write(text)
+    else:
+        with open(args.output, "w", newline="") as out:
+            out.write(text)
+
+
+if __name__ == "__main__":
+    main()